@@ -0,0 +1,113 @@
+/*
+ * ESP32_AI_Connect - Handler Registry Example
+ *
+ * Description:
+ * This example shows how to add an AI platform to the ESP32_AI_Connect library without changing
+ * the library itself. A handler class for Mistral AI, whose chat API follows the OpenAI format, is
+ * derived from AI_API_OpenAI_Handler and registered under the name "mistral" with
+ * AI_API_REGISTER_HANDLER. From then on "mistral" can be passed to the constructor and to begin()
+ * like any built-in platform. The sketch lists the registered platforms, then chats over Serial.
+ *
+ * Author: AvantMaker <admin@avantmaker.com>
+ * Author Website: https://www.AvantMaker.com
+ *
+ * Hardware Requirements:
+ * - ESP32-based microcontroller (e.g., ESP32 DevKitC, DOIT ESP32 DevKit)
+ *
+ * Dependencies:
+ * - ESP32_AI_Connect library (available at https://github.com/AvantMaker/ESP32_AI_Connect)
+ * - ArduinoJson library (version 7.0.0 or higher, available at https://arduinojson.org/)
+ *
+ * Setup Instructions:
+ * - Keep USE_AI_API_OPENAI defined in ESP32_AI_Connect_config.h; the Mistral handler builds on
+ *    the OpenAI handler.
+ * - Update the sketch with your WiFi credentials (`ssid`, `password`), your Mistral API key
+ *    (`apiKey`) and model (e.g., "mistral-small-latest").
+ * - Upload the sketch to your ESP32 board and open the Serial Monitor (115200 baud).
+ *
+ * License: MIT License (see LICENSE file in the repository for details)
+ * Repository: https://github.com/AvantMaker/ESP32_AI_Connect
+ *
+ * Usage Notes:
+ * - Register handlers at file scope (as below) or call
+ *    AI_API_Handler_Registry::add("name", &AI_API_Handler_Factory<My_Handler>) before begin().
+ * - Names are lowercase; registering a name again replaces the earlier handler, built-ins included.
+ * - Up to AI_API_HANDLER_REGISTRY_SIZE names can be registered, built-in platforms included.
+ * - A platform with its own request format derives from AI_API_Platform_Handler instead and
+ *    implements the request building and response parsing methods itself.
+ */
+
+#include <WiFi.h>
+#include <ESP32_AI_Connect.h>
+
+// --- Mistral AI handler: the OpenAI request format on Mistral's endpoint ---
+class My_Mistral_Handler : public AI_API_OpenAI_Handler {
+public:
+  String getEndpoint(const String& modelName, const String& apiKey, const String& customEndpoint = "") const override {
+    if (customEndpoint.length() > 0) {
+      return customEndpoint;
+    }
+    return "https://api.mistral.ai/v1/chat/completions";
+  }
+};
+
+// Register the handler under "mistral" before setup() runs
+AI_API_REGISTER_HANDLER("mistral", My_Mistral_Handler);
+
+const char* ssid = "YOUR_WIFI_SSID";          // Replace with your Wi-Fi SSID
+const char* password = "YOUR_PASSWORD_SSID";  // Replace with your Wi-Fi password
+
+// --- AI API Configuration ---
+const char* apiKey = "Your_MISTRAL_API_KEY";  // Replace with your key
+const char* model = "mistral-small-latest";   // Replace with your model
+
+// --- Create the API Client Instance ---
+ESP32_AI_Connect aiClient("mistral", apiKey, model);
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+
+  // --- List the platforms this build knows about ---
+  Serial.println("Registered platforms:");
+  for (int i = 0; i < AI_API_Handler_Registry::getCount(); i++) {
+    Serial.println("  " + String(AI_API_Handler_Registry::getName(i)));
+  }
+
+  Serial.println("Connecting to WiFi...");
+  WiFi.begin(ssid, password);
+  while (WiFi.status() != WL_CONNECTED) {
+    delay(500);
+    Serial.print(".");
+  }
+  Serial.println("");
+  Serial.println("WiFi connected");
+
+  // --- Configure the AI Client's optional parameters ---
+  aiClient.setChatSystemRole("You are a helpful assistant.");
+  aiClient.setChatMaxTokens(150);
+}
+
+void loop() {
+  Serial.println("\nEnter your message:");
+  while (Serial.available() == 0) {
+    delay(100); // Wait for user input
+  }
+
+  String userMessage = Serial.readStringUntil('\n');
+  userMessage.trim();
+
+  if (userMessage.length() > 0) {
+    Serial.println("Sending message to Mistral: \"" + userMessage + "\"");
+    String aiResponse = aiClient.chat(userMessage);
+
+    if (aiResponse.length() > 0) {
+      Serial.println("\nAI Response:");
+      Serial.println(aiResponse);
+    } else {
+      Serial.println("\nError communicating with AI.");
+      Serial.println("Error details: " + aiClient.getLastError());
+    }
+    Serial.println("--------------------");
+  }
+}
@@ -0,0 +1,119 @@
+/*
+ * ESP32_AI_Connect - Single Platform Client Example
+ *
+ * Description:
+ * This example shows ESP32_AI_Client, a chat client bound to one AI platform at compile time, next
+ * to the full ESP32_AI_Connect client. Both run the same chat loop over Serial. Set
+ * USE_SINGLE_PLATFORM_CLIENT to 1 or 0 and compile the sketch both ways to compare the flash and
+ * RAM each client takes: the Arduino IDE prints both figures after "Sketch uses ... bytes".
+ * The free heap printed after each reply shows how much each client leaves at run time.
+ *
+ * Author: AvantMaker <admin@avantmaker.com>
+ * Author Website: https://www.AvantMaker.com
+ *
+ * Hardware Requirements:
+ * - ESP32-based microcontroller (e.g., ESP32 DevKitC, DOIT ESP32 DevKit)
+ *
+ * Dependencies:
+ * - ESP32_AI_Connect library (available at https://github.com/AvantMaker/ESP32_AI_Connect)
+ * - ArduinoJson library (version 7.0.0 or higher, available at https://arduinojson.org/)
+ *
+ * Setup Instructions:
+ * - Update the sketch with your WiFi credentials (`ssid`, `password`), API key (`apiKey`) and
+ *    model (e.g., "gpt-4o-mini").
+ * - ESP32_AI_Client takes the platform as a template argument (AI_API_OpenAI_Handler,
+ *    AI_API_Gemini_Handler, AI_API_DeepSeek_Handler or AI_API_Claude_Handler); keep `platform`
+ *    in line with it so both variants talk to the same provider.
+ * - Upload the sketch to your ESP32 board and open the Serial Monitor (115200 baud).
+ *
+ * License: MIT License (see LICENSE file in the repository for details)
+ * Repository: https://github.com/AvantMaker/ESP32_AI_Connect
+ *
+ * Usage Notes:
+ * - ESP32_AI_Client covers chat() only. Tool calls, streaming, platform switching, retries,
+ *    failover and the other optional features need ESP32_AI_Connect.
+ * - The flash saved by ESP32_AI_Client grows with the number of features enabled in
+ *    ESP32_AI_Connect_config.h, since ESP32_AI_Connect links the code of all of them.
+ */
+
+#include <WiFi.h>
+
+// 1: ESP32_AI_Client (single platform), 0: ESP32_AI_Connect (any platform)
+#define USE_SINGLE_PLATFORM_CLIENT 1
+
+#if USE_SINGLE_PLATFORM_CLIENT
+#include <ESP32_AI_Client.h>
+#else
+#include <ESP32_AI_Connect.h>
+#endif
+
+const char* ssid = "YOUR_WIFI_SSID";          // Replace with your Wi-Fi SSID
+const char* password = "YOUR_PASSWORD_SSID";  // Replace with your Wi-Fi password
+
+// --- AI API Configuration ---
+const char* apiKey = "Your_LLM_API_KEY";  // Replace with your key
+const char* model = "gpt-4o-mini";        // Replace with your model
+const char* platform = "openai";          // Used by ESP32_AI_Connect only
+
+// --- Create the API Client Instance ---
+#if USE_SINGLE_PLATFORM_CLIENT
+ESP32_AI_Client<AI_API_OpenAI_Handler> aiClient(apiKey, model);
+#else
+ESP32_AI_Connect aiClient(platform, apiKey, model);
+#endif
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+  Serial.println("Connecting to WiFi...");
+
+  WiFi.begin(ssid, password);
+  while (WiFi.status() != WL_CONNECTED) {
+    delay(500);
+    Serial.print(".");
+  }
+  Serial.println("");
+  Serial.println("WiFi connected");
+
+#if USE_SINGLE_PLATFORM_CLIENT
+  Serial.println("Client: ESP32_AI_Client (single platform)");
+#else
+  Serial.println("Client: ESP32_AI_Connect");
+#endif
+  Serial.println("Free heap: " + String(ESP.getFreeHeap()) + " bytes");
+
+  // --- Configure the AI Client's optional parameters (same calls on both clients) ---
+  aiClient.setChatSystemRole("You are a helpful assistant.");
+  aiClient.setChatTemperature(0.7);
+  aiClient.setChatMaxTokens(150);
+}
+
+void loop() {
+  Serial.println("\nEnter your message:");
+  while (Serial.available() == 0) {
+    delay(100); // Wait for user input
+  }
+
+  String userMessage = Serial.readStringUntil('\n');
+  userMessage.trim();
+
+  if (userMessage.length() > 0) {
+    Serial.println("Sending message to AI: \"" + userMessage + "\"");
+
+    uint32_t startedAt = millis();
+    String aiResponse = aiClient.chat(userMessage);
+    uint32_t elapsedMs = millis() - startedAt;
+
+    if (aiResponse.length() > 0) {
+      Serial.println("\nAI Response:");
+      Serial.println(aiResponse);
+    } else {
+      Serial.println("\nError communicating with AI.");
+      Serial.println("Error details: " + aiClient.getLastError());
+    }
+    Serial.println("\nRequest took " + String(elapsedMs) + " ms");
+    Serial.println("Free heap: " + String(ESP.getFreeHeap()) + " bytes (lowest so far: " +
+                   String(ESP.getMinFreeHeap()) + ")");
+    Serial.println("--------------------");
+  }
+}
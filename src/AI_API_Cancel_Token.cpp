@@ -0,0 +1,61 @@
+// ESP32_AI_Connect/AI_API_Cancel_Token.cpp
+
+#include "AI_API_Cancel_Token.h"
+
+#ifdef ENABLE_CANCELLATION // Only compile if flag is set
+
+AI_API_Cancel_Token::AI_API_Cancel_Token() {
+    _lock = xSemaphoreCreateMutex();
+    _signal = xSemaphoreCreateBinary();
+    if (_lock == nullptr || _signal == nullptr) {
+        Serial.println("ERROR: Failed to create cancel token semaphores");
+    }
+}
+
+AI_API_Cancel_Token::~AI_API_Cancel_Token() {
+    if (_lock != nullptr) vSemaphoreDelete(_lock);
+    if (_signal != nullptr) vSemaphoreDelete(_signal);
+}
+
+void AI_API_Cancel_Token::cancel() {
+    if (_lock) xSemaphoreTake(_lock, portMAX_DELAY);
+    if (!_cancelled) {
+        _cancelledAt = millis();
+        _cancelled = true; // The request task sees its connection drop and cleans up
+        if (_signal) xSemaphoreGive(_signal);
+    }
+    if (_lock) xSemaphoreGive(_lock);
+}
+
+void AI_API_Cancel_Token::reset() {
+    if (_lock) xSemaphoreTake(_lock, portMAX_DELAY);
+    _cancelled = false;
+    _aborted = false;
+    _abortLatencyMs = 0;
+    if (_signal) xSemaphoreTake(_signal, 0); // Drop a pending wake-up
+    if (_lock) xSemaphoreGive(_lock);
+}
+
+void AI_API_Cancel_Token::detach() {
+    if (_lock) xSemaphoreTake(_lock, portMAX_DELAY);
+    if (_aborted && _abortLatencyMs == 0) {
+        _abortLatencyMs = max((uint32_t)1, (uint32_t)(millis() - _cancelledAt));
+    }
+    if (_lock) xSemaphoreGive(_lock);
+}
+
+void AI_API_Cancel_Token::markAborted() {
+    _aborted = true;
+}
+
+bool AI_API_Cancel_Token::sleep(uint32_t ms) {
+    if (_cancelled) return true;
+    if (_signal == nullptr) {
+        delay(ms);
+    } else if (xSemaphoreTake(_signal, pdMS_TO_TICKS(ms)) == pdTRUE) {
+        xSemaphoreGive(_signal); // Leave it for other waits on this token
+    }
+    return _cancelled;
+}
+
+#endif // ENABLE_CANCELLATION
@@ -0,0 +1,70 @@
+// ESP32_AI_Connect/AI_API_Cancel_Token.h
+
+#ifndef AI_API_CANCEL_TOKEN_H
+#define AI_API_CANCEL_TOKEN_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+
+#ifdef ENABLE_CANCELLATION // Only compile this file's content if flag is set
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+/**
+ * AI_API_Cancel_Token - Aborts a client's request from another task
+ *
+ * Once cancel() was called, the connection of the request in flight
+ * (an AI_API_Race_Client) reports itself closed with nothing to read. A
+ * request waiting for the response or reading it gives up within one
+ * HTTPClient poll or stream wait slice instead of running into its
+ * timeout; a backoff sleep ends at once. The TCP connect and TLS
+ * handshake are not interrupted, they end within their own budgets.
+ * cancel() never touches the socket: the request task closes its own
+ * connection and leaves the JSON documents, so nothing is freed under it.
+ *
+ * Usage:
+ *   AI_API_Cancel_Token cancelToken;
+ *   aiClient.setCancelToken(&cancelToken);
+ *   // Request task:                  // Button task:
+ *   String reply = aiClient.chat(q);  cancelToken.cancel();
+ *   if (cancelToken.isCancelled()) { cancelToken.reset(); ... }
+ *
+ * A cancelled token stays cancelled, and every request started with it is
+ * aborted, until reset().
+ */
+class AI_API_Cancel_Token {
+public:
+    AI_API_Cancel_Token();
+    ~AI_API_Cancel_Token();
+
+    // Abort the request using this token (any task; returns at once)
+    void cancel();
+    bool isCancelled() const { return _cancelled; }
+    // Make the token usable for the next request
+    void reset();
+    // Time from cancel() until the aborted request returned, 0 if none was aborted
+    uint32_t getAbortLatencyMs() const { return _abortLatencyMs; }
+
+    // Used by the client while a request runs:
+    // A request using this token returned
+    void detach();
+    // The request noticed the cancellation and is giving up
+    void markAborted();
+    // Wait up to ms; returns true early if the token is cancelled
+    bool sleep(uint32_t ms);
+
+private:
+    volatile bool _cancelled = false;
+    bool _aborted = false;
+    uint32_t _cancelledAt = 0;
+    uint32_t _abortLatencyMs = 0;
+    SemaphoreHandle_t _lock = nullptr;   // Guards the abort timing against cancel()
+    SemaphoreHandle_t _signal = nullptr; // Given by cancel() to end sleep()
+
+    AI_API_Cancel_Token(const AI_API_Cancel_Token&);
+    AI_API_Cancel_Token& operator=(const AI_API_Cancel_Token&);
+};
+
+#endif // ENABLE_CANCELLATION
+#endif // AI_API_CANCEL_TOKEN_H
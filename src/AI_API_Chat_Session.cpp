@@ -0,0 +1,175 @@
+// ESP32_AI_Connect/AI_API_Chat_Session.cpp
+
+#include "AI_API_Chat_Session.h"
+#include "AI_API_Memory.h"
+
+#ifdef ENABLE_CHAT_SESSION // Only compile if flag is set
+
+// Record layout: [role:1][length:2, little endian][text][NUL]
+#define AI_API_CHAT_SESSION_HEADER_BYTES 3
+// Role byte marking unused space at the end of the buffer; reading continues at offset 0
+#define AI_API_CHAT_SESSION_WRAP_MARKER 0xFF
+
+AI_API_Chat_Session::AI_API_Chat_Session(size_t budgetBytes) : _budget(budgetBytes) {
+}
+
+AI_API_Chat_Session::~AI_API_Chat_Session() {
+    clear();
+}
+
+void AI_API_Chat_Session::clear() {
+    AI_API_Memory::deallocate(_buffer);
+    _buffer = nullptr;
+    _head = 0;
+    _tail = 0;
+    _usedBytes = 0;
+    _textBytes = 0;
+    _turnCount = 0;
+}
+
+size_t AI_API_Chat_Session::_resolve(size_t offset) const {
+    if (offset >= _budget || _buffer[offset] == AI_API_CHAT_SESSION_WRAP_MARKER) {
+        return 0;
+    }
+    return offset;
+}
+
+size_t AI_API_Chat_Session::_recordSize(size_t offset) const {
+    size_t length = _buffer[offset + 1] | ((size_t)_buffer[offset + 2] << 8);
+    return AI_API_CHAT_SESSION_HEADER_BYTES + length + 1;
+}
+
+void AI_API_Chat_Session::_evictOldest() {
+    if (_turnCount == 0) return;
+
+    size_t size = _recordSize(_head);
+    _textBytes -= size - AI_API_CHAT_SESSION_HEADER_BYTES - 1;
+    _usedBytes -= size;
+    _head += size;
+    _turnCount--;
+    _evictedTurns++;
+
+    if (_turnCount == 0) {
+        // Empty - restart at the beginning of the buffer
+        _head = 0;
+        _tail = 0;
+        _usedBytes = 0;
+        return;
+    }
+
+    // Skip the wrap gap so _head always points at a record
+    size_t resolved = _resolve(_head);
+    if (resolved != _head) {
+        _usedBytes -= _budget - _head;
+        _head = resolved;
+    }
+}
+
+bool AI_API_Chat_Session::dropOldestTurn() {
+    if (_turnCount == 0) return false;
+
+    _evictOldest();
+    while (_turnCount > 0 && _buffer[_head] != ROLE_USER) {
+        _evictOldest();
+    }
+    return true;
+}
+
+bool AI_API_Chat_Session::addTurn(Role role, const char* text, size_t length) {
+    if (text == nullptr) return false;
+
+    size_t recordSize = AI_API_CHAT_SESSION_HEADER_BYTES + length + 1;
+    if (length > 0xFFFF || recordSize > _budget) {
+        return false; // Would never fit
+    }
+
+    if (_buffer == nullptr) {
+        _buffer = (uint8_t*)AI_API_Memory::allocate(_budget);
+        if (_buffer == nullptr) return false;
+    }
+
+    // Find room for the record, evicting the oldest turns until it fits
+    size_t writeOffset = 0;
+    bool wrap = false;
+    bool evicted = false;
+    while (true) {
+        if (_turnCount == 0) {
+            writeOffset = 0;
+            wrap = false;
+            break;
+        }
+        if (_tail > _head) {
+            // Data in [head, tail): free space at the end, then before head
+            if (_budget - _tail >= recordSize) {
+                writeOffset = _tail;
+                wrap = false;
+                break;
+            }
+            if (_head >= recordSize) {
+                writeOffset = 0;
+                wrap = true;
+                break;
+            }
+        } else if (_head - _tail >= recordSize) {
+            // Data wrapped around: free space is [tail, head)
+            writeOffset = _tail;
+            wrap = false;
+            break;
+        }
+        _evictOldest();
+        evicted = true;
+    }
+
+    if (evicted) {
+        // History must start with a user turn
+        while (_turnCount > 0 && _buffer[_head] != ROLE_USER) {
+            _evictOldest();
+        }
+        if (_turnCount == 0) {
+            writeOffset = 0;
+            wrap = false;
+            if (role != ROLE_USER) {
+                _evictedTurns++;
+                return true; // An assistant reply without its question is dropped as well
+            }
+        }
+    }
+
+    if (wrap) {
+        if (_tail < _budget) _buffer[_tail] = AI_API_CHAT_SESSION_WRAP_MARKER;
+        _usedBytes += _budget - _tail;
+    }
+
+    uint8_t* record = _buffer + writeOffset;
+    record[0] = role;
+    record[1] = length & 0xFF;
+    record[2] = (length >> 8) & 0xFF;
+    memcpy(record + AI_API_CHAT_SESSION_HEADER_BYTES, text, length);
+    record[AI_API_CHAT_SESSION_HEADER_BYTES + length] = '\0';
+
+    if (_turnCount == 0) {
+        _head = writeOffset;
+        _usedBytes = 0;
+    }
+    _tail = writeOffset + recordSize;
+    _usedBytes += recordSize;
+    _textBytes += length;
+    _turnCount++;
+    return true;
+}
+
+bool AI_API_Chat_Session::nextTurn(Cursor& cursor, Turn& turn) const {
+    if (cursor.remaining <= 0 || _buffer == nullptr) return false;
+
+    size_t offset = _resolve(cursor.offset);
+    const uint8_t* record = _buffer + offset;
+    turn.role = (Role)record[0];
+    turn.length = record[1] | ((size_t)record[2] << 8);
+    turn.text = (const char*)(record + AI_API_CHAT_SESSION_HEADER_BYTES);
+
+    cursor.offset = offset + AI_API_CHAT_SESSION_HEADER_BYTES + turn.length + 1;
+    cursor.remaining--;
+    return true;
+}
+
+#endif // ENABLE_CHAT_SESSION
@@ -0,0 +1,100 @@
+// ESP32_AI_Connect/AI_API_Chat_Session.h
+
+#ifndef AI_API_CHAT_SESSION_H
+#define AI_API_CHAT_SESSION_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+
+#ifdef ENABLE_CHAT_SESSION // Only compile this file's content if flag is set
+
+#include <Arduino.h>
+
+/**
+ * AI_API_Chat_Session - Conversation memory for multi-turn chat
+ *
+ * Keeps user/assistant turns in a single fixed-size buffer used as a ring:
+ * each turn is stored once as [role][length][text][NUL] and the oldest turns
+ * are evicted when a new one does not fit the byte budget. History never
+ * starts with an assistant turn, as most platforms require the user to speak
+ * first.
+ *
+ * Usage:
+ *   AI_API_Chat_Session session(4096);
+ *   aiClient.chat("My name is Ada.", session);
+ *   aiClient.chat("What is my name?", session); // Previous turns are sent natively
+ *
+ * The buffer is allocated on the first turn and released by clear().
+ */
+class AI_API_Chat_Session {
+public:
+    enum Role : uint8_t {
+        ROLE_USER = 1,
+        ROLE_ASSISTANT = 2
+    };
+
+    // One stored turn; 'text' points into the session buffer (NUL terminated)
+    struct Turn {
+        Role role;
+        const char* text;
+        size_t length;
+    };
+
+    // Iteration state for nextTurn()
+    struct Cursor {
+        size_t offset;
+        int remaining;
+    };
+
+    explicit AI_API_Chat_Session(size_t budgetBytes = AI_API_CHAT_SESSION_BYTES);
+    ~AI_API_Chat_Session();
+
+    // Append a turn, evicting the oldest turns as needed
+    // Returns false if the turn alone exceeds the byte budget or memory is unavailable
+    bool addTurn(Role role, const char* text, size_t length);
+    bool addUserTurn(const String& text) { return addTurn(ROLE_USER, text.c_str(), text.length()); }
+    bool addAssistantTurn(const String& text) { return addTurn(ROLE_ASSISTANT, text.c_str(), text.length()); }
+
+    // Drop the oldest turn (and any assistant turns left at the front)
+    // Returns false if the session is empty
+    bool dropOldestTurn();
+
+    // Drop all turns and free the buffer
+    void clear();
+
+    // Iterate turns from oldest to newest:
+    //   AI_API_Chat_Session::Cursor cursor = session.begin();
+    //   AI_API_Chat_Session::Turn turn;
+    //   while (session.nextTurn(cursor, turn)) { ... }
+    Cursor begin() const { return Cursor{_head, _turnCount}; }
+    bool nextTurn(Cursor& cursor, Turn& turn) const;
+
+    int getTurnCount() const { return _turnCount; }
+    size_t getTextBytes() const { return _textBytes; }     // Sum of the stored turn texts
+    size_t getUsedBytes() const { return _usedBytes; }     // Buffer bytes in use, including record headers
+    size_t getBudgetBytes() const { return _budget; }
+    uint32_t getEvictedTurnCount() const { return _evictedTurns; }
+
+private:
+    uint8_t* _buffer = nullptr;
+    size_t _budget;
+    size_t _head = 0;       // Offset of the oldest record
+    size_t _tail = 0;       // Offset where the next record is written
+    size_t _usedBytes = 0;  // Bytes between head and tail, including skipped wrap space
+    size_t _textBytes = 0;
+    int _turnCount = 0;
+    uint32_t _evictedTurns = 0;
+
+    // Drop the oldest turn
+    void _evictOldest();
+    // Offset of the record at 'offset', following a wrap marker if present
+    size_t _resolve(size_t offset) const;
+    // Total size of the record at 'offset' (header + text + NUL)
+    size_t _recordSize(size_t offset) const;
+
+    // Copying would duplicate the buffer pointer
+    AI_API_Chat_Session(const AI_API_Chat_Session&);
+    AI_API_Chat_Session& operator=(const AI_API_Chat_Session&);
+};
+
+#endif // ENABLE_CHAT_SESSION
+#endif // AI_API_CHAT_SESSION_H
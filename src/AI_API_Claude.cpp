@@ -25,11 +25,67 @@ void AI_API_Claude_Handler::setHeaders(HTTPClient& httpClient, const String& api
     httpClient.addHeader("anthropic-version", _apiVersion);
 }
 
+void AI_API_Claude_Handler::_addSystemPrompt(JsonDocument& doc, const String& systemPrompt) {
+    if (!_promptCaching) {
+        doc["system"] = systemPrompt;
+        return;
+    }
+    // Only content blocks can carry cache_control
+    JsonArray system = doc.createNestedArray("system");
+    JsonObject block = system.createNestedObject();
+    block["type"] = "text";
+    block["text"] = systemPrompt;
+    _markCacheable(block);
+}
+
+void AI_API_Claude_Handler::_markCacheable(JsonObject block) {
+    JsonObject cacheControl = block.createNestedObject("cache_control");
+    cacheControl["type"] = "ephemeral";
+}
+
+void AI_API_Claude_Handler::_markHistoryCacheable(JsonArray messages) {
+    if (!_promptCaching || messages.size() == 0) return;
+
+    // Turn the last history message into a content block that closes the prefix
+    JsonObject lastTurn = messages[messages.size() - 1];
+    String text = lastTurn["content"].as<String>(); // Copy: replacing the value releases it
+    JsonArray content = lastTurn.createNestedArray("content");
+    JsonObject block = content.createNestedObject();
+    block["type"] = "text";
+    block["text"] = text;
+    _markCacheable(block);
+}
+
+void AI_API_Claude_Handler::_parseUsage(JsonObject usage) {
+    _lastCacheReadTokens = usage["cache_read_input_tokens"] | 0;
+    _lastCacheWriteTokens = usage["cache_creation_input_tokens"] | 0;
+    // input_tokens only counts the tokens after the last cache breakpoint
+    _lastPromptTokens = (usage["input_tokens"] | 0) + _lastCacheReadTokens + _lastCacheWriteTokens;
+    _lastTotalTokens = _lastPromptTokens + (usage["output_tokens"] | 0);
+}
+
+#ifdef ENABLE_TOOL_CALLS
+void AI_API_Claude_Handler::_addPrebuiltTools(JsonArray tools, bool markLast) {
+    for (int i = 0; i < _prebuiltToolsSize; i++) {
+        if (markLast && i == _prebuiltToolsSize - 1) {
+            // Splice cache_control into the rendered object
+            String tool = _prebuiltTools[i].claude;
+            tool.remove(tool.length() - 1);
+            tool += ",\"cache_control\":{\"type\":\"ephemeral\"}}";
+            tools.add(serialized(tool));
+        } else {
+            tools.add(serialized(_prebuiltTools[i].claude));
+        }
+    }
+}
+#endif
+
 // Build request body for Claude API
 String AI_API_Claude_Handler::buildRequestBody(const String& modelName, const String& systemRole,
                                              float temperature, int maxTokens,
                                              const String& userMessage, JsonDocument& doc,
-                                             const String& customParams) {
+                                             const String& customParams,
+                                             const AI_API_Chat_Session* history) {
     try {
         // Set the model
         doc["model"] = modelName;
@@ -37,7 +93,7 @@ String AI_API_Claude_Handler::buildRequestBody(const String& modelName, const St
         // Process custom parameters if provided
         if (customParams.length() > 0) {
             // Create a temporary document to parse the custom parameters
-            DynamicJsonDocument paramsDoc(512);
+            AI_API_Json_Document paramsDoc;
             DeserializationError error = deserializeJson(paramsDoc, customParams);
             
             // Only proceed if parsing was successful
@@ -66,11 +122,13 @@ String AI_API_Claude_Handler::buildRequestBody(const String& modelName, const St
         
         // Add system message if specified (only if user has set it with setTCChatSystemRole)
         if (systemRole.length() > 0) {
-            doc["system"] = systemRole;
+            _addSystemPrompt(doc, systemRole);
         }
         
         // Create messages array with user message
         JsonArray messages = doc.createNestedArray("messages");
+        addHistoryTurns(messages, history); // Previous turns of a chat session
+        _markHistoryCacheable(messages);
         JsonObject userMsg = messages.createNestedObject();
         userMsg["role"] = "user";
         userMsg["content"] = userMessage;
@@ -129,8 +187,7 @@ String AI_API_Claude_Handler::parseResponseBody(const String& responsePayload,
                 
                 // Extract token count if available
                 if (doc.containsKey("usage")) {
-                    _lastTotalTokens = doc["usage"]["input_tokens"].as<int>() + 
-                                      doc["usage"]["output_tokens"].as<int>();
+                    _parseUsage(doc["usage"]);
                 }
                 
                 return responseText;
@@ -171,16 +228,19 @@ String AI_API_Claude_Handler::buildToolCallsRequestBody(const String& modelName,
         
         // Add system message if specified (only if user has set it with setTCChatSystemRole)
         if (systemMessage.length() > 0) {
-            doc["system"] = systemMessage;
+            _addSystemPrompt(doc, systemMessage);
         }
         
         // Create tools array
         JsonArray tools = doc.createNestedArray("tools");
         
+        // Add pre-rendered tools (see AI_API_Tool_Schema.h) verbatim - no parsing needed
+        _addPrebuiltTools(tools, _promptCaching && toolsArraySize == 0);
+        
         // Add each tool to the tools array
         for (int i = 0; i < toolsArraySize; i++) {
             // Parse the tool definition from the input array
-            DynamicJsonDocument toolDoc(1024);
+            AI_API_Json_Document toolDoc;
             DeserializationError error = deserializeJson(toolDoc, toolsArray[i]);
             
             if (error) {
@@ -236,6 +296,9 @@ String AI_API_Claude_Handler::buildToolCallsRequestBody(const String& modelName,
                 }
             }
         }
+        if (_promptCaching && toolsArraySize > 0) {
+            _markCacheable(tools[tools.size() - 1]);
+        }
         
         // Create messages array with user message
         JsonArray messages = doc.createNestedArray("messages");
@@ -257,7 +320,7 @@ String AI_API_Claude_Handler::buildToolCallsRequestBody(const String& modelName,
             // Check if it starts with { - might be a JSON object string
             else if (trimmedChoice.startsWith("{")) {
                 // Try to parse it as a JSON object
-                DynamicJsonDocument toolChoiceDoc(512);
+                AI_API_Json_Document toolChoiceDoc;
                 DeserializationError error = deserializeJson(toolChoiceDoc, trimmedChoice);
                 
                 if (!error) {
@@ -333,8 +396,7 @@ String AI_API_Claude_Handler::parseToolCallsResponseBody(const String& responseP
         
         // Extract token count if available
         if (doc.containsKey("usage")) {
-            _lastTotalTokens = doc["usage"]["input_tokens"].as<int>() + 
-                              doc["usage"]["output_tokens"].as<int>();
+            _parseUsage(doc["usage"]);
         }
         
         // Extract the stop_reason (finish reason) without mapping
@@ -362,7 +424,7 @@ String AI_API_Claude_Handler::parseToolCallsResponseBody(const String& responseP
         // If there are tool_use blocks, extract them into a JSON array
         if (hasToolUse) {
             // Create a new document to hold the tool calls array
-            DynamicJsonDocument toolCallsDoc(2048);
+            AI_API_Json_Document toolCallsDoc;
             JsonArray toolCalls = toolCallsDoc.to<JsonArray>();
             
             // Extract each tool_use block
@@ -428,6 +490,30 @@ String AI_API_Claude_Handler::parseToolCallsResponseBody(const String& responseP
 }
 
 // Build follow-up request with tool results
+int AI_API_Claude_Handler::getToolCallCount(const JsonDocument& doc) const {
+    int count = 0;
+    for (JsonObjectConst contentBlock : doc["content"].as<JsonArrayConst>()) {
+        if (contentBlock["type"] == "tool_use") count++;
+    }
+    return count;
+}
+
+bool AI_API_Claude_Handler::getToolCall(const JsonDocument& doc, int index, AI_API_Tool_Call& call,
+                                        JsonDocument& argsDoc) const {
+    // tool_use blocks may be interleaved with text blocks
+    int toolIndex = 0;
+    for (JsonObjectConst contentBlock : doc["content"].as<JsonArrayConst>()) {
+        if (contentBlock["type"] != "tool_use") continue;
+        if (toolIndex++ != index) continue;
+
+        call.id = contentBlock["id"] | "";
+        call.name = contentBlock["name"] | "";
+        call.args = contentBlock["input"].as<JsonObjectConst>(); // Already an object - borrow it
+        return !call.args.isNull();
+    }
+    return false;
+}
+
 String AI_API_Claude_Handler::buildToolCallsFollowUpRequestBody(const String& modelName,
                                                            const String* toolsArray, int toolsArraySize,
                                                            const String& systemMessage, const String& toolChoice,
@@ -454,16 +540,19 @@ String AI_API_Claude_Handler::buildToolCallsFollowUpRequestBody(const String& mo
         
         // Add system message if specified (only if user has set it with setTCChatSystemRole)
         if (systemMessage.length() > 0) {
-            doc["system"] = systemMessage;
+            _addSystemPrompt(doc, systemMessage);
         }
         
         // Create tools array (same as in the original request)
         JsonArray tools = doc.createNestedArray("tools");
         
+        // Add pre-rendered tools (see AI_API_Tool_Schema.h) verbatim - no parsing needed
+        _addPrebuiltTools(tools, _promptCaching && toolsArraySize == 0);
+        
         // Add each tool to the tools array
         for (int i = 0; i < toolsArraySize; i++) {
             // Parse the tool definition from the input array
-            DynamicJsonDocument toolDoc(1024);
+            AI_API_Json_Document toolDoc;
             DeserializationError error = deserializeJson(toolDoc, toolsArray[i]);
             
             if (error) {
@@ -519,6 +608,9 @@ String AI_API_Claude_Handler::buildToolCallsFollowUpRequestBody(const String& mo
                 }
             }
         }
+        if (_promptCaching && toolsArraySize > 0) {
+            _markCacheable(tools[tools.size() - 1]);
+        }
         
         // Create messages array
         JsonArray messages = doc.createNestedArray("messages");
@@ -529,7 +621,7 @@ String AI_API_Claude_Handler::buildToolCallsFollowUpRequestBody(const String& mo
         userMsg["content"] = lastUserMessage;
         
         // Parse the assistant's response to extract the tool_use content
-        DynamicJsonDocument assistantResponseDoc(2048);
+        AI_API_Json_Document assistantResponseDoc;
         DeserializationError assistantError = deserializeJson(assistantResponseDoc, lastAssistantToolCallsJson);
         
         if (assistantError) {
@@ -575,7 +667,7 @@ String AI_API_Claude_Handler::buildToolCallsFollowUpRequestBody(const String& mo
                 JsonObject inputObj = toolUseBlock.createNestedObject("input");
                 // Parse arguments string to object
                 String argsStr = toolCall["function"]["arguments"].as<String>();
-                DynamicJsonDocument argsDoc(1024);
+                AI_API_Json_Document argsDoc;
                 DeserializationError argsError = deserializeJson(argsDoc, argsStr);
                 if (!argsError) {
                     // Copy arguments to input
@@ -598,7 +690,7 @@ String AI_API_Claude_Handler::buildToolCallsFollowUpRequestBody(const String& mo
         JsonArray toolResultContent = toolResultMsg.createNestedArray("content");
         
         // Parse the tool results JSON and format for Claude
-        DynamicJsonDocument resultsDoc(2048);
+        AI_API_Json_Document resultsDoc;
         DeserializationError resultsError = deserializeJson(resultsDoc, toolResultsJson);
         
         if (resultsError) {
@@ -632,7 +724,7 @@ String AI_API_Claude_Handler::buildToolCallsFollowUpRequestBody(const String& mo
                 // Check if output is a JSON string by looking for { at the beginning
                 if (output.startsWith("{")) {
                     // Try to parse as JSON to see if it's valid
-                    DynamicJsonDocument outputDoc(1024);
+                    AI_API_Json_Document outputDoc;
                     DeserializationError outputError = deserializeJson(outputDoc, output);
                     
                     if (!outputError) {
@@ -668,7 +760,7 @@ String AI_API_Claude_Handler::buildToolCallsFollowUpRequestBody(const String& mo
             // Check if it starts with { - might be a JSON object string
             else if (trimmedChoice.startsWith("{")) {
                 // Try to parse it as a JSON object
-                DynamicJsonDocument toolChoiceDoc(512);
+                AI_API_Json_Document toolChoiceDoc;
                 DeserializationError error = deserializeJson(toolChoiceDoc, trimmedChoice);
                 
                 if (!error) {
@@ -731,7 +823,8 @@ String AI_API_Claude_Handler::buildToolCallsFollowUpRequestBody(const String& mo
 String AI_API_Claude_Handler::buildStreamRequestBody(const String& modelName, const String& systemRole,
                                                     float temperature, int maxTokens,
                                                     const String& userMessage, JsonDocument& doc,
-                                                    const String& customParams) {
+                                                    const String& customParams,
+                                                    const AI_API_Chat_Session* history) {
     try {
         // Use the same logic as buildRequestBody but add "stream": true
         
@@ -744,7 +837,7 @@ String AI_API_Claude_Handler::buildStreamRequestBody(const String& modelName, co
         // Process custom parameters if provided
         if (customParams.length() > 0) {
             // Create a temporary document to parse the custom parameters
-            DynamicJsonDocument paramsDoc(512);
+            AI_API_Json_Document paramsDoc;
             DeserializationError error = deserializeJson(paramsDoc, customParams);
             
             // Only proceed if parsing was successful
@@ -773,11 +866,13 @@ String AI_API_Claude_Handler::buildStreamRequestBody(const String& modelName, co
         
         // Add system message if specified
         if (systemRole.length() > 0) {
-            doc["system"] = systemRole;
+            _addSystemPrompt(doc, systemRole);
         }
         
         // Create messages array with user message
         JsonArray messages = doc.createNestedArray("messages");
+        addHistoryTurns(messages, history); // Previous turns of a chat session
+        _markHistoryCacheable(messages);
         JsonObject userMsg = messages.createNestedObject();
         userMsg["role"] = "user";
         userMsg["content"] = userMessage;
@@ -820,7 +915,7 @@ String AI_API_Claude_Handler::processStreamChunk(const String& rawChunk, bool& i
     }
 
     // Parse the JSON chunk
-    DynamicJsonDocument chunkDoc(1024); // Larger buffer for Claude responses
+    AI_API_Json_Document chunkDoc;
     DeserializationError error = deserializeJson(chunkDoc, jsonPart);
     if (error) {
         errorMsg = "Failed to parse Claude streaming chunk JSON: " + String(error.c_str());
@@ -18,6 +18,8 @@
  * - Streaming chat
  * - System prompts
  * - Custom parameters via setChatParameters()
+ * - Prompt caching: with setPromptCaching(true) the tools, system prompt and
+ *   chat history end with a cache_control breakpoint (at most 3 of the 4 allowed)
  */
 class AI_API_Claude_Handler : public AI_API_Platform_Handler {
 public:
@@ -31,7 +33,8 @@ public:
     String buildRequestBody(const String& modelName, const String& systemRole,
                            float temperature, int maxTokens,
                            const String& userMessage, JsonDocument& doc,
-                           const String& customParams = "") override;
+                           const String& customParams = "",
+                           const AI_API_Chat_Session* history = nullptr) override;
     String parseResponseBody(const String& responsePayload,
                             String& errorMsg, JsonDocument& doc) override;
                             
@@ -45,6 +48,11 @@ public:
     
     String parseToolCallsResponseBody(const String& responsePayload,
                                 String& errorMsg, JsonDocument& doc) override;
+
+    // Decoded tool call view (see AI_API_Platform_Handler.h)
+    int getToolCallCount(const JsonDocument& doc) const override;
+    bool getToolCall(const JsonDocument& doc, int index, AI_API_Tool_Call& call,
+                     JsonDocument& argsDoc) const override;
                                 
     String buildToolCallsFollowUpRequestBody(const String& modelName,
                                        const String* toolsArray, int toolsArraySize,
@@ -62,7 +70,8 @@ public:
     String buildStreamRequestBody(const String& modelName, const String& systemRole,
                                 float temperature, int maxTokens,
                                 const String& userMessage, JsonDocument& doc,
-                                const String& customParams = "") override;
+                                const String& customParams = "",
+                                const AI_API_Chat_Session* history = nullptr) override;
                                 
     String processStreamChunk(const String& rawChunk, bool& isComplete, String& errorMsg) override;
 #endif
@@ -70,6 +79,19 @@ public:
 private:
     // Claude API version - can be updated if needed
     String _apiVersion = "2023-06-01";
+
+    // Set 'system' as a plain string, or as a cacheable text block when prompt caching is on
+    void _addSystemPrompt(JsonDocument& doc, const String& systemPrompt);
+    // End the cacheable prefix at 'block'
+    void _markCacheable(JsonObject block);
+    // End the cacheable prefix at the last history turn (before the new user message)
+    void _markHistoryCacheable(JsonArray messages);
+    // Token counts from the 'usage' object, including cached prompt tokens
+    void _parseUsage(JsonObject usage);
+#ifdef ENABLE_TOOL_CALLS
+    // Add the pre-rendered tools; markLast ends the cacheable prefix at the last one
+    void _addPrebuiltTools(JsonArray tools, bool markLast);
+#endif
 };
 
 #endif // AI_API_CLAUDE_H
@@ -0,0 +1,68 @@
+// ESP32_AI_Connect/AI_API_DNS_Cache.cpp
+
+#include "AI_API_DNS_Cache.h"
+
+#ifdef ENABLE_DNS_CACHE // Only compile if flag is set
+
+#include <WiFi.h>
+
+AI_API_DNS_Cache::Entry* AI_API_DNS_Cache::_find(const String& host) {
+    uint32_t now = millis();
+    for (int i = 0; i < AI_API_DNS_CACHE_SIZE; i++) {
+        Entry& entry = _entries[i];
+        if (entry.host.isEmpty() || entry.host != host) continue;
+        uint32_t ttlMs = entry.found ? AI_API_DNS_TTL_MS : AI_API_DNS_NEGATIVE_TTL_MS;
+        if (now - entry.resolvedAt < ttlMs) return &entry;
+        entry.host = ""; // Expired
+        return nullptr;
+    }
+    return nullptr;
+}
+
+bool AI_API_DNS_Cache::resolve(const String& host, IPAddress& ip, uint32_t& lookupMs) {
+    lookupMs = 0;
+    Entry* entry = _find(host);
+    if (entry != nullptr) {
+        _hits++;
+        ip = entry->ip;
+        return entry->found;
+    }
+
+    _misses++;
+    uint32_t startedAt = millis();
+    bool found = WiFi.hostByName(host.c_str(), ip) == 1;
+    lookupMs = max((uint32_t)1, (uint32_t)(millis() - startedAt));
+    #ifdef ENABLE_DEBUG_OUTPUT
+    Serial.println("DNS: " + host + (found ? String(" -> ") + ip.toString() : String(" not found")) +
+                   " in " + String(lookupMs) + " ms");
+    #endif
+
+    // Take a free slot, or replace the oldest entry
+    Entry* slot = &_entries[0];
+    for (int i = 0; i < AI_API_DNS_CACHE_SIZE; i++) {
+        if (_entries[i].host.isEmpty()) {
+            slot = &_entries[i];
+            break;
+        }
+        if ((int32_t)(_entries[i].resolvedAt - slot->resolvedAt) < 0) slot = &_entries[i];
+    }
+    slot->host = host;
+    slot->ip = ip;
+    slot->resolvedAt = millis();
+    slot->found = found;
+    return found;
+}
+
+void AI_API_DNS_Cache::invalidate(const String& host) {
+    for (int i = 0; i < AI_API_DNS_CACHE_SIZE; i++) {
+        if (_entries[i].host == host) _entries[i].host = "";
+    }
+}
+
+void AI_API_DNS_Cache::clear() {
+    for (int i = 0; i < AI_API_DNS_CACHE_SIZE; i++) {
+        _entries[i].host = "";
+    }
+}
+
+#endif // ENABLE_DNS_CACHE
@@ -0,0 +1,52 @@
+// ESP32_AI_Connect/AI_API_DNS_Cache.h
+
+#ifndef AI_API_DNS_CACHE_H
+#define AI_API_DNS_CACHE_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+
+#ifdef ENABLE_DNS_CACHE // Only compile this file's content if flag is set
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+/**
+ * AI_API_DNS_Cache - Resolved addresses of endpoint host names
+ *
+ * A host found by the resolver is kept for AI_API_DNS_TTL_MS, a host that
+ * did not resolve for AI_API_DNS_NEGATIVE_TTL_MS, so a request neither waits
+ * for a lookup it made a moment ago nor for one that just failed. When the
+ * cache is full the entry resolved longest ago is replaced.
+ *
+ * The resolver does not report record TTLs, so the lifetimes are fixed; a
+ * connection that fails at a cached address should invalidate() it.
+ */
+class AI_API_DNS_Cache {
+public:
+    // Address of 'host', from the cache or the resolver; lookupMs is the time spent
+    // resolving (0 on a hit). False if the host does not resolve.
+    bool resolve(const String& host, IPAddress& ip, uint32_t& lookupMs);
+    // Look 'host' up again on its next use
+    void invalidate(const String& host);
+    void clear();
+
+    uint32_t getHitCount() const { return _hits; }
+    uint32_t getMissCount() const { return _misses; }
+
+private:
+    struct Entry {
+        String host;            // Empty if unused
+        IPAddress ip;
+        uint32_t resolvedAt = 0;
+        bool found = false;     // false: cached lookup failure
+    };
+    Entry _entries[AI_API_DNS_CACHE_SIZE];
+    uint32_t _hits = 0;
+    uint32_t _misses = 0;
+
+    // Entry of 'host' that has not expired, nullptr if none
+    Entry* _find(const String& host);
+};
+
+#endif // ENABLE_DNS_CACHE
+#endif // AI_API_DNS_CACHE_H
@@ -21,7 +21,8 @@ void AI_API_DeepSeek_Handler::setHeaders(HTTPClient& httpClient, const String& a
 String AI_API_DeepSeek_Handler::buildRequestBody(const String& modelName, const String& systemRole,
                                                 float temperature, int maxTokens,
                                                 const String& userMessage, JsonDocument& doc,
-                                                const String& customParams) {
+                                                const String& customParams,
+                                                const AI_API_Chat_Session* history) {
     doc.clear();
 
     doc["model"] = modelName;
@@ -32,6 +33,7 @@ String AI_API_DeepSeek_Handler::buildRequestBody(const String& modelName, const
         systemMsg["role"] = "system";
         systemMsg["content"] = systemRole;
     }
+    addHistoryTurns(messages, history); // Previous turns of a chat session
     JsonObject userMsg = messages.createNestedObject();
     userMsg["role"] = "user";
     userMsg["content"] = userMessage;
@@ -39,7 +41,7 @@ String AI_API_DeepSeek_Handler::buildRequestBody(const String& modelName, const
     // Process custom parameters if provided
     if (customParams.length() > 0) {
         // Create a temporary document to parse the custom parameters
-        DynamicJsonDocument paramsDoc(512);
+        AI_API_Json_Document paramsDoc;
         DeserializationError error = deserializeJson(paramsDoc, customParams);
         
         // Only proceed if parsing was successful
@@ -87,6 +89,8 @@ String AI_API_DeepSeek_Handler::parseResponseBody(const String& responsePayload,
         if (usage.containsKey("total_tokens")) {
             _lastTotalTokens = usage["total_tokens"].as<int>(); // Store in base class member
         }
+        _lastPromptTokens = usage["prompt_tokens"] | 0;
+        _lastCacheReadTokens = usage["prompt_cache_hit_tokens"] | 0; // Context caching is automatic
     }
 
     if (doc.containsKey("choices") && doc["choices"].is<JsonArray>() && !doc["choices"].isNull() && doc["choices"].size() > 0) {
@@ -113,7 +117,8 @@ String AI_API_DeepSeek_Handler::parseResponseBody(const String& responsePayload,
 String AI_API_DeepSeek_Handler::buildStreamRequestBody(const String& modelName, const String& systemRole,
                                                       float temperature, int maxTokens,
                                                       const String& userMessage, JsonDocument& doc,
-                                                      const String& customParams) {
+                                                      const String& customParams,
+                                                      const AI_API_Chat_Session* history) {
     // Use the same logic as buildRequestBody but add "stream": true
     doc.clear();
 
@@ -126,6 +131,7 @@ String AI_API_DeepSeek_Handler::buildStreamRequestBody(const String& modelName,
         systemMsg["role"] = "system";
         systemMsg["content"] = systemRole;
     }
+    addHistoryTurns(messages, history); // Previous turns of a chat session
     JsonObject userMsg = messages.createNestedObject();
     userMsg["role"] = "user";
     userMsg["content"] = userMessage;
@@ -133,7 +139,7 @@ String AI_API_DeepSeek_Handler::buildStreamRequestBody(const String& modelName,
     // Process custom parameters if provided
     if (customParams.length() > 0) {
         // Create a temporary document to parse the custom parameters
-        DynamicJsonDocument paramsDoc(512);
+        AI_API_Json_Document paramsDoc;
         DeserializationError error = deserializeJson(paramsDoc, customParams);
         
         // Only proceed if parsing was successful
@@ -195,7 +201,7 @@ String AI_API_DeepSeek_Handler::processStreamChunk(const String& rawChunk, bool&
     }
 
     // Parse the JSON chunk
-    DynamicJsonDocument chunkDoc(512);
+    AI_API_Json_Document chunkDoc;
     DeserializationError error = deserializeJson(chunkDoc, jsonPart);
     if (error) {
         errorMsg = "Failed to parse streaming chunk JSON: " + String(error.c_str());
@@ -279,7 +285,7 @@ String AI_API_DeepSeek_Handler::buildToolCallsRequestBody(const String& modelNam
         // Check if it starts with { - might be a JSON object string
         else if (trimmedChoice.startsWith("{")) {
             // Try to parse it as a JSON object
-            DynamicJsonDocument toolChoiceDoc(512);
+            AI_API_Json_Document toolChoiceDoc;
             DeserializationError error = deserializeJson(toolChoiceDoc, trimmedChoice);
             
             if (!error) {
@@ -318,6 +324,11 @@ String AI_API_DeepSeek_Handler::buildToolCallsRequestBody(const String& modelNam
     // Add tools array (same format as OpenAI)
     JsonArray tools = doc.createNestedArray("tools");
     
+    // Add pre-rendered tools (see AI_API_Tool_Schema.h) verbatim - no parsing needed
+    for (int i = 0; i < _prebuiltToolsSize; i++) {
+        tools.add(serialized(_prebuiltTools[i].openai));
+    }
+    
     // Parse and add each tool from the toolsArray
     for (int i = 0; i < toolsArraySize; i++) {
         // Create a temporary JsonDocument to parse the tool JSON string
@@ -433,6 +444,8 @@ String AI_API_DeepSeek_Handler::parseToolCallsResponseBody(const String& respons
         if (usage.containsKey("total_tokens")) {
             _lastTotalTokens = usage["total_tokens"].as<int>(); // Store in base class member
         }
+        _lastPromptTokens = usage["prompt_tokens"] | 0;
+        _lastCacheReadTokens = usage["prompt_cache_hit_tokens"] | 0; // Context caching is automatic
     }
 
     if (doc.containsKey("choices") && doc["choices"].is<JsonArray>() && !doc["choices"].isNull() && doc["choices"].size() > 0) {
@@ -465,6 +478,26 @@ String AI_API_DeepSeek_Handler::parseToolCallsResponseBody(const String& respons
     return ""; // Return empty string if content not found
 }
 
+int AI_API_DeepSeek_Handler::getToolCallCount(const JsonDocument& doc) const {
+    return doc["choices"][0]["message"]["tool_calls"].size();
+}
+
+bool AI_API_DeepSeek_Handler::getToolCall(const JsonDocument& doc, int index, AI_API_Tool_Call& call,
+                                          JsonDocument& argsDoc) const {
+    if (index < 0) return false;
+    JsonVariantConst toolCall = doc["choices"][0]["message"]["tool_calls"][index];
+    if (toolCall.isNull()) return false;
+
+    call.id = toolCall["id"] | "";
+    call.name = toolCall["function"]["name"] | "";
+
+    // DeepSeek sends arguments as a JSON encoded string - parse it once, straight from the response
+    argsDoc.clear();
+    if (deserializeJson(argsDoc, toolCall["function"]["arguments"] | "{}")) return false;
+    call.args = argsDoc.as<JsonObjectConst>();
+    return !call.args.isNull();
+}
+
 String AI_API_DeepSeek_Handler::buildToolCallsFollowUpRequestBody(const String& modelName,
                                                                 const String* toolsArray, int toolsArraySize,
                                                                 const String& systemMessage, const String& toolChoice,
@@ -505,7 +538,7 @@ String AI_API_DeepSeek_Handler::buildToolCallsFollowUpRequestBody(const String&
     assistantMsg["role"] = "assistant";
     
     // Parse and add the tool calls
-    DynamicJsonDocument toolCallsDoc(1024);
+    AI_API_Json_Document toolCallsDoc;
     DeserializationError error = deserializeJson(toolCallsDoc, lastAssistantToolCallsJson);
     if (!error && toolCallsDoc.is<JsonArray>()) {
         JsonArray toolCalls = assistantMsg.createNestedArray("tool_calls");
@@ -531,7 +564,7 @@ String AI_API_DeepSeek_Handler::buildToolCallsFollowUpRequestBody(const String&
     }
     
     // Parse and add tool results as tool messages
-    DynamicJsonDocument toolResultsDoc(1024);
+    AI_API_Json_Document toolResultsDoc;
     error = deserializeJson(toolResultsDoc, toolResultsJson);
     if (!error && toolResultsDoc.is<JsonArray>()) {
         for (JsonVariant result : toolResultsDoc.as<JsonArray>()) {
@@ -566,7 +599,7 @@ String AI_API_DeepSeek_Handler::buildToolCallsFollowUpRequestBody(const String&
         // Check if it starts with { - might be a JSON object string
         else if (trimmedChoice.startsWith("{")) {
             // Try to parse it as a JSON object
-            DynamicJsonDocument toolChoiceDoc(512);
+            AI_API_Json_Document toolChoiceDoc;
             DeserializationError error = deserializeJson(toolChoiceDoc, trimmedChoice);
             
             if (!error) {
@@ -605,6 +638,11 @@ String AI_API_DeepSeek_Handler::buildToolCallsFollowUpRequestBody(const String&
     // Add tools array (same logic as buildToolCallsRequestBody)
     JsonArray tools = doc.createNestedArray("tools");
     
+    // Add pre-rendered tools (see AI_API_Tool_Schema.h) verbatim - no parsing needed
+    for (int i = 0; i < _prebuiltToolsSize; i++) {
+        tools.add(serialized(_prebuiltTools[i].openai));
+    }
+    
     // Parse and add each tool from the toolsArray
     for (int i = 0; i < toolsArraySize; i++) {
         // Create a temporary JsonDocument to parse the tool JSON string
@@ -16,7 +16,8 @@ public:
     String buildRequestBody(const String& modelName, const String& systemRole,
                             float temperature, int maxTokens,
                             const String& userMessage, JsonDocument& doc,
-                            const String& customParams = "") override;
+                            const String& customParams = "",
+                            const AI_API_Chat_Session* history = nullptr) override;
     String parseResponseBody(const String& responsePayload,
                              String& errorMsg, JsonDocument& doc) override;
 
@@ -25,7 +26,8 @@ public:
     String buildStreamRequestBody(const String& modelName, const String& systemRole,
                                  float temperature, int maxTokens,
                                  const String& userMessage, JsonDocument& doc,
-                                 const String& customParams = "") override;
+                                 const String& customParams = "",
+                                 const AI_API_Chat_Session* history = nullptr) override;
     String processStreamChunk(const String& rawChunk, bool& isComplete, String& errorMsg) override;
 #endif
 
@@ -39,6 +41,11 @@ public:
                                
     String parseToolCallsResponseBody(const String& responsePayload,
                                 String& errorMsg, JsonDocument& doc) override;
+
+    // Decoded tool call view (see AI_API_Platform_Handler.h)
+    int getToolCallCount(const JsonDocument& doc) const override;
+    bool getToolCall(const JsonDocument& doc, int index, AI_API_Tool_Call& call,
+                     JsonDocument& argsDoc) const override;
                                 
     // Build a follow-up request body with tool results
     // toolResultsJson: JSON array of tool results
@@ -35,7 +35,8 @@ void AI_API_Gemini_Handler::setHeaders(HTTPClient& httpClient, const String& api
 String AI_API_Gemini_Handler::buildRequestBody(const String& modelName, const String& systemRole,
                                                float temperature, int maxTokens,
                                                const String& userMessage, JsonDocument& doc,
-                                               const String& customParams) {
+                                               const String& customParams,
+                                               const AI_API_Chat_Session* history) {
     // Use the provided 'doc' reference. Clear it first.
     doc.clear();
 
@@ -51,6 +52,7 @@ String AI_API_Gemini_Handler::buildRequestBody(const String& modelName, const St
     // --- Add User Content ---
     // Reference: https://ai.google.dev/docs/rest_api_overview#request_body
     JsonArray contents = doc.createNestedArray("contents");
+    addHistoryTurns(contents, history, true); // Previous turns of a chat session
     JsonObject userContent = contents.createNestedObject();
     userContent["role"] = "user"; // Gemini uses 'user' and 'model' roles
     JsonArray userParts = userContent.createNestedArray("parts");
@@ -60,7 +62,7 @@ String AI_API_Gemini_Handler::buildRequestBody(const String& modelName, const St
     // --- Process custom parameters if provided ---
     if (customParams.length() > 0) {
         // Create a temporary document to parse the custom parameters
-        DynamicJsonDocument paramsDoc(512);
+        AI_API_Json_Document paramsDoc;
         DeserializationError error = deserializeJson(paramsDoc, customParams);
         
         // Only proceed if parsing was successful
@@ -166,6 +168,8 @@ String AI_API_Gemini_Handler::parseResponseBody(const String& responsePayload,
         if (usageMetadata.containsKey("totalTokenCount")) {
             _lastTotalTokens = usageMetadata["totalTokenCount"].as<int>(); // Store in base class member
         }
+        _lastPromptTokens = usageMetadata["promptTokenCount"] | 0;
+        _lastCacheReadTokens = usageMetadata["cachedContentTokenCount"] | 0; // Implicit caching
     }
 
     // Extract the content: response -> candidates[0] -> content -> parts[0] -> text
@@ -273,6 +277,11 @@ String AI_API_Gemini_Handler::buildToolCallsRequestBody(const String& modelName,
     JsonObject tool = tools.createNestedObject();
     JsonArray functionDeclarations = tool.createNestedArray("functionDeclarations");
     
+    // Add pre-rendered tools (see AI_API_Tool_Schema.h) verbatim - no parsing needed
+    for (int i = 0; i < _prebuiltToolsSize; i++) {
+        functionDeclarations.add(serialized(_prebuiltTools[i].gemini));
+    }
+    
     // Process each tool definition in the toolsArray
     for (int i = 0; i < toolsArraySize; i++) {
         // Parse the tool JSON
@@ -420,7 +429,7 @@ String AI_API_Gemini_Handler::buildToolCallsRequestBody(const String& modelName,
         // Check if it's a JSON object
         if (trimmedChoice.startsWith("{")) {
             // Try to parse it to see if it's valid JSON
-            DynamicJsonDocument toolChoiceDoc(512);
+            AI_API_Json_Document toolChoiceDoc;
             DeserializationError error = deserializeJson(toolChoiceDoc, trimmedChoice);
             
             if (!error && toolChoiceDoc.containsKey("type") && toolChoiceDoc["type"] == "function") {
@@ -491,6 +500,8 @@ String AI_API_Gemini_Handler::parseToolCallsResponseBody(const String& responseP
         if (usageMetadata.containsKey("totalTokenCount")) {
             _lastTotalTokens = usageMetadata["totalTokenCount"].as<int>();
         }
+        _lastPromptTokens = usageMetadata["promptTokenCount"] | 0;
+        _lastCacheReadTokens = usageMetadata["cachedContentTokenCount"] | 0; // Implicit caching
     }
 
     // Create a new result object with tool calls
@@ -583,6 +594,36 @@ String AI_API_Gemini_Handler::parseToolCallsResponseBody(const String& responseP
     }
 }
 
+int AI_API_Gemini_Handler::getToolCallCount(const JsonDocument& doc) const {
+    int count = 0;
+    for (JsonVariantConst part : doc["candidates"][0]["content"]["parts"].as<JsonArrayConst>()) {
+        if (!part["functionCall"].isNull()) count++;
+    }
+    return count;
+}
+
+bool AI_API_Gemini_Handler::getToolCall(const JsonDocument& doc, int index, AI_API_Tool_Call& call,
+                                        JsonDocument& argsDoc) const {
+    int toolIndex = 0;
+    for (JsonVariantConst part : doc["candidates"][0]["content"]["parts"].as<JsonArrayConst>()) {
+        JsonVariantConst functionCall = part["functionCall"];
+        if (functionCall.isNull()) continue;
+        if (toolIndex++ != index) continue;
+
+        call.id = functionCall["id"] | "";
+        call.name = functionCall["name"] | "";
+        call.args = functionCall["args"].as<JsonObjectConst>(); // Already an object - borrow it
+        if (call.args.isNull()) {
+            // Functions without parameters may omit "args"
+            argsDoc.clear();
+            argsDoc.to<JsonObject>();
+            call.args = argsDoc.as<JsonObjectConst>();
+        }
+        return true;
+    }
+    return false;
+}
+
 String AI_API_Gemini_Handler::buildToolCallsFollowUpRequestBody(const String& modelName,
                         const String* toolsArray, int toolsArraySize,
                         const String& systemMessage, const String& toolChoice,
@@ -707,6 +748,11 @@ String AI_API_Gemini_Handler::buildToolCallsFollowUpRequestBody(const String& mo
     JsonObject tool = tools.createNestedObject();
     JsonArray functionDeclarations = tool.createNestedArray("functionDeclarations");
     
+    // Add pre-rendered tools (see AI_API_Tool_Schema.h) verbatim - no parsing needed
+    for (int i = 0; i < _prebuiltToolsSize; i++) {
+        functionDeclarations.add(serialized(_prebuiltTools[i].gemini));
+    }
+    
     // Process each tool definition in the toolsArray (copy from buildToolCallsRequestBody)
     for (int i = 0; i < toolsArraySize; i++) {
         // Parse the tool JSON
@@ -854,7 +900,7 @@ String AI_API_Gemini_Handler::buildToolCallsFollowUpRequestBody(const String& mo
         // Check if it's a JSON object
         if (trimmedChoice.startsWith("{")) {
             // Try to parse it to see if it's valid JSON
-            DynamicJsonDocument toolChoiceDoc(512);
+            AI_API_Json_Document toolChoiceDoc;
             DeserializationError error = deserializeJson(toolChoiceDoc, trimmedChoice);
             
             if (!error && toolChoiceDoc.containsKey("type") && toolChoiceDoc["type"] == "function") {
@@ -896,7 +942,7 @@ String AI_API_Gemini_Handler::buildToolCallsFollowUpRequestBody(const String& mo
         // Check if it's a JSON object
         if (trimmedChoice.startsWith("{")) {
             // Try to parse it to see if it's valid JSON
-            DynamicJsonDocument toolChoiceDoc(512);
+            AI_API_Json_Document toolChoiceDoc;
             DeserializationError error = deserializeJson(toolChoiceDoc, trimmedChoice);
             
             if (!error && toolChoiceDoc.containsKey("type") && toolChoiceDoc["type"] == "function") {
@@ -943,7 +989,8 @@ String AI_API_Gemini_Handler::buildToolCallsFollowUpRequestBody(const String& mo
 String AI_API_Gemini_Handler::buildStreamRequestBody(const String& modelName, const String& systemRole,
                                                     float temperature, int maxTokens,
                                                     const String& userMessage, JsonDocument& doc,
-                                                    const String& customParams) {
+                                                    const String& customParams,
+                                                    const AI_API_Chat_Session* history) {
     // Use the same logic as buildRequestBody but DON'T add "stream": true
     // Gemini streaming uses a different endpoint (:streamGenerateContent) instead
     doc.clear();
@@ -958,6 +1005,7 @@ String AI_API_Gemini_Handler::buildStreamRequestBody(const String& modelName, co
 
     // --- Add User Content ---
     JsonArray contents = doc.createNestedArray("contents");
+    addHistoryTurns(contents, history, true); // Previous turns of a chat session
     JsonObject userContent = contents.createNestedObject();
     userContent["role"] = "user";
     JsonArray userParts = userContent.createNestedArray("parts");
@@ -967,7 +1015,7 @@ String AI_API_Gemini_Handler::buildStreamRequestBody(const String& modelName, co
     // --- Process custom parameters if provided ---
     if (customParams.length() > 0) {
         // Create a temporary document to parse the custom parameters
-        DynamicJsonDocument paramsDoc(512);
+        AI_API_Json_Document paramsDoc;
         DeserializationError error = deserializeJson(paramsDoc, customParams);
         
         // Only proceed if parsing was successful
@@ -1066,7 +1114,7 @@ String AI_API_Gemini_Handler::processStreamChunk(const String& rawChunk, bool& i
     }
 
     // Parse the JSON chunk
-    DynamicJsonDocument chunkDoc(1024); // Larger buffer for Gemini responses
+    AI_API_Json_Document chunkDoc;
     DeserializationError error = deserializeJson(chunkDoc, jsonPart);
     if (error) {
         errorMsg = "Failed to parse Gemini streaming chunk JSON: " + String(error.c_str());
@@ -1085,6 +1133,8 @@ String AI_API_Gemini_Handler::processStreamChunk(const String& rawChunk, bool& i
         if (usageMetadata.containsKey("totalTokenCount")) {
             _lastTotalTokens = usageMetadata["totalTokenCount"].as<int>();
         }
+        _lastPromptTokens = usageMetadata["promptTokenCount"] | 0;
+        _lastCacheReadTokens = usageMetadata["cachedContentTokenCount"] | 0; // Implicit caching
     }
 
     // Extract content from candidates array
@@ -0,0 +1,553 @@
+// ESP32_AI_Connect/AI_API_Gzip_Decoder.cpp
+
+#include "AI_API_Gzip_Decoder.h"
+#include "AI_API_Memory.h"
+
+#ifdef ENABLE_COMPRESSION // Only compile if flag is set
+
+#define INFLATE_WINDOW_MASK (AI_API_INFLATE_WINDOW_SIZE - 1)
+#define INFLATE_PULL_SLICE 4096  // Bytes inflated per refill in pull mode
+#define INFLATE_STORED_SLICE 1024 // Bytes of a stored block copied per step
+
+// Base values and extra bits of length symbols 257..285 and distance symbols 0..29 (RFC 1951 3.2.5)
+static const uint16_t lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                         35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                         3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t distBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                       257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                       8193, 12289, 16385, 24577 };
+static const uint8_t distExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                       7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+// Order code length code lengths are sent in
+static const uint8_t codeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+// CRC-32 (gzip), four bits at a time
+static const uint32_t crcTable[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t length) {
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ crcTable[crc & 15];
+        crc = (crc >> 4) ^ crcTable[crc & 15];
+    }
+    return ~crc;
+}
+
+static uint32_t adler32Update(uint32_t adler, const uint8_t* data, size_t length) {
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+    while (length > 0) {
+        size_t n = length < 5552 ? length : 5552; // Largest run that cannot overflow b
+        length -= n;
+        while (n-- > 0) {
+            a += *data++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+AI_API_Gzip_Decoder::AI_API_Gzip_Decoder() {
+}
+
+AI_API_Gzip_Decoder::~AI_API_Gzip_Decoder() {
+    end();
+}
+
+bool AI_API_Gzip_Decoder::formatFor(const String& contentEncoding, Format& format) {
+    String encoding = contentEncoding;
+    encoding.trim();
+    encoding.toLowerCase();
+    if (encoding == "gzip" || encoding == "x-gzip") {
+        format = Format::GZIP;
+        return true;
+    }
+    if (encoding == "deflate") {
+        format = Format::DEFLATE;
+        return true;
+    }
+    return false;
+}
+
+bool AI_API_Gzip_Decoder::begin(String& output, Format format) {
+    if (!_start(format)) return false;
+    _output = &output;
+    return true;
+}
+
+bool AI_API_Gzip_Decoder::begin(Stream& source, bool chunked, Format format) {
+    if (!_start(format)) return false;
+    _source = &source;
+    _chunked = chunked;
+    return true;
+}
+
+bool AI_API_Gzip_Decoder::_start(Format format) {
+    if (_buf == nullptr) {
+        _buf = (Buffers*)AI_API_Memory::allocate(sizeof(Buffers));
+        if (_buf == nullptr) {
+            _fail("Not enough memory for the inflate window");
+            return false;
+        }
+    }
+    _output = nullptr;
+    _source = nullptr;
+    _format = format;
+    _state = State::HEADER;
+    _error = "";
+    _chunked = false;
+    _chunk = Chunk::SIZE;
+    _chunkLeft = 0;
+    _inLen = 0;
+    _inPos = 0;
+    _bitBuf = 0;
+    _bitCount = 0;
+    _lastBlock = false;
+    _storedLeft = 0;
+    _outTotal = 0;
+    _committed = 0;
+    _readTotal = 0;
+    _zlib = false;
+    _check = format == Format::GZIP ? 0 : 1; // CRC-32 / Adler-32 start values
+    _compressedBytes = 0;
+    return true;
+}
+
+void AI_API_Gzip_Decoder::end() {
+    if (_buf != nullptr) {
+        AI_API_Memory::deallocate(_buf);
+        _buf = nullptr;
+    }
+    _output = nullptr;
+    _source = nullptr;
+}
+
+// --- Input ---
+
+size_t AI_API_Gzip_Decoder::write(uint8_t b) {
+    return write(&b, 1);
+}
+
+size_t AI_API_Gzip_Decoder::write(const uint8_t* buffer, size_t size) {
+    if (_buf == nullptr || _output == nullptr || _state == State::FAILED) return 0;
+    size_t taken = 0;
+    while (taken < size && _state != State::DONE) {
+        size_t n = min(size - taken, (size_t)AI_API_INFLATE_INPUT_SIZE - _inLen);
+        memcpy(_buf->input + _inLen, buffer + taken, n);
+        _inLen += n;
+        taken += n;
+        _compressedBytes += n;
+        _run(UINT32_MAX);
+        if (_state == State::FAILED) return 0; // HTTPClient stops reading the body
+    }
+    return size; // Anything after the end of the compressed data is ignored
+}
+
+void AI_API_Gzip_Decoder::_fill() {
+    while (_inLen < AI_API_INFLATE_INPUT_SIZE && _source->available() > 0) {
+        size_t space = AI_API_INFLATE_INPUT_SIZE - _inLen;
+        if (!_chunked || _chunk == Chunk::DATA) {
+            size_t n = min(space, (size_t)_source->available());
+            if (_chunked) n = min(n, (size_t)_chunkLeft);
+            n = _source->readBytes((char*)_buf->input + _inLen, n);
+            if (n == 0) return;
+            _inLen += n;
+            _compressedBytes += n;
+            if (_chunked) {
+                _chunkLeft -= n;
+                if (_chunkLeft == 0) _chunk = Chunk::DATA_END;
+            }
+            continue;
+        }
+
+        // Chunked framing: "<hex size>[;extension]\r\n<data>\r\n" ... "0\r\n\r\n"
+        int c = _source->read();
+        if (c < 0) return;
+        switch (_chunk) {
+            case Chunk::SIZE:
+                if (c >= '0' && c <= '9') {
+                    _chunkLeft = _chunkLeft * 16 + (c - '0');
+                } else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+                    _chunkLeft = _chunkLeft * 16 + ((c | 0x20) - 'a' + 10);
+                } else if (c == '\n') {
+                    _chunk = _chunkLeft > 0 ? Chunk::DATA : Chunk::END;
+                } else {
+                    _chunk = Chunk::EXTENSION; // ';' extension or '\r'
+                }
+                break;
+            case Chunk::EXTENSION:
+                if (c == '\n') _chunk = _chunkLeft > 0 ? Chunk::DATA : Chunk::END;
+                break;
+            case Chunk::DATA_END:
+                if (c == '\n') {
+                    _chunk = Chunk::SIZE;
+                    _chunkLeft = 0;
+                }
+                break;
+            default:
+                return; // END: trailers are not read
+        }
+    }
+}
+
+// --- Output ---
+
+int AI_API_Gzip_Decoder::available() {
+    if (_source == nullptr) return 0;
+    if (_readTotal == _outTotal && _state != State::DONE && _state != State::FAILED) {
+        _fill();
+        _run(INFLATE_PULL_SLICE);
+    }
+    return (int)(_outTotal - _readTotal);
+}
+
+int AI_API_Gzip_Decoder::read() {
+    if (available() == 0) return -1;
+    return _buf->window[_readTotal++ & INFLATE_WINDOW_MASK];
+}
+
+int AI_API_Gzip_Decoder::peek() {
+    if (available() == 0) return -1;
+    return _buf->window[_readTotal & INFLATE_WINDOW_MASK];
+}
+
+void AI_API_Gzip_Decoder::_put(uint8_t b) {
+    _buf->window[_outTotal++ & INFLATE_WINDOW_MASK] = b;
+}
+
+void AI_API_Gzip_Decoder::_commit() {
+    while (_committed != _outTotal) {
+        uint32_t from = _committed & INFLATE_WINDOW_MASK;
+        uint32_t n = min(_outTotal - _committed, (uint32_t)AI_API_INFLATE_WINDOW_SIZE - from);
+        const uint8_t* data = _buf->window + from;
+        _check = _format == Format::GZIP ? crc32Update(_check, data, n) : adler32Update(_check, data, n);
+        if (_output != nullptr) _output->concat((const char*)data, n);
+        _committed += n;
+    }
+}
+
+// --- Inflate ---
+
+void AI_API_Gzip_Decoder::_run(uint32_t limit) {
+    uint32_t start = _outTotal;
+    bool needInput = false;
+    while (_state != State::DONE && _state != State::FAILED) {
+        size_t inPos = _inPos;
+        uint32_t bitBuf = _bitBuf;
+        uint8_t bitCount = _bitCount;
+        int result = _step();
+        if (result == 0) {
+            // Decode it again once the rest of its bits are in
+            _inPos = inPos;
+            _bitBuf = bitBuf;
+            _bitCount = bitCount;
+            needInput = true;
+            break;
+        }
+        // Keep the bytes not yet checksummed inside the window
+        if (_outTotal - _committed >= AI_API_INFLATE_WINDOW_SIZE / 2) _commit();
+        if (_outTotal - start >= limit) break;
+    }
+    _commit();
+
+    if (_inPos > 0) {
+        memmove(_buf->input, _buf->input + _inPos, _inLen - _inPos);
+        _inLen -= _inPos;
+        _inPos = 0;
+    }
+    if (needInput && _inLen == AI_API_INFLATE_INPUT_SIZE) {
+        _fail("Compressed block header larger than the input buffer");
+    }
+}
+
+int AI_API_Gzip_Decoder::_step() {
+    switch (_state) {
+        case State::HEADER: return _stepHeader();
+        case State::BLOCK: return _stepBlock();
+        case State::STORED: return _stepStored();
+        case State::CODES: return _stepCodes();
+        case State::TRAILER: return _stepTrailer();
+        default: return -1;
+    }
+}
+
+int AI_API_Gzip_Decoder::_fail(const char* error) {
+    _state = State::FAILED;
+    _error = error;
+    return -1;
+}
+
+bool AI_API_Gzip_Decoder::_bits(uint8_t n, uint32_t& value) {
+    while (_bitCount < n) {
+        if (_inPos >= _inLen) return false;
+        _bitBuf |= (uint32_t)_buf->input[_inPos++] << _bitCount;
+        _bitCount += 8;
+    }
+    value = _bitBuf & ((1UL << n) - 1);
+    _bitBuf >>= n;
+    _bitCount -= n;
+    return true;
+}
+
+void AI_API_Gzip_Decoder::_alignToByte() {
+    _bitBuf >>= _bitCount & 7;
+    _bitCount -= _bitCount & 7;
+}
+
+int AI_API_Gzip_Decoder::_stepHeader() {
+    uint32_t b0, b1;
+    if (_format == Format::DEFLATE) {
+        if (!_bits(8, b0) || !_bits(8, b1)) return 0;
+        uint32_t header = (b0 << 8) | b1;
+        if ((b0 & 0x0F) == 8 && (b0 >> 4) <= 7 && header % 31 == 0) {
+            if (b1 & 0x20) return _fail("Deflate stream needs a preset dictionary");
+            _zlib = true;
+        } else {
+            _inPos -= 2; // Raw deflate: those were the first block's bits
+            _bitBuf = 0;
+            _bitCount = 0;
+        }
+        _state = State::BLOCK;
+        return 1;
+    }
+
+    // ID1 ID2 CM FLG MTIME(4) XFL OS [XLEN extra] [name\0] [comment\0] [CRC16]
+    uint32_t magic, method, flags, skip;
+    if (!_bits(16, magic) || !_bits(8, method) || !_bits(8, flags) ||
+        !_bits(16, skip) || !_bits(16, skip) || !_bits(16, skip)) {
+        return 0;
+    }
+    if (magic != 0x8B1F || method != 8) return _fail("Not a gzip stream");
+    if (flags & 0x04) { // FEXTRA
+        uint32_t length;
+        if (!_bits(16, length)) return 0;
+        while (length-- > 0) {
+            if (!_bits(8, skip)) return 0;
+        }
+    }
+    for (uint32_t flag = 0x08; flag <= 0x10; flag <<= 1) { // FNAME, FCOMMENT
+        if (!(flags & flag)) continue;
+        do {
+            if (!_bits(8, skip)) return 0;
+        } while (skip != 0);
+    }
+    if ((flags & 0x02) && !_bits(16, skip)) return 0; // FHCRC
+    _state = State::BLOCK;
+    return 1;
+}
+
+int AI_API_Gzip_Decoder::_stepBlock() {
+    if (_lastBlock) {
+        _state = State::TRAILER;
+        return 1;
+    }
+    uint32_t last, type;
+    if (!_bits(1, last) || !_bits(2, type)) return 0;
+
+    if (type == 0) {
+        uint32_t length, inverted;
+        _alignToByte();
+        if (!_bits(16, length) || !_bits(16, inverted)) return 0;
+        if (length != (~inverted & 0xFFFF)) return _fail("Corrupt stored block length");
+        _storedLeft = length;
+        _state = State::STORED;
+    } else if (type == 1) {
+        uint16_t lengths[288 + 30];
+        int symbol = 0;
+        for (; symbol < 144; symbol++) lengths[symbol] = 8;
+        for (; symbol < 256; symbol++) lengths[symbol] = 9;
+        for (; symbol < 280; symbol++) lengths[symbol] = 7;
+        for (; symbol < 288; symbol++) lengths[symbol] = 8;
+        for (; symbol < 288 + 30; symbol++) lengths[symbol] = 5;
+        _buildHuffman(_buf->lencode, lengths, 288);
+        _buildHuffman(_buf->distcode, lengths + 288, 30);
+        _state = State::CODES;
+    } else if (type == 2) {
+        int result = _readDynamicTables();
+        if (result <= 0) return result;
+        _state = State::CODES;
+    } else {
+        return _fail("Invalid deflate block type");
+    }
+    _lastBlock = last != 0;
+    return 1;
+}
+
+int AI_API_Gzip_Decoder::_stepStored() {
+    uint32_t copied = 0;
+    uint32_t b;
+    while (_storedLeft > 0 && copied < INFLATE_STORED_SLICE && _bits(8, b)) {
+        _put((uint8_t)b);
+        _storedLeft--;
+        copied++;
+    }
+    if (_storedLeft == 0) {
+        _state = State::BLOCK;
+        return 1;
+    }
+    return copied > 0 ? 1 : 0;
+}
+
+int AI_API_Gzip_Decoder::_stepCodes() {
+    int symbol = _decode(_buf->lencode);
+    if (symbol == -1) return 0;
+    if (symbol < 0) return _fail("Invalid literal/length code");
+    if (symbol < 256) {
+        _put((uint8_t)symbol);
+        return 1;
+    }
+    if (symbol == 256) { // End of block
+        _state = State::BLOCK;
+        return 1;
+    }
+
+    symbol -= 257;
+    if (symbol >= 29) return _fail("Invalid length symbol");
+    uint32_t extra;
+    if (!_bits(lengthExtra[symbol], extra)) return 0;
+    uint32_t length = lengthBase[symbol] + extra;
+
+    symbol = _decode(_buf->distcode);
+    if (symbol == -1) return 0;
+    if (symbol < 0 || symbol >= 30) return _fail("Invalid distance code");
+    if (!_bits(distExtra[symbol], extra)) return 0;
+    uint32_t distance = distBase[symbol] + extra;
+    if (distance > _outTotal) return _fail("Distance before the start of the data");
+
+    while (length-- > 0) {
+        _put(_buf->window[(_outTotal - distance) & INFLATE_WINDOW_MASK]);
+    }
+    return 1;
+}
+
+int AI_API_Gzip_Decoder::_stepTrailer() {
+    uint32_t low, high;
+    _alignToByte();
+    if (_format == Format::GZIP) {
+        // CRC-32 and length modulo 2^32, little-endian
+        uint32_t sizeLow, sizeHigh;
+        if (!_bits(16, low) || !_bits(16, high) || !_bits(16, sizeLow) || !_bits(16, sizeHigh)) return 0;
+        _commit();
+        if (((high << 16) | low) != _check) return _fail("gzip CRC mismatch");
+        if (((sizeHigh << 16) | sizeLow) != _outTotal) return _fail("gzip length mismatch");
+    } else if (_zlib) {
+        // Adler-32, big-endian
+        uint32_t b[4];
+        for (int i = 0; i < 4; i++) {
+            if (!_bits(8, b[i])) return 0;
+        }
+        _commit();
+        if (((b[0] << 24) | (b[1] << 16) | (b[2] << 8) | b[3]) != _check) return _fail("zlib Adler-32 mismatch");
+    }
+    _state = State::DONE;
+    return 1;
+}
+
+// --- Huffman codes (canonical, decoded a bit at a time as in zlib's puff) ---
+
+int AI_API_Gzip_Decoder::_buildHuffman(Huffman& h, const uint16_t* lengths, int n) {
+    uint16_t offsets[16];
+    memset(h.count, 0, sizeof(h.count));
+    for (int symbol = 0; symbol < n; symbol++) h.count[lengths[symbol]]++;
+    if (h.count[0] == n) return 0; // No codes: complete, but decoding fails
+
+    int left = 1; // Codes of the current length still unassigned
+    for (int len = 1; len < 16; len++) {
+        left <<= 1;
+        left -= h.count[len];
+        if (left < 0) return -1; // Over-subscribed
+    }
+
+    offsets[1] = 0;
+    for (int len = 1; len < 15; len++) offsets[len + 1] = offsets[len] + h.count[len];
+    for (int symbol = 0; symbol < n; symbol++) {
+        if (lengths[symbol] != 0) h.symbol[offsets[lengths[symbol]]++] = symbol;
+    }
+    return left; // > 0: incomplete
+}
+
+int AI_API_Gzip_Decoder::_decode(const Huffman& h) {
+    int code = 0;  // Bits read so far
+    int first = 0; // First code of the current length
+    int index = 0; // Index of that code in h.symbol
+    uint32_t bit;
+    for (int len = 1; len < 16; len++) {
+        if (!_bits(1, bit)) return -1;
+        code |= bit;
+        int count = h.count[len];
+        if (code - count < first) return h.symbol[index + (code - first)];
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -2;
+}
+
+int AI_API_Gzip_Decoder::_readDynamicTables() {
+    uint16_t lengths[286 + 30];
+    uint32_t nlen, ndist, ncode, value;
+    if (!_bits(5, nlen) || !_bits(5, ndist) || !_bits(4, ncode)) return 0;
+    nlen += 257;
+    ndist += 1;
+    ncode += 4;
+    if (nlen > 286 || ndist > 30) return _fail("Bad dynamic block counts");
+
+    // Code length code, built into lencode for the moment
+    for (uint32_t i = 0; i < 19; i++) {
+        if (i < ncode) {
+            if (!_bits(3, value)) return 0;
+            lengths[codeLengthOrder[i]] = value;
+        } else {
+            lengths[codeLengthOrder[i]] = 0;
+        }
+    }
+    if (_buildHuffman(_buf->lencode, lengths, 19) != 0) return _fail("Incomplete code length code");
+
+    for (uint32_t index = 0; index < nlen + ndist;) {
+        int symbol = _decode(_buf->lencode);
+        if (symbol == -1) return 0;
+        if (symbol < 0) return _fail("Invalid code length code");
+        if (symbol < 16) {
+            lengths[index++] = symbol;
+            continue;
+        }
+        uint16_t length = 0;
+        uint32_t repeat;
+        if (symbol == 16) {
+            if (index == 0) return _fail("Repeat with no first length");
+            length = lengths[index - 1];
+            if (!_bits(2, repeat)) return 0;
+            repeat += 3;
+        } else if (symbol == 17) {
+            if (!_bits(3, repeat)) return 0;
+            repeat += 3;
+        } else {
+            if (!_bits(7, repeat)) return 0;
+            repeat += 11;
+        }
+        if (index + repeat > nlen + ndist) return _fail("Too many code lengths");
+        while (repeat-- > 0) lengths[index++] = length;
+    }
+    if (lengths[256] == 0) return _fail("No end-of-block code");
+
+    // Incomplete codes are only allowed with a single code
+    int left = _buildHuffman(_buf->lencode, lengths, nlen);
+    if (left < 0 || (left > 0 && nlen != (uint32_t)(_buf->lencode.count[0] + _buf->lencode.count[1]))) {
+        return _fail("Invalid literal/length code lengths");
+    }
+    left = _buildHuffman(_buf->distcode, lengths + nlen, ndist);
+    if (left < 0 || (left > 0 && ndist != (uint32_t)(_buf->distcode.count[0] + _buf->distcode.count[1]))) {
+        return _fail("Invalid distance code lengths");
+    }
+    return 1;
+}
+
+#endif // ENABLE_COMPRESSION
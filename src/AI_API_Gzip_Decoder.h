@@ -0,0 +1,138 @@
+// ESP32_AI_Connect/AI_API_Gzip_Decoder.h
+
+#ifndef AI_API_GZIP_DECODER_H
+#define AI_API_GZIP_DECODER_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+
+#ifdef ENABLE_COMPRESSION // Only compile this file's content if flag is set
+
+#include <Arduino.h>
+
+// Largest distance a deflate match can reach back
+#define AI_API_INFLATE_WINDOW_SIZE 32768
+
+/**
+ * AI_API_Gzip_Decoder - Inflates a gzip or deflate response body as it arrives
+ *
+ * Push mode (blocking requests): pass the decoder to HTTPClient::writeToStream();
+ * the compressed body is written to it in pieces and the inflated body is
+ * appended to a String.
+ *
+ * Pull mode (streaming): the decoder wraps the connection and is read like it,
+ * e.g. with readStringUntil('\n'); it reads compressed bytes from the
+ * connection as they arrive and strips HTTP/1.1 chunked framing if asked to.
+ *
+ * Only AI_API_INFLATE_INPUT_SIZE compressed bytes are buffered; each code
+ * is decoded once all its bits are there, so a body split anywhere decodes
+ * the same. The window of past output matches can refer to is 32 KB, the
+ * deflate maximum, and is allocated by begin() and freed by end(). The gzip
+ * CRC-32 / zlib Adler-32 and length are checked at the end.
+ */
+class AI_API_Gzip_Decoder : public Stream {
+public:
+    enum class Format {
+        GZIP,   // Content-Encoding: gzip
+        DEFLATE // Content-Encoding: deflate (zlib stream, or a raw deflate stream)
+    };
+
+    AI_API_Gzip_Decoder();
+    ~AI_API_Gzip_Decoder();
+
+    // Push mode: write() the compressed body; the inflated body is appended to 'output'
+    bool begin(String& output, Format format);
+    // Pull mode: inflate what arrives on 'source'; 'chunked' removes chunked transfer framing
+    bool begin(Stream& source, bool chunked, Format format);
+    // Free the window
+    void end();
+
+    // Format of a Content-Encoding value; false if it is not compressed or not supported
+    static bool formatFor(const String& contentEncoding, Format& format);
+
+    size_t write(uint8_t b) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() override {}
+
+    // The whole body was inflated and its checksum matched
+    bool isFinished() const { return _state == State::DONE; }
+    bool hasError() const { return _state == State::FAILED; }
+    const char* getError() const { return _error; }
+    // Compressed body bytes taken in (without chunk framing) and bytes inflated from them
+    uint32_t getCompressedBytes() const { return _compressedBytes; }
+    uint32_t getInflatedBytes() const { return _outTotal; }
+
+private:
+    enum class State : uint8_t { HEADER, BLOCK, STORED, CODES, TRAILER, DONE, FAILED };
+    enum class Chunk : uint8_t { SIZE, EXTENSION, DATA, DATA_END, END };
+
+    // Canonical Huffman code: codes per bit length, then symbols in code order
+    struct Huffman {
+        uint16_t count[16];
+        uint16_t symbol[288];
+    };
+    // Heap part, allocated by begin()
+    struct Buffers {
+        uint8_t window[AI_API_INFLATE_WINDOW_SIZE];
+        uint8_t input[AI_API_INFLATE_INPUT_SIZE];
+        Huffman lencode;
+        Huffman distcode;
+    };
+
+    Buffers* _buf = nullptr;
+    String* _output = nullptr; // Push mode
+    Stream* _source = nullptr; // Pull mode
+    Format _format = Format::GZIP;
+    State _state = State::FAILED;
+    const char* _error = "Not started";
+
+    bool _chunked = false;
+    Chunk _chunk = Chunk::SIZE;
+    uint32_t _chunkLeft = 0;
+
+    size_t _inLen = 0;     // Bytes in input
+    size_t _inPos = 0;     // Next byte to take into _bitBuf
+    uint32_t _bitBuf = 0;
+    uint8_t _bitCount = 0;
+
+    bool _lastBlock = false;
+    uint32_t _storedLeft = 0;
+
+    uint32_t _outTotal = 0;   // Bytes inflated; _outTotal % window size is the next window slot
+    uint32_t _committed = 0;  // Bytes checksummed (and appended to _output)
+    uint32_t _readTotal = 0;  // Pull mode: bytes returned by read()
+    uint32_t _check = 0;      // CRC-32 (gzip) or Adler-32 (zlib) so far
+    bool _zlib = false;       // DEFLATE body carries a zlib header and trailer
+    uint32_t _compressedBytes = 0;
+
+    bool _start(Format format);
+    // Take compressed bytes from _source into the input buffer (pull mode)
+    void _fill();
+    // Inflate until 'limit' bytes were produced or the input runs out
+    void _run(uint32_t limit);
+    // Checksum the bytes inflated since the last commit and hand them to _output
+    void _commit();
+    // One step of the current state: 1 done, 0 needs more input (undone by _run), -1 failed
+    int _step();
+    int _stepHeader();
+    int _stepBlock();
+    int _stepStored();
+    int _stepCodes();
+    int _stepTrailer();
+    int _fail(const char* error);
+
+    bool _bits(uint8_t n, uint32_t& value);
+    void _alignToByte();
+    int _decode(const Huffman& h);          // Symbol, -1 needs input, -2 invalid code
+    int _buildHuffman(Huffman& h, const uint16_t* lengths, int n);
+    int _readDynamicTables();
+    void _put(uint8_t b);
+
+    AI_API_Gzip_Decoder(const AI_API_Gzip_Decoder&);
+    AI_API_Gzip_Decoder& operator=(const AI_API_Gzip_Decoder&);
+};
+
+#endif // ENABLE_COMPRESSION
+#endif // AI_API_GZIP_DECODER_H
@@ -0,0 +1,87 @@
+// ESP32_AI_Connect/AI_API_Handler_Registry.cpp
+
+#include "AI_API_Handler_Registry.h"
+
+#ifdef USE_AI_API_OPENAI
+#include "AI_API_OpenAI.h"
+#endif
+#ifdef USE_AI_API_GEMINI
+#include "AI_API_Gemini.h"
+#endif
+#ifdef USE_AI_API_DEEPSEEK
+#include "AI_API_DeepSeek.h"
+#endif
+#ifdef USE_AI_API_CLAUDE
+#include "AI_API_Claude.h"
+#endif
+
+AI_API_Handler_Registry::Entry AI_API_Handler_Registry::_entries[AI_API_HANDLER_REGISTRY_SIZE];
+int AI_API_Handler_Registry::_count = 0;
+bool AI_API_Handler_Registry::_builtinsAdded = false;
+
+void AI_API_Handler_Registry::_addBuiltins() {
+    if (_builtinsAdded) return;
+    _builtinsAdded = true; // Set first: add() calls back into this function
+
+    #ifdef USE_AI_API_OPENAI
+    add("openai", &AI_API_Handler_Factory<AI_API_OpenAI_Handler>);
+    add("openai-compatible", &AI_API_Handler_Factory<AI_API_OpenAI_Handler>);
+    #endif
+    #ifdef USE_AI_API_GEMINI
+    add("gemini", &AI_API_Handler_Factory<AI_API_Gemini_Handler>);
+    #endif
+    #ifdef USE_AI_API_DEEPSEEK
+    add("deepseek", &AI_API_Handler_Factory<AI_API_DeepSeek_Handler>);
+    #endif
+    #ifdef USE_AI_API_CLAUDE
+    add("claude", &AI_API_Handler_Factory<AI_API_Claude_Handler>);
+    #endif
+}
+
+int AI_API_Handler_Registry::_find(uint32_t id, const char* name) {
+    for (int i = 0; i < _count; i++) {
+        // The name comparison only runs on a hash match and guards against collisions
+        if (_entries[i].id == id && strcmp(_entries[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+bool AI_API_Handler_Registry::add(const char* name, Factory factory) {
+    if (name == nullptr || factory == nullptr) return false;
+    _addBuiltins(); // Built-ins first, so a later registration can replace them
+
+    uint32_t id = hash(name);
+    int index = _find(id, name);
+    if (index < 0) {
+        if (_count >= AI_API_HANDLER_REGISTRY_SIZE) {
+            Serial.println("ERROR: Handler registry full, cannot register '" + String(name) + "'");
+            return false;
+        }
+        index = _count++;
+    }
+    _entries[index].id = id;
+    _entries[index].name = name;
+    _entries[index].factory = factory;
+    return true;
+}
+
+AI_API_Platform_Handler* AI_API_Handler_Registry::create(const String& name) {
+    _addBuiltins();
+    int index = _find(hash(name.c_str()), name.c_str());
+    return index >= 0 ? _entries[index].factory() : nullptr;
+}
+
+bool AI_API_Handler_Registry::contains(const String& name) {
+    _addBuiltins();
+    return _find(hash(name.c_str()), name.c_str()) >= 0;
+}
+
+int AI_API_Handler_Registry::getCount() {
+    _addBuiltins();
+    return _count;
+}
+
+const char* AI_API_Handler_Registry::getName(int index) {
+    _addBuiltins();
+    return (index >= 0 && index < _count) ? _entries[index].name : nullptr;
+}
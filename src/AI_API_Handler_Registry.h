@@ -0,0 +1,71 @@
+// ESP32_AI_Connect/AI_API_Handler_Registry.h
+
+#ifndef AI_API_HANDLER_REGISTRY_H
+#define AI_API_HANDLER_REGISTRY_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+#include <Arduino.h>
+#include "AI_API_Platform_Handler.h"
+
+/**
+ * AI_API_Handler_Registry - Maps platform identifiers to handler factories
+ *
+ * Platforms are looked up by a 32-bit FNV-1a hash of their lowercase name,
+ * which hash() computes at compile time for string literals. The built-in
+ * handlers enabled in ESP32_AI_Connect_config.h are registered on first use;
+ * other handlers plug in without changes to the library, either at file scope
+ *   AI_API_REGISTER_HANDLER("mistral", My_Mistral_Handler);
+ * or at run time before begin()
+ *   AI_API_Handler_Registry::add("mistral", &AI_API_Handler_Factory<My_Mistral_Handler>);
+ * Registering a name again replaces the earlier factory (including built-ins).
+ */
+class AI_API_Handler_Registry {
+public:
+    typedef AI_API_Platform_Handler* (*Factory)();
+
+    // FNV-1a hash of a platform name; case-sensitive, so pass lowercase names
+    static constexpr uint32_t hash(const char* name, uint32_t seed = 2166136261UL) {
+        return *name ? hash(name + 1, (uint32_t)((seed ^ (uint8_t)*name) * 16777619UL)) : seed;
+    }
+
+    // Register 'factory' under a lowercase 'name' (must stay valid, e.g. a literal)
+    static bool add(const char* name, Factory factory);
+    // New handler for a lowercase platform name, nullptr if none is registered
+    static AI_API_Platform_Handler* create(const String& name);
+    static bool contains(const String& name);
+
+    // Registered platforms, for listing
+    static int getCount();
+    static const char* getName(int index);
+
+private:
+    struct Entry {
+        uint32_t id;
+        const char* name;
+        Factory factory;
+    };
+
+    // Constant-initialized, so add() works from other files' static initializers
+    static Entry _entries[AI_API_HANDLER_REGISTRY_SIZE];
+    static int _count;
+    static bool _builtinsAdded;
+
+    static void _addBuiltins();
+    static int _find(uint32_t id, const char* name);
+};
+
+// Factory for any handler class with a default constructor
+template <typename Handler>
+AI_API_Platform_Handler* AI_API_Handler_Factory() {
+    return new Handler();
+}
+
+#define AI_API_REGISTRY_CONCAT2(a, b) a##b
+#define AI_API_REGISTRY_CONCAT(a, b) AI_API_REGISTRY_CONCAT2(a, b)
+
+// Register Handler under 'name' during static initialization (use at file scope)
+#define AI_API_REGISTER_HANDLER(name, Handler)                                          \
+    static const bool AI_API_REGISTRY_CONCAT(aiApiHandlerRegistered_, __LINE__) =       \
+        AI_API_Handler_Registry::add(name, &AI_API_Handler_Factory<Handler>)
+
+#endif // AI_API_HANDLER_REGISTRY_H
@@ -0,0 +1,44 @@
+// ESP32_AI_Connect/AI_API_Latency_Stats.cpp
+
+#include "AI_API_Latency_Stats.h"
+
+#ifdef ENABLE_LATENCY_ROUTING // Only compile if flag is set
+
+// Quantile step as a fraction of the current EWMA
+#define AI_API_LATENCY_QUANTILE_STEP 0.05f
+
+// Move estimate 'q' of quantile 'p' towards sample 'x'
+static void updateQuantile(float& q, float p, float x, float step) {
+    if (x > q) {
+        q += step * p;
+    } else if (x < q) {
+        q -= step * (1.0f - p);
+    }
+}
+
+void AI_API_Latency_Stats::addSample(Metric metric, uint32_t ms) {
+    if (metric >= METRIC_COUNT) return;
+
+    Estimate& estimate = _metrics[metric];
+    float x = (float)ms;
+    if (estimate.samples == 0) {
+        estimate.ewma = x;
+        estimate.p50 = x;
+        estimate.p90 = x;
+    } else {
+        estimate.ewma += AI_API_ROUTING_EWMA_ALPHA * (x - estimate.ewma);
+        float step = estimate.ewma * AI_API_LATENCY_QUANTILE_STEP;
+        updateQuantile(estimate.p50, 0.5f, x, step);
+        updateQuantile(estimate.p90, 0.9f, x, step);
+        if (estimate.p90 < estimate.p50) estimate.p90 = estimate.p50;
+    }
+    estimate.samples++;
+}
+
+void AI_API_Latency_Stats::reset() {
+    for (int i = 0; i < METRIC_COUNT; i++) {
+        _metrics[i] = Estimate();
+    }
+}
+
+#endif // ENABLE_LATENCY_ROUTING
@@ -0,0 +1,48 @@
+// ESP32_AI_Connect/AI_API_Latency_Stats.h
+
+#ifndef AI_API_LATENCY_STATS_H
+#define AI_API_LATENCY_STATS_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+
+#ifdef ENABLE_LATENCY_ROUTING // Only compile this file's content if flag is set
+
+#include <Arduino.h>
+
+/**
+ * AI_API_Latency_Stats - Running latency estimates of one target
+ *
+ * For each metric keeps an EWMA plus streaming p50/p90 estimates. The
+ * quantiles move a small step (proportional to the EWMA) towards each new
+ * sample, so they need no sample history: 16 bytes per metric.
+ */
+class AI_API_Latency_Stats {
+public:
+    enum Metric : uint8_t {
+        TTFB = 0,   // Request sent until response headers received
+        TTFT = 1,   // Request sent until the first streamed content (streamChat only)
+        TOTAL = 2,  // Request sent until the full response is read
+        METRIC_COUNT = 3
+    };
+
+    void addSample(Metric metric, uint32_t ms);
+    void reset();
+
+    // Estimates in milliseconds (0 without samples)
+    float getEwma(Metric metric) const { return _metrics[metric].ewma; }
+    float getP50(Metric metric) const { return _metrics[metric].p50; }
+    float getP90(Metric metric) const { return _metrics[metric].p90; }
+    uint32_t getSampleCount(Metric metric) const { return _metrics[metric].samples; }
+
+private:
+    struct Estimate {
+        float ewma = 0;
+        float p50 = 0;
+        float p90 = 0;
+        uint32_t samples = 0;
+    };
+    Estimate _metrics[METRIC_COUNT];
+};
+
+#endif // ENABLE_LATENCY_ROUTING
+#endif // AI_API_LATENCY_STATS_H
@@ -0,0 +1,37 @@
+// ESP32_AI_Connect/AI_API_Lazy_Mutex.h
+
+#ifndef AI_API_LAZY_MUTEX_H
+#define AI_API_LAZY_MUTEX_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+
+#ifdef ENABLE_LAZY_ALLOCATION // Only compile this file's content if flag is set
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+/**
+ * AI_API_Lazy_Mutex - Mutexes created the first time they are taken
+ *
+ * get() returns 'mutex', creating it first if it is still nullptr. A
+ * compare-and-swap keeps this safe when several tasks get there at once;
+ * the losers delete the mutex they created. Returns nullptr if FreeRTOS
+ * is out of heap.
+ */
+struct AI_API_Lazy_Mutex {
+    static SemaphoreHandle_t get(SemaphoreHandle_t& mutex) {
+        SemaphoreHandle_t current = __atomic_load_n(&mutex, __ATOMIC_ACQUIRE);
+        if (current != nullptr) return current;
+        SemaphoreHandle_t created = xSemaphoreCreateMutex();
+        if (created == nullptr) return nullptr;
+        if (!__atomic_compare_exchange_n(&mutex, &current, created, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            vSemaphoreDelete(created); // Another task created it first
+            return current;
+        }
+        return created;
+    }
+};
+
+#endif // ENABLE_LAZY_ALLOCATION
+#endif // AI_API_LAZY_MUTEX_H
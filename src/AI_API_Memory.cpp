@@ -0,0 +1,59 @@
+// ESP32_AI_Connect/AI_API_Memory.cpp
+
+#include "AI_API_Memory.h"
+
+#include <esp_heap_caps.h>
+
+#ifdef ENABLE_PSRAM
+// Heap a buffer of 'size' bytes belongs in
+static uint32_t memoryCaps(size_t size) {
+    if (size >= AI_API_PSRAM_MIN_ALLOC && AI_API_Memory::usesPsram()) return MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+    return MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+}
+#endif
+
+bool AI_API_Memory::usesPsram() {
+#ifdef ENABLE_PSRAM
+    static const bool found = psramFound();
+    return found;
+#else
+    return false;
+#endif
+}
+
+void* AI_API_Memory::allocate(size_t size) {
+#ifdef ENABLE_PSRAM
+    void* ptr = heap_caps_malloc(size, memoryCaps(size));
+    return ptr != nullptr ? ptr : malloc(size); // Preferred heap full: take any
+#else
+    return malloc(size);
+#endif
+}
+
+void* AI_API_Memory::reallocate(void* ptr, size_t size) {
+#ifdef ENABLE_PSRAM
+    if (ptr == nullptr) return allocate(size);
+    void* moved = heap_caps_realloc(ptr, size, memoryCaps(size));
+    return moved != nullptr ? moved : realloc(ptr, size);
+#else
+    return realloc(ptr, size);
+#endif
+}
+
+void AI_API_Memory::deallocate(void* ptr) {
+    free(ptr); // Frees from either heap
+}
+
+void AI_API_Memory_Usage::begin() {
+    _internalFree = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    _psramFree = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    internalBytes = 0;
+    psramBytes = 0;
+}
+
+void AI_API_Memory_Usage::sample() {
+    uint32_t internalFree = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    uint32_t psramFree = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    if (internalFree < _internalFree) internalBytes = max(internalBytes, _internalFree - internalFree);
+    if (psramFree < _psramFree) psramBytes = max(psramBytes, _psramFree - psramFree);
+}
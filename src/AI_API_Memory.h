@@ -0,0 +1,69 @@
+// ESP32_AI_Connect/AI_API_Memory.h
+
+#ifndef AI_API_MEMORY_H
+#define AI_API_MEMORY_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * AI_API_Memory - Where the library's large buffers live
+ *
+ * With ENABLE_PSRAM, buffers of AI_API_PSRAM_MIN_ALLOC bytes or more go to
+ * PSRAM when the board has it: JSON document pools, response cache texts,
+ * chat history arenas and the inflate window. Smaller, short-lived buffers
+ * stay in the faster internal RAM. If the preferred heap is full the other
+ * one is used. Without ENABLE_PSRAM (or PSRAM) this is malloc().
+ */
+class AI_API_Memory {
+public:
+    static void* allocate(size_t size);
+    static void* reallocate(void* ptr, size_t size);
+    static void deallocate(void* ptr);
+    // True if large buffers are placed in PSRAM
+    static bool usesPsram();
+};
+
+// ArduinoJson allocator backed by AI_API_Memory; one instance serves every document
+class AI_API_Json_Allocator : public ArduinoJson::Allocator {
+public:
+    void* allocate(size_t size) override { return AI_API_Memory::allocate(size); }
+    void deallocate(void* ptr) override { AI_API_Memory::deallocate(ptr); }
+    void* reallocate(void* ptr, size_t size) override { return AI_API_Memory::reallocate(ptr, size); }
+
+    static AI_API_Json_Allocator* instance() {
+        static AI_API_Json_Allocator allocator;
+        return &allocator;
+    }
+};
+
+// JsonDocument whose memory pools follow the AI_API_Memory placement; like any
+// ArduinoJson 7 document it grows as needed, so it takes no capacity
+class AI_API_Json_Document : public JsonDocument {
+public:
+    AI_API_Json_Document() : JsonDocument(AI_API_Json_Allocator::instance()) {}
+};
+
+/**
+ * AI_API_Memory_Usage - Heap a request took, in internal RAM and in PSRAM
+ *
+ * begin() notes the free heap when the request starts and sample() the
+ * lowest it got to since; sampled after the request is sent (TLS session
+ * included) and after the response was read. Allocations made meanwhile by
+ * other tasks are counted too.
+ */
+struct AI_API_Memory_Usage {
+    uint32_t internalBytes = 0;
+    uint32_t psramBytes = 0;
+
+    void begin();
+    void sample();
+
+private:
+    uint32_t _internalFree = 0;
+    uint32_t _psramFree = 0;
+};
+
+#endif // AI_API_MEMORY_H
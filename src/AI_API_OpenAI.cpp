@@ -21,10 +21,15 @@ void AI_API_OpenAI_Handler::setHeaders(HTTPClient& httpClient, const String& api
 String AI_API_OpenAI_Handler::buildRequestBody(const String& modelName, const String& systemRole,
                                               float temperature, int maxTokens,
                                               const String& userMessage, JsonDocument& doc,
-                                              const String& customParams) {
+                                              const String& customParams,
+                                              const AI_API_Chat_Session* history) {
     doc.clear();
 
     doc["model"] = modelName;
+    // Prefix caching is automatic; the key keeps requests sharing a prefix on the same cache
+    if (_promptCaching && _promptCacheKey.length() > 0) {
+        doc["prompt_cache_key"] = _promptCacheKey;
+    }
     
     JsonArray messages = doc.createNestedArray("messages");
     if (systemRole.length() > 0) {
@@ -32,6 +37,7 @@ String AI_API_OpenAI_Handler::buildRequestBody(const String& modelName, const St
         systemMsg["role"] = "system";
         systemMsg["content"] = systemRole;
     }
+    addHistoryTurns(messages, history); // Previous turns of a chat session
     JsonObject userMsg = messages.createNestedObject();
     userMsg["role"] = "user";
     userMsg["content"] = userMessage;
@@ -39,7 +45,7 @@ String AI_API_OpenAI_Handler::buildRequestBody(const String& modelName, const St
     // Process custom parameters if provided
     if (customParams.length() > 0) {
         // Create a temporary document to parse the custom parameters
-        DynamicJsonDocument paramsDoc(512);
+        AI_API_Json_Document paramsDoc;
         DeserializationError error = deserializeJson(paramsDoc, customParams);
         
         // Only proceed if parsing was successful
@@ -90,6 +96,8 @@ String AI_API_OpenAI_Handler::parseResponseBody(const String& responsePayload,
         if (usage.containsKey("total_tokens")) {
             _lastTotalTokens = usage["total_tokens"].as<int>(); // Store in base class member
         }
+        _lastPromptTokens = usage["prompt_tokens"] | 0;
+        _lastCacheReadTokens = usage["prompt_tokens_details"]["cached_tokens"] | 0;
     }
 
     if (doc.containsKey("choices") && doc["choices"].is<JsonArray>() && !doc["choices"].isNull() && doc["choices"].size() > 0) {
@@ -116,11 +124,16 @@ String AI_API_OpenAI_Handler::parseResponseBody(const String& responsePayload,
 String AI_API_OpenAI_Handler::buildStreamRequestBody(const String& modelName, const String& systemRole,
                                                     float temperature, int maxTokens,
                                                     const String& userMessage, JsonDocument& doc,
-                                                    const String& customParams) {
+                                                    const String& customParams,
+                                                    const AI_API_Chat_Session* history) {
     // Use the same logic as buildRequestBody but add "stream": true
     doc.clear();
 
     doc["model"] = modelName;
+    // Prefix caching is automatic; the key keeps requests sharing a prefix on the same cache
+    if (_promptCaching && _promptCacheKey.length() > 0) {
+        doc["prompt_cache_key"] = _promptCacheKey;
+    }
     doc["stream"] = true; // Enable streaming
     
     JsonArray messages = doc.createNestedArray("messages");
@@ -129,6 +142,7 @@ String AI_API_OpenAI_Handler::buildStreamRequestBody(const String& modelName, co
         systemMsg["role"] = "system";
         systemMsg["content"] = systemRole;
     }
+    addHistoryTurns(messages, history); // Previous turns of a chat session
     JsonObject userMsg = messages.createNestedObject();
     userMsg["role"] = "user";
     userMsg["content"] = userMessage;
@@ -136,7 +150,7 @@ String AI_API_OpenAI_Handler::buildStreamRequestBody(const String& modelName, co
     // Process custom parameters if provided
     if (customParams.length() > 0) {
         // Create a temporary document to parse the custom parameters
-        DynamicJsonDocument paramsDoc(512);
+        AI_API_Json_Document paramsDoc;
         DeserializationError error = deserializeJson(paramsDoc, customParams);
         
         // Only proceed if parsing was successful
@@ -198,7 +212,7 @@ String AI_API_OpenAI_Handler::processStreamChunk(const String& rawChunk, bool& i
     }
 
     // Parse the JSON chunk
-    DynamicJsonDocument chunkDoc(512);
+    AI_API_Json_Document chunkDoc;
     DeserializationError error = deserializeJson(chunkDoc, jsonPart);
     if (error) {
         errorMsg = "Failed to parse streaming chunk JSON: " + String(error.c_str());
@@ -248,6 +262,10 @@ String AI_API_OpenAI_Handler::buildToolCallsRequestBody(const String& modelName,
 
     // Set the model
     doc["model"] = modelName;
+    // Prefix caching is automatic; the key keeps requests sharing a prefix on the same cache
+    if (_promptCaching && _promptCacheKey.length() > 0) {
+        doc["prompt_cache_key"] = _promptCacheKey;
+    }
     
     // Add max_completion_tokens parameter if specified
     if (maxTokens > 0) {
@@ -282,7 +300,7 @@ String AI_API_OpenAI_Handler::buildToolCallsRequestBody(const String& modelName,
         // Check if it starts with { - might be a JSON object string
         else if (trimmedChoice.startsWith("{")) {
             // Try to parse it as a JSON object
-            DynamicJsonDocument toolChoiceDoc(512);
+            AI_API_Json_Document toolChoiceDoc;
             DeserializationError error = deserializeJson(toolChoiceDoc, trimmedChoice);
             
             if (!error) {
@@ -321,6 +339,11 @@ String AI_API_OpenAI_Handler::buildToolCallsRequestBody(const String& modelName,
     // Add tools array
     JsonArray tools = doc.createNestedArray("tools");
     
+    // Add pre-rendered tools (see AI_API_Tool_Schema.h) verbatim - no parsing needed
+    for (int i = 0; i < _prebuiltToolsSize; i++) {
+        tools.add(serialized(_prebuiltTools[i].openai));
+    }
+    
     // Parse and add each tool from the toolsArray
     for (int i = 0; i < toolsArraySize; i++) {
         // Create a temporary JsonDocument to parse the tool JSON string
@@ -436,6 +459,8 @@ String AI_API_OpenAI_Handler::parseToolCallsResponseBody(const String& responseP
         if (usage.containsKey("total_tokens")) {
             _lastTotalTokens = usage["total_tokens"].as<int>(); // Store in base class member
         }
+        _lastPromptTokens = usage["prompt_tokens"] | 0;
+        _lastCacheReadTokens = usage["prompt_tokens_details"]["cached_tokens"] | 0;
     }
 
     if (doc.containsKey("choices") && doc["choices"].is<JsonArray>() && !doc["choices"].isNull() && doc["choices"].size() > 0) {
@@ -468,6 +493,26 @@ String AI_API_OpenAI_Handler::parseToolCallsResponseBody(const String& responseP
     return ""; // Return empty string if content not found
 }
 
+int AI_API_OpenAI_Handler::getToolCallCount(const JsonDocument& doc) const {
+    return doc["choices"][0]["message"]["tool_calls"].size();
+}
+
+bool AI_API_OpenAI_Handler::getToolCall(const JsonDocument& doc, int index, AI_API_Tool_Call& call,
+                                        JsonDocument& argsDoc) const {
+    if (index < 0) return false;
+    JsonVariantConst toolCall = doc["choices"][0]["message"]["tool_calls"][index];
+    if (toolCall.isNull()) return false;
+
+    call.id = toolCall["id"] | "";
+    call.name = toolCall["function"]["name"] | "";
+
+    // OpenAI sends arguments as a JSON encoded string - parse it once, straight from the response
+    argsDoc.clear();
+    if (deserializeJson(argsDoc, toolCall["function"]["arguments"] | "{}")) return false;
+    call.args = argsDoc.as<JsonObjectConst>();
+    return !call.args.isNull();
+}
+
 String AI_API_OpenAI_Handler::buildToolCallsFollowUpRequestBody(const String& modelName,
                                                           const String* toolsArray, int toolsArraySize,
                                                           const String& systemMessage, const String& toolChoice,
@@ -482,6 +527,10 @@ String AI_API_OpenAI_Handler::buildToolCallsFollowUpRequestBody(const String& mo
 
     // Set the model
     doc["model"] = modelName;
+    // Prefix caching is automatic; the key keeps requests sharing a prefix on the same cache
+    if (_promptCaching && _promptCacheKey.length() > 0) {
+        doc["prompt_cache_key"] = _promptCacheKey;
+    }
     
     // Add max_completion_tokens parameter if specified
     if (followUpMaxTokens > 0) {
@@ -508,7 +557,7 @@ String AI_API_OpenAI_Handler::buildToolCallsFollowUpRequestBody(const String& mo
     assistantMsg["role"] = "assistant";
     
     // Parse and add the tool calls
-    DynamicJsonDocument toolCallsDoc(1024);
+    AI_API_Json_Document toolCallsDoc;
     DeserializationError error = deserializeJson(toolCallsDoc, lastAssistantToolCallsJson);
     if (!error && toolCallsDoc.is<JsonArray>()) {
         JsonArray toolCalls = assistantMsg.createNestedArray("tool_calls");
@@ -534,7 +583,7 @@ String AI_API_OpenAI_Handler::buildToolCallsFollowUpRequestBody(const String& mo
     }
     
     // Parse and add tool results as tool messages
-    DynamicJsonDocument toolResultsDoc(1024);
+    AI_API_Json_Document toolResultsDoc;
     error = deserializeJson(toolResultsDoc, toolResultsJson);
     if (!error && toolResultsDoc.is<JsonArray>()) {
         for (JsonVariant result : toolResultsDoc.as<JsonArray>()) {
@@ -569,7 +618,7 @@ String AI_API_OpenAI_Handler::buildToolCallsFollowUpRequestBody(const String& mo
         // Check if it starts with { - might be a JSON object string
         else if (trimmedChoice.startsWith("{")) {
             // Try to parse it as a JSON object
-            DynamicJsonDocument toolChoiceDoc(512);
+            AI_API_Json_Document toolChoiceDoc;
             DeserializationError error = deserializeJson(toolChoiceDoc, trimmedChoice);
             
             if (!error) {
@@ -608,6 +657,11 @@ String AI_API_OpenAI_Handler::buildToolCallsFollowUpRequestBody(const String& mo
     // Add tools array
     JsonArray tools = doc.createNestedArray("tools");
     
+    // Add pre-rendered tools (see AI_API_Tool_Schema.h) verbatim - no parsing needed
+    for (int i = 0; i < _prebuiltToolsSize; i++) {
+        tools.add(serialized(_prebuiltTools[i].openai));
+    }
+    
     // Parse and add each tool from the toolsArray (same logic as buildToolCallsRequestBody)
     for (int i = 0; i < toolsArraySize; i++) {
         // Create a temporary JsonDocument to parse the tool JSON string
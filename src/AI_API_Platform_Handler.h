@@ -9,19 +9,80 @@
 
 // Include configuration to get access to ENABLE_TOOL_CALLS and ENABLE_STREAM_CHAT flags
 #include "ESP32_AI_Connect_config.h"
+#include "AI_API_Chat_Session.h"
+#include "AI_API_Memory.h"
 
-// Forward declaration
+// Forward declarations
 class ESP32_AI_Connect;
+class AI_API_Chat_Session;
+
+#ifdef ENABLE_TOOL_CALLS
+// Tool definition with its schema already rendered for every platform.
+// Normally produced at compile time by AI_API_Tool_Schema.h; all strings
+// must stay valid for as long as the tools are registered.
+struct AI_API_Tool_Def {
+    const char* name;
+    const char* description;
+    const char* openai; // {"type":"function","function":{...}} (also used by DeepSeek)
+    const char* claude; // {"name":...,"input_schema":{...}}
+    const char* gemini; // functionDeclarations entry
+    const char* signature; // name(arg:T!,...) used to validate arguments (see AI_API_Tool_Args.h)
+};
+
+// Borrowed view of one tool call from the last tool calls response.
+// Strings and args point into library-owned documents and stay valid until the next request.
+struct AI_API_Tool_Call {
+    const char* id;       // Tool call id ("" if the platform does not send one)
+    const char* name;     // Function name
+    JsonObjectConst args; // Decoded arguments
+};
+#endif
 
 class AI_API_Platform_Handler {
 protected:
     String _lastFinishReason = ""; // Store the finish reason from the last response
     int _lastTotalTokens = 0;    // Store token count from the last response
+    int _lastPromptTokens = 0;   // Store prompt (input) token count from the last response
+    int _lastCacheReadTokens = 0;  // Prompt tokens served from the provider's prompt cache
+    int _lastCacheWriteTokens = 0; // Prompt tokens written to the provider's prompt cache
+    bool _promptCaching = false;   // Mark stable prompt prefixes as cacheable
+    String _promptCacheKey = "";   // Routing key for providers that support one (OpenAI)
+#ifdef ENABLE_TOOL_CALLS
+    const AI_API_Tool_Def* _prebuiltTools = nullptr; // Pre-rendered tools added after toolsArray
+    int _prebuiltToolsSize = 0;
+#endif
 
     // Helper to reset state before parsing a new response
     virtual void resetState() {
         _lastFinishReason = "";
         _lastTotalTokens = 0;
+        _lastPromptTokens = 0;
+        _lastCacheReadTokens = 0;
+        _lastCacheWriteTokens = 0;
+    }
+
+    // Append the turns of a chat session (oldest first) before the current user message.
+    // Default format is {"role":"user"|"assistant","content":...} (OpenAI, DeepSeek, Claude);
+    // geminiFormat emits {"role":"user"|"model","parts":[{"text":...}]} instead.
+    void addHistoryTurns(JsonArray messages, const AI_API_Chat_Session* history, bool geminiFormat = false) {
+#ifdef ENABLE_CHAT_SESSION
+        if (history == nullptr) return;
+        AI_API_Chat_Session::Cursor cursor = history->begin();
+        AI_API_Chat_Session::Turn turn;
+        while (history->nextTurn(cursor, turn)) {
+            bool isUser = (turn.role == AI_API_Chat_Session::ROLE_USER);
+            JsonObject message = messages.createNestedObject();
+            if (geminiFormat) {
+                message["role"] = isUser ? "user" : "model";
+                JsonArray parts = message.createNestedArray("parts");
+                JsonObject textPart = parts.createNestedObject();
+                textPart["text"] = turn.text;
+            } else {
+                message["role"] = isUser ? "user" : "assistant";
+                message["content"] = turn.text;
+            }
+        }
+#endif
     }
 
     // Allow derived classes access to the main class's members if needed
@@ -32,6 +93,9 @@ public:
     // Virtual destructor is crucial for polymorphism with pointers
     virtual ~AI_API_Platform_Handler() {}
 
+    // Clear results of the last response (used when a cached handler is reused)
+    void reset() { resetState(); }
+
     // --- Required Methods for All Platforms ---
 
     // Get the specific API endpoint URL
@@ -46,7 +110,8 @@ public:
     virtual String buildRequestBody(const String& modelName, const String& systemRole,
                                     float temperature, int maxTokens,
                                     const String& userMessage, JsonDocument& doc,
-                                    const String& customParams = "") = 0;
+                                    const String& customParams = "",
+                                    const AI_API_Chat_Session* history = nullptr) = 0;
 
     // Parse the JSON response payload
     // Takes raw response, reference to error string, and JsonDocument reference
@@ -58,11 +123,31 @@ public:
     // Get the total tokens from the last response
     virtual int getTotalTokens() const { return _lastTotalTokens; };
 
+    // Get the prompt (input) tokens from the last response, 0 if not reported
+    virtual int getPromptTokens() const { return _lastPromptTokens; };
+
     // Get the finish reason from the last response
     virtual String getFinishReason() const { return _lastFinishReason; };
 
+    // Prompt caching: when enabled, handlers mark the system prompt, tools and chat
+    // history as a cacheable prefix in the platform's format. cacheKey is optional.
+    void setPromptCaching(bool enable, const String& cacheKey = "") {
+        _promptCaching = enable;
+        _promptCacheKey = cacheKey;
+    }
+
+    // Get the prompt tokens read from / written to the prompt cache by the last request
+    virtual int getCacheReadTokens() const { return _lastCacheReadTokens; };
+    virtual int getCacheWriteTokens() const { return _lastCacheWriteTokens; };
+
 #ifdef ENABLE_TOOL_CALLS
     // --- Tool Calls Methods ---
+
+    // Set pre-rendered tools to emit verbatim in tool calls requests (nullptr/0 to clear)
+    void setPrebuiltTools(const AI_API_Tool_Def* tools, int toolsSize) {
+        _prebuiltTools = tools;
+        _prebuiltToolsSize = (tools != nullptr) ? toolsSize : 0;
+    }
     
     // Build the JSON request body for tool calls
     // Takes user message, tools array, system message, tool choice, and a JsonDocument reference to populate
@@ -79,6 +164,15 @@ public:
     // Sets the errorMsg reference if parsing fails or API returns an error object
     virtual String parseToolCallsResponseBody(const String& responsePayload,
                                         String& errorMsg, JsonDocument& doc) { return ""; }
+
+    // Number of tool calls in a response parsed by parseToolCallsResponseBody into 'doc'
+    virtual int getToolCallCount(const JsonDocument& doc) const { return 0; }
+
+    // Fill 'call' with tool call 'index' from 'doc' without re-serializing it
+    // Arguments sent as a JSON string are parsed into 'argsDoc'; others are borrowed from 'doc'
+    // Returns false if there is no such tool call or its arguments are not a JSON object
+    virtual bool getToolCall(const JsonDocument& doc, int index, AI_API_Tool_Call& call,
+                             JsonDocument& argsDoc) const { return false; }
                                         
     // Build a follow-up request body with tool results
     // Returns the serialized JSON string or empty string on error
@@ -108,7 +202,8 @@ public:
     virtual String buildStreamRequestBody(const String& modelName, const String& systemRole,
                                         float temperature, int maxTokens,
                                         const String& userMessage, JsonDocument& doc,
-                                        const String& customParams = "") { return ""; }
+                                        const String& customParams = "",
+                                        const AI_API_Chat_Session* history = nullptr) { return ""; }
 
     // Process a single stream chunk and extract content
     // Takes raw chunk data from HTTP stream
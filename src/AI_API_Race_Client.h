@@ -0,0 +1,54 @@
+// ESP32_AI_Connect/AI_API_Race_Client.h
+
+#ifndef AI_API_RACE_CLIENT_H
+#define AI_API_RACE_CLIENT_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+
+#if defined(ENABLE_HEDGING) || defined(ENABLE_CANCELLATION) // Only compile if either flag is set
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include "AI_API_Cancel_Token.h"
+
+/**
+ * AI_API_Race_Client - Connection another task can make a request give up on
+ *
+ * Once its lost flag is set (the other side of a hedged request won the
+ * race) or its cancel token is cancelled, the client reports itself
+ * disconnected with nothing to read. HTTPClient
+ * polls both while waiting for a response, so it gives up within one poll.
+ * The task using the client then closes it. No other task touches its
+ * socket, so a connection closed and reused meanwhile cannot be hit.
+ *
+ * The TCP connect and TLS handshake are not interrupted; they end within
+ * their own budgets.
+ */
+class AI_API_Race_Client : public WiFiClientSecure {
+public:
+    // Give up once *lost is true (nullptr: never)
+    void setLostFlag(const volatile bool* lost) { _lost = lost; }
+#ifdef ENABLE_CANCELLATION
+    // Give up once 'token' is cancelled (nullptr: never)
+    void setCancelToken(const AI_API_Cancel_Token* token) { _cancelToken = token; }
+#endif
+
+    bool isAborted() const {
+#ifdef ENABLE_CANCELLATION
+        if (_cancelToken != nullptr && _cancelToken->isCancelled()) return true;
+#endif
+        return _lost != nullptr && *_lost;
+    }
+
+    uint8_t connected() override { return isAborted() ? 0 : WiFiClientSecure::connected(); }
+    int available() override { return isAborted() ? 0 : WiFiClientSecure::available(); }
+
+private:
+    const volatile bool* _lost = nullptr;
+#ifdef ENABLE_CANCELLATION
+    const AI_API_Cancel_Token* _cancelToken = nullptr;
+#endif
+};
+
+#endif // ENABLE_HEDGING || ENABLE_CANCELLATION
+#endif // AI_API_RACE_CLIENT_H
@@ -0,0 +1,250 @@
+// ESP32_AI_Connect/AI_API_Rate_Limiter.cpp
+
+#include "AI_API_Rate_Limiter.h"
+
+#ifdef ENABLE_RATE_LIMITER // Only compile if flag is set
+
+#include <time.h>
+
+// Any earlier system time means the clock has not been set
+#define AI_API_RATE_LIMIT_MIN_EPOCH 1609459200UL // 2021-01-01
+
+static const char* rateLimitHeaderKeys[] = {
+    "retry-after",
+    "x-ratelimit-limit-requests", "x-ratelimit-remaining-requests", "x-ratelimit-reset-requests",
+    "x-ratelimit-limit-tokens", "x-ratelimit-remaining-tokens", "x-ratelimit-reset-tokens",
+    "anthropic-ratelimit-requests-limit", "anthropic-ratelimit-requests-remaining", "anthropic-ratelimit-requests-reset",
+    "anthropic-ratelimit-tokens-limit", "anthropic-ratelimit-tokens-remaining", "anthropic-ratelimit-tokens-reset",
+    "retry-after-ms"
+};
+
+// Milliseconds until an RFC 3339 UTC time ("2025-01-01T12:00:30Z"), 0 if past or the clock is not set
+static uint32_t msUntilTimestamp(const String& value) {
+    int year, month, day, hour, minute, second;
+    if (sscanf(value.c_str(), "%d-%d-%dT%d:%d:%d", &year, &month, &day, &hour, &minute, &second) != 6) return 0;
+    time_t now = time(nullptr);
+    if (now < (time_t)AI_API_RATE_LIMIT_MIN_EPOCH) return 0;
+
+    // Days since 1970-01-01 (civil calendar)
+    year -= month <= 2;
+    long era = (year >= 0 ? year : year - 399) / 400;
+    long yearOfEra = year - era * 400;
+    long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    long days = era * 146097 + dayOfEra - 719468;
+
+    int64_t at = (int64_t)days * 86400 + hour * 3600 + minute * 60 + second;
+    return at > (int64_t)now ? (uint32_t)((at - now) * 1000) : 0;
+}
+
+AI_API_Rate_Limiter::AI_API_Rate_Limiter(uint32_t requestsPerMinute, uint32_t tokensPerMinute) {
+    _mutex = xSemaphoreCreateMutex();
+    if (_mutex == nullptr) {
+        Serial.println("ERROR: Failed to create rate limiter mutex");
+    }
+    setLimits(requestsPerMinute, tokensPerMinute);
+}
+
+AI_API_Rate_Limiter::~AI_API_Rate_Limiter() {
+    if (_mutex != nullptr) vSemaphoreDelete(_mutex);
+}
+
+void AI_API_Rate_Limiter::setLimits(uint32_t requestsPerMinute, uint32_t tokensPerMinute) {
+    if (_mutex) xSemaphoreTake(_mutex, portMAX_DELAY);
+    _setCapacity(_requests, requestsPerMinute);
+    _setCapacity(_tokens, tokensPerMinute);
+    if (_mutex) xSemaphoreGive(_mutex);
+}
+
+const char** AI_API_Rate_Limiter::getHeaderKeys() {
+    return rateLimitHeaderKeys;
+}
+
+size_t AI_API_Rate_Limiter::getHeaderKeyCount() {
+    return sizeof(rateLimitHeaderKeys) / sizeof(rateLimitHeaderKeys[0]);
+}
+
+void AI_API_Rate_Limiter::_setCapacity(Bucket& bucket, uint32_t capacity) {
+    if (capacity == bucket.capacity) return;
+    if (bucket.capacity == 0) {
+        bucket.level = capacity; // Newly limited: start full
+    } else if (bucket.level > capacity) {
+        bucket.level = capacity;
+    }
+    bucket.capacity = capacity;
+    bucket.refilledAt = millis();
+}
+
+void AI_API_Rate_Limiter::_refill(Bucket& bucket, uint32_t now) {
+    if (bucket.capacity == 0) return;
+    bucket.level += (now - bucket.refilledAt) * (bucket.capacity / 60000.0f);
+    if (bucket.level > bucket.capacity) bucket.level = bucket.capacity;
+    bucket.refilledAt = now;
+}
+
+uint32_t AI_API_Rate_Limiter::_waitFor(const Bucket& bucket, float amount) {
+    if (bucket.capacity == 0 || bucket.level >= amount) return 0;
+    return (uint32_t)((amount - bucket.level) * 60000.0f / bucket.capacity) + 1;
+}
+
+void AI_API_Rate_Limiter::_blockFor(uint32_t ms) {
+    if (ms == 0) return;
+    uint32_t until = millis() + ms;
+    if (!_blocked || (int32_t)(until - _blockedUntil) > 0) _blockedUntil = until;
+    _blocked = true;
+}
+
+bool AI_API_Rate_Limiter::acquire(int tokens, uint32_t maxWaitMs, uint32_t& waitMs) {
+    uint32_t start = millis();
+    bool waited = false;
+
+    while (true) {
+        if (_mutex) xSemaphoreTake(_mutex, portMAX_DELAY);
+        uint32_t now = millis();
+        _refill(_requests, now);
+        _refill(_tokens, now);
+
+        uint32_t wait = 0;
+        if (_blocked) {
+            if ((int32_t)(_blockedUntil - now) > 0) {
+                wait = _blockedUntil - now;
+            } else {
+                _blocked = false;
+            }
+        }
+        // A request larger than the whole bucket waits for a full bucket
+        float cost = (_tokens.capacity && tokens > (int)_tokens.capacity) ? _tokens.capacity : max(tokens, 0);
+        wait = max(wait, max(_waitFor(_requests, 1), _waitFor(_tokens, cost)));
+
+        if (wait == 0) {
+            if (_requests.capacity) _requests.level -= 1;
+            if (_tokens.capacity) _tokens.level -= cost;
+            if (waited) _throttled++;
+            if (_mutex) xSemaphoreGive(_mutex);
+            waitMs = 0;
+            return true;
+        }
+        if ((now - start) + wait > maxWaitMs) {
+            _rejected++;
+            if (_mutex) xSemaphoreGive(_mutex);
+            waitMs = wait;
+            return false;
+        }
+        if (_mutex) xSemaphoreGive(_mutex);
+
+        #ifdef ENABLE_DEBUG_OUTPUT
+        Serial.println("Rate limiter: waiting " + String(wait) + " ms");
+        #endif
+        waited = true;
+        delay(wait);
+    }
+}
+
+void AI_API_Rate_Limiter::settle(int reservedTokens, int usedTokens) {
+    if (usedTokens <= 0) return; // Usage unknown: keep the reservation
+    if (_mutex) xSemaphoreTake(_mutex, portMAX_DELAY);
+    if (_tokens.capacity) {
+        _tokens.level += reservedTokens - usedTokens;
+        // Underestimates may overdraw the bucket, but by no more than one minute's budget
+        if (_tokens.level > _tokens.capacity) _tokens.level = _tokens.capacity;
+        if (_tokens.level < -(float)_tokens.capacity) _tokens.level = -(float)_tokens.capacity;
+    }
+    if (_mutex) xSemaphoreGive(_mutex);
+}
+
+void AI_API_Rate_Limiter::update(HTTPClient& http, int httpCode) {
+    if (httpCode <= 0) return; // No response headers
+    if (_mutex) xSemaphoreTake(_mutex, portMAX_DELAY);
+
+    // OpenAI (resets are durations) and Anthropic (resets are timestamps), requests then tokens
+    Bucket* buckets[2] = { &_requests, &_tokens };
+    for (int b = 0; b < 2; b++) {
+        for (int provider = 0; provider < 2; provider++) {
+            int key = 1 + provider * 6 + b * 3;
+            String limit = http.header(rateLimitHeaderKeys[key]);
+            String remaining = http.header(rateLimitHeaderKeys[key + 1]);
+            if (limit.isEmpty() && remaining.isEmpty()) continue;
+
+            if (!limit.isEmpty()) _setCapacity(*buckets[b], (uint32_t)limit.toInt());
+            if (!remaining.isEmpty() && buckets[b]->capacity) {
+                float left = remaining.toFloat();
+                _refill(*buckets[b], millis());
+                if (buckets[b]->level > left) buckets[b]->level = left; // The provider knows best
+                if (left < 1) {
+                    String reset = http.header(rateLimitHeaderKeys[key + 2]);
+                    _blockFor(provider == 0 ? _parseDuration(reset) : msUntilTimestamp(reset));
+                }
+            }
+        }
+    }
+
+    String retryAfterMs = http.header(rateLimitHeaderKeys[13]);
+    String retryAfter = http.header(rateLimitHeaderKeys[0]);
+    if (!retryAfterMs.isEmpty()) {
+        _blockFor((uint32_t)retryAfterMs.toInt());
+    } else if (!retryAfter.isEmpty()) {
+        _blockFor((uint32_t)(retryAfter.toFloat() * 1000)); // HTTP-date values are ignored
+    } else if (httpCode == 429) {
+        _blockFor(AI_API_RATE_LIMIT_429_BACKOFF_MS); // Rate limited without a hint
+    }
+
+    #ifdef ENABLE_DEBUG_OUTPUT
+    if (_blocked) {
+        Serial.println("Rate limiter: blocked for " + String(getBlockedMs()) + " ms");
+    }
+    #endif
+    if (_mutex) xSemaphoreGive(_mutex);
+}
+
+uint32_t AI_API_Rate_Limiter::_parseDuration(const String& value) {
+    float total = 0;
+    float number = 0;
+    float scale = 0; // > 0 while reading decimals
+    for (size_t i = 0; i < value.length(); i++) {
+        char c = value[i];
+        if (c >= '0' && c <= '9') {
+            if (scale > 0) {
+                number += (c - '0') * scale;
+                scale /= 10;
+            } else {
+                number = number * 10 + (c - '0');
+            }
+        } else if (c == '.') {
+            scale = 0.1f;
+        } else {
+            if (c == 'h') total += number * 3600000.0f;
+            else if (c == 'm' && i + 1 < value.length() && value[i + 1] == 's') { total += number; i++; }
+            else if (c == 'm') total += number * 60000.0f;
+            else if (c == 's') total += number * 1000.0f;
+            number = 0;
+            scale = 0;
+        }
+    }
+    return (uint32_t)total;
+}
+
+uint32_t AI_API_Rate_Limiter::getRequestsAvailable() {
+    if (_requests.capacity == 0) return UINT32_MAX;
+    if (_mutex) xSemaphoreTake(_mutex, portMAX_DELAY);
+    _refill(_requests, millis());
+    uint32_t available = _requests.level > 0 ? (uint32_t)_requests.level : 0;
+    if (_mutex) xSemaphoreGive(_mutex);
+    return available;
+}
+
+uint32_t AI_API_Rate_Limiter::getTokensAvailable() {
+    if (_tokens.capacity == 0) return UINT32_MAX;
+    if (_mutex) xSemaphoreTake(_mutex, portMAX_DELAY);
+    _refill(_tokens, millis());
+    uint32_t available = _tokens.level > 0 ? (uint32_t)_tokens.level : 0;
+    if (_mutex) xSemaphoreGive(_mutex);
+    return available;
+}
+
+uint32_t AI_API_Rate_Limiter::getBlockedMs() const {
+    if (!_blocked) return 0;
+    int32_t left = (int32_t)(_blockedUntil - millis());
+    return left > 0 ? (uint32_t)left : 0;
+}
+
+#endif // ENABLE_RATE_LIMITER
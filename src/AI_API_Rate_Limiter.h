@@ -0,0 +1,89 @@
+// ESP32_AI_Connect/AI_API_Rate_Limiter.h
+
+#ifndef AI_API_RATE_LIMITER_H
+#define AI_API_RATE_LIMITER_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+
+#ifdef ENABLE_RATE_LIMITER // Only compile this file's content if flag is set
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+/**
+ * AI_API_Rate_Limiter - Client-side token buckets for requests and tokens per minute
+ *
+ * Requests wait (or are refused) locally when the provider would answer
+ * with HTTP 429, saving the TLS round trip. Limits can be set up front and
+ * are learned from the provider's rate-limit response headers:
+ *   OpenAI:    x-ratelimit-limit/remaining/reset-requests|tokens
+ *   Anthropic: anthropic-ratelimit-requests|tokens-limit/remaining/reset
+ *   Any:       retry-after (seconds), retry-after-ms
+ *
+ * Usage (one limiter per API key; clients using the same key may share it):
+ *   AI_API_Rate_Limiter limiter(60, 90000); // 60 requests and 90k tokens per minute
+ *   aiClient.setRateLimiter(&limiter);      // Waits up to AI_API_RATE_LIMIT_MAX_WAIT_MS
+ */
+class AI_API_Rate_Limiter {
+public:
+    // 0 = no limit until the provider reports one
+    explicit AI_API_Rate_Limiter(uint32_t requestsPerMinute = 0, uint32_t tokensPerMinute = 0);
+    ~AI_API_Rate_Limiter();
+
+    void setLimits(uint32_t requestsPerMinute, uint32_t tokensPerMinute);
+
+    // Take one request and 'tokens' tokens from the buckets, waiting up to maxWaitMs for them.
+    // Returns false without taking anything if they are not available in time; waitMs is then
+    // the time until they would be.
+    bool acquire(int tokens, uint32_t maxWaitMs, uint32_t& waitMs);
+    // Correct an acquire() of reservedTokens once the request's actual usage is known
+    void settle(int reservedTokens, int usedTokens);
+    // Learn limits and remaining budget from a response (call before the HTTPClient is ended)
+    void update(HTTPClient& http, int httpCode);
+
+    // Response headers update() reads; pass to HTTPClient::collectHeaders() before each request
+    static const char** getHeaderKeys();
+    static size_t getHeaderKeyCount();
+
+    uint32_t getRequestLimit() const { return _requests.capacity; }
+    uint32_t getTokenLimit() const { return _tokens.capacity; }
+    // Budget available right now (UINT32_MAX when unlimited)
+    uint32_t getRequestsAvailable();
+    uint32_t getTokensAvailable();
+    // Time left before requests may go again after a retry-after or exhausted budget
+    uint32_t getBlockedMs() const;
+    // Requests that had to wait, and requests refused locally
+    uint32_t getThrottledCount() const { return _throttled; }
+    uint32_t getRejectedCount() const { return _rejected; }
+
+private:
+    struct Bucket {
+        uint32_t capacity = 0; // Per minute; 0 = unlimited
+        float level = 0;
+        uint32_t refilledAt = 0;
+    };
+
+    Bucket _requests;
+    Bucket _tokens;
+    uint32_t _blockedUntil = 0; // millis(); valid while _blocked
+    bool _blocked = false;
+    uint32_t _throttled = 0;
+    uint32_t _rejected = 0;
+    SemaphoreHandle_t _mutex = nullptr;
+
+    static void _setCapacity(Bucket& bucket, uint32_t capacity);
+    static void _refill(Bucket& bucket, uint32_t now);
+    // Time until 'amount' is available in 'bucket'
+    static uint32_t _waitFor(const Bucket& bucket, float amount);
+    void _blockFor(uint32_t ms);
+    // Parse an OpenAI duration ("1s", "6m0s", "20ms"); returns milliseconds
+    static uint32_t _parseDuration(const String& value);
+
+    AI_API_Rate_Limiter(const AI_API_Rate_Limiter&);
+    AI_API_Rate_Limiter& operator=(const AI_API_Rate_Limiter&);
+};
+
+#endif // ENABLE_RATE_LIMITER
+#endif // AI_API_RATE_LIMITER_H
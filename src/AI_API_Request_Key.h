@@ -0,0 +1,35 @@
+// ESP32_AI_Connect/AI_API_Request_Key.h
+
+#ifndef AI_API_REQUEST_KEY_H
+#define AI_API_REQUEST_KEY_H
+
+#include <Arduino.h>
+
+/**
+ * AI_API_Request_Key - 64-bit FNV-1a hash identifying a request
+ *
+ * Fields are folded in one at a time:
+ *   uint64_t key = AI_API_Request_Key::SEED;
+ *   key = AI_API_Request_Key::add(key, url);
+ *   key = AI_API_Request_Key::add(key, &temperature, sizeof(temperature));
+ * String fields include their terminating NUL, so "ab"+"c" and "a"+"bc" differ.
+ */
+class AI_API_Request_Key {
+public:
+    static const uint64_t SEED = 14695981039346656037ULL; // FNV-1a offset basis
+
+    static uint64_t add(uint64_t key, const void* data, size_t length) {
+        const uint8_t* bytes = (const uint8_t*)data;
+        for (size_t i = 0; i < length; i++) {
+            key ^= bytes[i];
+            key *= 1099511628211ULL; // FNV-1a prime
+        }
+        return key;
+    }
+
+    static uint64_t add(uint64_t key, const String& field) {
+        return add(key, field.c_str(), field.length() + 1);
+    }
+};
+
+#endif // AI_API_REQUEST_KEY_H
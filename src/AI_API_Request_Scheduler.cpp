@@ -0,0 +1,310 @@
+// ESP32_AI_Connect/AI_API_Request_Scheduler.cpp
+
+#include "AI_API_Request_Scheduler.h"
+
+#ifdef ENABLE_REQUEST_SCHEDULER // Only compile if flag is set
+
+#include "ESP32_AI_Connect.h"
+
+AI_API_Request_Scheduler::AI_API_Request_Scheduler(ESP32_AI_Connect& client) : _client(&client) {
+}
+
+AI_API_Request_Scheduler::~AI_API_Request_Scheduler() {
+    end();
+}
+
+bool AI_API_Request_Scheduler::begin(uint32_t stackSize, UBaseType_t taskPriority) {
+    if (_dispatcher != nullptr) return true;
+
+    for (int p = 0; p < PRIORITY_COUNT; p++) {
+        if (_queues[p] == nullptr) _queues[p] = xQueueCreate(AI_API_SCHEDULER_QUEUE_DEPTH, sizeof(Request*));
+        if (_queues[p] == nullptr) return false;
+    }
+    if (_pending == nullptr) _pending = xSemaphoreCreateCounting(PRIORITY_COUNT * AI_API_SCHEDULER_QUEUE_DEPTH + 1, 0);
+    if (_lock == nullptr) _lock = xSemaphoreCreateMutex();
+    if (_stopped == nullptr) _stopped = xSemaphoreCreateBinary();
+    if (_pending == nullptr || _lock == nullptr || _stopped == nullptr) {
+        Serial.println("ERROR: Failed to create request scheduler semaphores");
+        return false;
+    }
+
+    _stopping = false;
+    _streak = 0;
+    if (xTaskCreate(_dispatch, "ai_scheduler", stackSize, this, taskPriority, &_dispatcher) != pdPASS) {
+        _dispatcher = nullptr;
+        Serial.println("ERROR: Failed to start request scheduler task");
+        return false;
+    }
+    return true;
+}
+
+void AI_API_Request_Scheduler::end() {
+    if (_dispatcher != nullptr) {
+        _stopping = true;
+        xSemaphoreGive(_pending); // Wake the dispatcher
+        xSemaphoreTake(_stopped, portMAX_DELAY);
+        _dispatcher = nullptr;
+        _cancelQueued(); // Requests queued while the dispatcher was exiting
+    }
+
+    for (int p = 0; p < PRIORITY_COUNT; p++) {
+        if (_queues[p] != nullptr) vQueueDelete(_queues[p]);
+        _queues[p] = nullptr;
+    }
+    if (_pending != nullptr) vSemaphoreDelete(_pending);
+    if (_lock != nullptr) vSemaphoreDelete(_lock);
+    if (_stopped != nullptr) vSemaphoreDelete(_stopped);
+    _pending = nullptr;
+    _lock = nullptr;
+    _stopped = nullptr;
+}
+
+bool AI_API_Request_Scheduler::run(const Job& job, Priority priority, uint32_t deadlineMs) {
+    const char* reason = nullptr;
+    return _run(job, priority, deadlineMs, reason);
+}
+
+bool AI_API_Request_Scheduler::_run(const Job& job, Priority priority, uint32_t deadlineMs, const char*& reason) {
+    if (_dispatcher != nullptr && xTaskGetCurrentTaskHandle() == _dispatcher) {
+        job(*_client); // Submitted from inside a job: waiting on the queue would deadlock
+        return true;
+    }
+    if (_dispatcher == nullptr || _stopping) {
+        reason = "Request scheduler is not running";
+        return false;
+    }
+
+    Request* request = new Request;
+    request->job = &job;
+    request->submittedAt = millis();
+    request->deadlineMs = deadlineMs;
+    request->state = Request::QUEUED;
+    request->refs = 2; // This task and the dispatcher
+    request->ran = false;
+    request->reason = nullptr;
+    request->done = xSemaphoreCreateBinary();
+
+    int p = constrain((int)priority, 0, PRIORITY_COUNT - 1);
+    bool accepted = request->done != nullptr && xQueueSend(_queues[p], &request, 0) == pdTRUE;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    if (accepted) {
+        _submitted++;
+        int depth = 0;
+        for (int i = 0; i < PRIORITY_COUNT; i++) depth += _waiting(i);
+        if (depth > _maxDepth) _maxDepth = depth;
+    } else {
+        _rejected++;
+    }
+    xSemaphoreGive(_lock);
+
+    if (accepted) {
+        xSemaphoreGive(_pending);
+        TickType_t wait = deadlineMs != 0 ? pdMS_TO_TICKS(deadlineMs) : portMAX_DELAY;
+        if (xSemaphoreTake(request->done, wait) != pdTRUE) {
+            if (_claim(request, Request::ABANDONED)) {
+                // Still queued: leave it for the dispatcher to drop
+                xSemaphoreTake(_lock, portMAX_DELAY);
+                _expired++;
+                xSemaphoreGive(_lock);
+                request->reason = "Request deadline passed while queued";
+            } else {
+                xSemaphoreTake(request->done, portMAX_DELAY); // Already running 'job'
+            }
+        }
+    } else {
+        request->refs = 1; // Never reached the dispatcher
+        request->reason = "Request queue is full";
+    }
+
+    bool ran = request->ran;
+    reason = request->reason;
+    _release(request);
+    return ran;
+}
+
+AI_API_Request_Scheduler::Result AI_API_Request_Scheduler::_call(Priority priority, uint32_t deadlineMs,
+        const std::function<String(ESP32_AI_Connect& client, Result& result)>& call) {
+    Result result;
+    const char* reason = nullptr;
+    result.ran = _run([&result, &call](ESP32_AI_Connect& client) {
+        result.reply = call(client, result);
+        result.error = client.getLastError();
+    }, priority, deadlineMs, reason);
+    if (!result.ran && reason != nullptr) result.error = reason;
+    return result;
+}
+
+AI_API_Request_Scheduler::Result AI_API_Request_Scheduler::chat(const String& userMessage, Priority priority,
+                                                                uint32_t deadlineMs) {
+    return _call(priority, deadlineMs, [&userMessage](ESP32_AI_Connect& client, Result& result) {
+        String reply = client.chat(userMessage);
+        result.responseCode = client.getChatResponseCode();
+        return reply;
+    });
+}
+
+#ifdef ENABLE_CHAT_SESSION
+AI_API_Request_Scheduler::Result AI_API_Request_Scheduler::chat(const String& userMessage, AI_API_Chat_Session& session,
+                                                                Priority priority, uint32_t deadlineMs) {
+    return _call(priority, deadlineMs, [&userMessage, &session](ESP32_AI_Connect& client, Result& result) {
+        String reply = client.chat(userMessage, session);
+        result.responseCode = client.getChatResponseCode();
+        return reply;
+    });
+}
+#endif
+
+#ifdef ENABLE_TOOL_CALLS
+AI_API_Request_Scheduler::Result AI_API_Request_Scheduler::tcChat(const String& tcUserMessage, Priority priority,
+                                                                  uint32_t deadlineMs) {
+    return _call(priority, deadlineMs, [&tcUserMessage](ESP32_AI_Connect& client, Result& result) {
+        String reply = client.tcChat(tcUserMessage);
+        result.responseCode = client.getTCChatResponseCode();
+        return reply;
+    });
+}
+
+AI_API_Request_Scheduler::Result AI_API_Request_Scheduler::tcReply(const String& toolResultsJson, Priority priority,
+                                                                   uint32_t deadlineMs) {
+    return _call(priority, deadlineMs, [&toolResultsJson](ESP32_AI_Connect& client, Result& result) {
+        String reply = client.tcReply(toolResultsJson);
+        result.responseCode = client.getTCReplyResponseCode();
+        return reply;
+    });
+}
+#endif
+
+int AI_API_Request_Scheduler::_waiting(int priority) const {
+    return _queues[priority] ? (int)uxQueueMessagesWaiting(_queues[priority]) : 0;
+}
+
+AI_API_Request_Scheduler::Request* AI_API_Request_Scheduler::_nextRequest() {
+    int level = -1;
+    for (int p = 0; p < PRIORITY_COUNT && level < 0; p++) {
+        if (_waiting(p) > 0) level = p;
+    }
+    if (level < 0) return nullptr;
+
+    int lower = -1;
+    for (int p = level + 1; p < PRIORITY_COUNT && lower < 0; p++) {
+        if (_waiting(p) > 0) lower = p;
+    }
+    if (lower >= 0 && _streak >= AI_API_SCHEDULER_FAIRNESS) {
+        level = lower; // Let waiting lower-priority work through once in a while
+        _streak = 0;
+    } else {
+        _streak = (lower >= 0) ? _streak + 1 : 0;
+    }
+
+    Request* request = nullptr;
+    xQueueReceive(_queues[level], &request, 0);
+    return request;
+}
+
+bool AI_API_Request_Scheduler::_claim(Request* request, int state) {
+    int queued = Request::QUEUED;
+    return __atomic_compare_exchange_n(&request->state, &queued, state, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+void AI_API_Request_Scheduler::_release(Request* request) {
+    if (__atomic_sub_fetch(&request->refs, 1, __ATOMIC_ACQ_REL) != 0) return;
+    if (request->done != nullptr) vSemaphoreDelete(request->done);
+    delete request;
+}
+
+// Called on a request the dispatcher took
+void AI_API_Request_Scheduler::_finish(Request* request, bool ran, const char* reason) {
+    request->ran = ran;
+    request->reason = reason;
+    xSemaphoreGive(request->done);
+    _release(request);
+}
+
+void AI_API_Request_Scheduler::_cancelQueued() {
+    for (int p = 0; p < PRIORITY_COUNT; p++) {
+        Request* request = nullptr;
+        while (_queues[p] != nullptr && xQueueReceive(_queues[p], &request, 0) == pdTRUE) {
+            if (_claim(request, Request::TAKEN)) {
+                _finish(request, false, "Request scheduler stopped");
+            } else {
+                _release(request); // Its task already gave up
+            }
+        }
+    }
+}
+
+void AI_API_Request_Scheduler::_dispatch(void* param) {
+    AI_API_Request_Scheduler* self = (AI_API_Request_Scheduler*)param;
+
+    while (true) {
+        xSemaphoreTake(self->_pending, portMAX_DELAY);
+        if (self->_stopping) break;
+
+        Request* request = self->_nextRequest();
+        if (request == nullptr) continue;
+        if (!_claim(request, Request::TAKEN)) {
+            _release(request); // Its task gave up on the deadline while it was queued
+            continue;
+        }
+
+        uint32_t waited = millis() - request->submittedAt;
+        bool expired = request->deadlineMs != 0 && waited >= request->deadlineMs;
+
+        xSemaphoreTake(self->_lock, portMAX_DELAY);
+        self->_dispatched++;
+        self->_totalWaitMs += waited;
+        if (waited > self->_maxWaitMs) self->_maxWaitMs = waited;
+        if (expired) self->_expired++;
+        xSemaphoreGive(self->_lock);
+
+        if (expired) {
+            #ifdef ENABLE_DEBUG_OUTPUT
+            Serial.println("Request scheduler: dropped request after " + String(waited) + " ms in queue");
+            #endif
+            self->_finish(request, false, "Request deadline passed while queued");
+            continue;
+        }
+
+        (*request->job)(*self->_client);
+
+        xSemaphoreTake(self->_lock, portMAX_DELAY);
+        self->_completed++;
+        xSemaphoreGive(self->_lock);
+        self->_finish(request, true, nullptr);
+    }
+
+    self->_cancelQueued();
+    xSemaphoreGive(self->_stopped);
+    vTaskDelete(nullptr);
+}
+
+AI_API_Request_Scheduler::Stats AI_API_Request_Scheduler::getStats() const {
+    Stats stats;
+    if (_lock != nullptr) xSemaphoreTake(_lock, portMAX_DELAY);
+    stats.submitted = _submitted;
+    stats.completed = _completed;
+    stats.expired = _expired;
+    stats.rejected = _rejected;
+    stats.maxDepth = _maxDepth;
+    stats.maxWaitMs = _maxWaitMs;
+    stats.avgWaitMs = _dispatched ? (uint32_t)(_totalWaitMs / _dispatched) : 0;
+    if (_lock != nullptr) xSemaphoreGive(_lock);
+    for (int p = 0; p < PRIORITY_COUNT; p++) stats.depth[p] = _waiting(p);
+    return stats;
+}
+
+void AI_API_Request_Scheduler::resetStats() {
+    if (_lock != nullptr) xSemaphoreTake(_lock, portMAX_DELAY);
+    _submitted = 0;
+    _completed = 0;
+    _expired = 0;
+    _rejected = 0;
+    _maxDepth = 0;
+    _maxWaitMs = 0;
+    _totalWaitMs = 0;
+    _dispatched = 0;
+    if (_lock != nullptr) xSemaphoreGive(_lock);
+}
+
+#endif // ENABLE_REQUEST_SCHEDULER
@@ -0,0 +1,155 @@
+// ESP32_AI_Connect/AI_API_Request_Scheduler.h
+
+#ifndef AI_API_REQUEST_SCHEDULER_H
+#define AI_API_REQUEST_SCHEDULER_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+
+#ifdef ENABLE_REQUEST_SCHEDULER // Only compile this file's content if flag is set
+
+#include <Arduino.h>
+#include <functional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+class ESP32_AI_Connect;
+#ifdef ENABLE_CHAT_SESSION
+class AI_API_Chat_Session;
+#endif
+
+/**
+ * AI_API_Request_Scheduler - Priority dispatcher that owns one client
+ *
+ * Tasks submit requests with a priority; a dispatcher task runs them on the
+ * client one at a time, highest priority first. After
+ * AI_API_SCHEDULER_FAIRNESS requests were taken ahead of waiting
+ * lower-priority work, one lower-priority request goes next so background
+ * work is never starved. A request whose deadline passes while it waits in
+ * the queue is dropped without being sent; its task returns at the deadline
+ * even if the dispatcher is still busy with a long request.
+ *
+ * Usage:
+ *   AI_API_Request_Scheduler scheduler(aiClient);
+ *   scheduler.begin();
+ *   // From any task:
+ *   AI_API_Request_Scheduler::Result result =
+ *       scheduler.chat("Turn on the lights", AI_API_Request_Scheduler::INTERACTIVE, 2000);
+ *   // Any other client call, run in priority order on the dispatcher:
+ *   scheduler.run([](ESP32_AI_Connect& client) { ... }, AI_API_Request_Scheduler::BACKGROUND);
+ *
+ * Submitting blocks the calling task until its request has run. Once the
+ * scheduler is started, use the client only through it.
+ */
+class AI_API_Request_Scheduler {
+public:
+    enum Priority : uint8_t {
+        INTERACTIVE = 0,  // A user is waiting for the answer
+        NORMAL = 1,
+        BACKGROUND = 2,   // Telemetry summaries, prefetching, ...
+        PRIORITY_COUNT = 3
+    };
+
+    typedef std::function<void(ESP32_AI_Connect& client)> Job;
+
+    struct Result {
+        String reply;
+        String error;         // Client error, or why the request was not run
+        int responseCode = 0; // HTTP code of the request, 0 if it was not sent
+        bool ran = false;     // False if the request was rejected, expired or cancelled
+    };
+
+    struct Stats {
+        uint32_t submitted;   // Requests accepted into a queue
+        uint32_t completed;   // Requests run on the client
+        uint32_t expired;     // Dropped because their deadline passed while queued
+        uint32_t rejected;    // Refused because their queue was full or the scheduler stopped
+        int depth[PRIORITY_COUNT]; // Requests waiting now, per priority
+        int maxDepth;         // Most requests waiting at once (all priorities)
+        uint32_t maxWaitMs;   // Longest time a request waited in a queue
+        uint32_t avgWaitMs;   // Average queue wait of dispatched requests
+    };
+
+    explicit AI_API_Request_Scheduler(ESP32_AI_Connect& client);
+    ~AI_API_Request_Scheduler();
+
+    // Create the queues and start the dispatcher task
+    bool begin(uint32_t stackSize = AI_API_SCHEDULER_TASK_STACK,
+               UBaseType_t taskPriority = AI_API_SCHEDULER_TASK_PRIORITY);
+    // Stop the dispatcher; queued requests are cancelled. Call once no task submits anymore.
+    void end();
+    bool isRunning() const { return _dispatcher != nullptr; }
+
+    // Run 'job' on the dispatcher and wait for it. deadlineMs (0 = none) bounds the time in
+    // the queue: the call returns false once it passes, unless 'job' already started.
+    bool run(const Job& job, Priority priority = NORMAL, uint32_t deadlineMs = 0);
+
+    // chat(), tcChat() and tcReply() through the queue
+    Result chat(const String& userMessage, Priority priority = INTERACTIVE, uint32_t deadlineMs = 0);
+#ifdef ENABLE_CHAT_SESSION
+    Result chat(const String& userMessage, AI_API_Chat_Session& session,
+                Priority priority = INTERACTIVE, uint32_t deadlineMs = 0);
+#endif
+#ifdef ENABLE_TOOL_CALLS
+    Result tcChat(const String& tcUserMessage, Priority priority = INTERACTIVE, uint32_t deadlineMs = 0);
+    Result tcReply(const String& toolResultsJson, Priority priority = INTERACTIVE, uint32_t deadlineMs = 0);
+#endif
+
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    // On the heap, shared by the submitting task and the dispatcher; whichever of the two
+    // lets go of it last frees it, so a task that gave up on its deadline can return at once
+    struct Request {
+        enum State { QUEUED, TAKEN, ABANDONED };
+        const Job* job;     // Only called while the submitting task waits for it
+        uint32_t submittedAt;
+        uint32_t deadlineMs;
+        SemaphoreHandle_t done;
+        int state;          // QUEUED until the dispatcher takes it or the submitter gives up
+        int refs;
+        bool ran;
+        const char* reason; // Why the job did not run
+    };
+
+    ESP32_AI_Connect* _client;
+    QueueHandle_t _queues[PRIORITY_COUNT] = {};
+    SemaphoreHandle_t _pending = nullptr;  // Counts queued requests; wakes the dispatcher
+    SemaphoreHandle_t _lock = nullptr;     // Guards the statistics
+    SemaphoreHandle_t _stopped = nullptr;  // Given by the dispatcher when it exits
+    TaskHandle_t _dispatcher = nullptr;
+    volatile bool _stopping = false;
+    int _streak = 0; // Requests taken in a row while lower-priority requests waited
+
+    uint32_t _submitted = 0;
+    uint32_t _completed = 0;
+    uint32_t _expired = 0;
+    uint32_t _rejected = 0;
+    int _maxDepth = 0;
+    uint32_t _maxWaitMs = 0;
+    uint64_t _totalWaitMs = 0;
+    uint32_t _dispatched = 0;
+
+    int _waiting(int priority) const;
+    // Next request to run, applying the fairness rule; nullptr if all queues are empty
+    Request* _nextRequest();
+    // Move a queued request to 'state'; false if the other side got to it first
+    static bool _claim(Request* request, int state);
+    static void _release(Request* request);
+    void _finish(Request* request, bool ran, const char* reason);
+    void _cancelQueued();
+    // run() that also reports why a job did not run
+    bool _run(const Job& job, Priority priority, uint32_t deadlineMs, const char*& reason);
+    // Shared by the Result-returning wrappers
+    Result _call(Priority priority, uint32_t deadlineMs,
+                 const std::function<String(ESP32_AI_Connect& client, Result& result)>& call);
+    static void _dispatch(void* param);
+
+    AI_API_Request_Scheduler(const AI_API_Request_Scheduler&);
+    AI_API_Request_Scheduler& operator=(const AI_API_Request_Scheduler&);
+};
+
+#endif // ENABLE_REQUEST_SCHEDULER
+#endif // AI_API_REQUEST_SCHEDULER_H
@@ -0,0 +1,292 @@
+// ESP32_AI_Connect/AI_API_Response_Cache.cpp
+
+#include "AI_API_Response_Cache.h"
+#include "AI_API_Memory.h"
+
+#ifdef ENABLE_RESPONSE_CACHE // Only compile if flag is set
+
+#include <time.h>
+
+// Flash entry layout: [magic][expiresAt, epoch seconds, 0 = never][length][text]
+#define AI_API_RESPONSE_CACHE_FILE_MAGIC 0x31435241UL // "ARC1"
+// Any earlier system time means the clock has not been set
+#define AI_API_RESPONSE_CACHE_MIN_EPOCH 1609459200UL  // 2021-01-01
+
+struct AI_API_Response_Cache_File_Header {
+    uint32_t magic;
+    uint32_t expiresAt;
+    uint32_t length;
+};
+
+// Current epoch seconds, 0 if the clock is not set
+static uint32_t cacheEpochNow() {
+    time_t now = time(nullptr);
+    return (now >= (time_t)AI_API_RESPONSE_CACHE_MIN_EPOCH) ? (uint32_t)now : 0;
+}
+
+AI_API_Response_Cache::AI_API_Response_Cache(int maxEntries, size_t maxBytes, uint32_t defaultTtlMs)
+    : _maxEntries(max(1, maxEntries)), _maxBytes(maxBytes), _defaultTtlMs(defaultTtlMs) {
+}
+
+AI_API_Response_Cache::~AI_API_Response_Cache() {
+    if (_entries) {
+        for (int i = 0; i < _maxEntries; i++) _free(i);
+        free(_entries);
+    }
+}
+
+bool AI_API_Response_Cache::enableFlashTier(fs::FS& fs, const char* dir, int maxFiles) {
+    if (dir == nullptr || maxFiles <= 0) return false;
+    if (!fs.exists(dir) && !fs.mkdir(dir)) return false;
+    _fs = &fs;
+    _dir = dir;
+    _maxFiles = maxFiles;
+    return true;
+}
+
+void AI_API_Response_Cache::disableFlashTier() {
+    _fs = nullptr;
+}
+
+int AI_API_Response_Cache::_find(uint64_t key) const {
+    if (_entries == nullptr) return -1;
+    for (int i = 0; i < _maxEntries; i++) {
+        if (_entries[i].text != nullptr && _entries[i].key == key) return i;
+    }
+    return -1;
+}
+
+void AI_API_Response_Cache::_free(int index) {
+    Entry& entry = _entries[index];
+    if (entry.text == nullptr) return;
+    _bytes -= entry.length;
+    _count--;
+    AI_API_Memory::deallocate(entry.text);
+    entry.text = nullptr;
+}
+
+bool AI_API_Response_Cache::get(uint64_t key, String& text) {
+    int index = _find(key);
+    if (index >= 0) {
+        Entry& entry = _entries[index];
+        if (entry.ttlMs == 0 || (uint32_t)(millis() - entry.storedAt) < entry.ttlMs) {
+            entry.lastUsed = ++_tick;
+            text = entry.text;
+            _hits++;
+            return true;
+        }
+        _free(index);
+        _expirations++;
+    }
+
+    uint32_t ttlMs = 0;
+    if (_getFlash(key, text, ttlMs)) {
+        _putMemory(key, text.c_str(), text.length(), ttlMs); // Promote
+        _flashHits++;
+        return true;
+    }
+
+    _misses++;
+    return false;
+}
+
+bool AI_API_Response_Cache::put(uint64_t key, const String& text, uint32_t ttlMs) {
+    if (!_putMemory(key, text.c_str(), text.length(), ttlMs)) return false;
+    _putFlash(key, text, ttlMs);
+    return true;
+}
+
+bool AI_API_Response_Cache::_putMemory(uint64_t key, const char* text, size_t length, uint32_t ttlMs) {
+    if (length > _maxBytes) return false; // Would never fit
+
+    if (_entries == nullptr) {
+        _entries = (Entry*)calloc(_maxEntries, sizeof(Entry));
+        if (_entries == nullptr) return false;
+    }
+
+    int existing = _find(key);
+    if (existing >= 0) _free(existing);
+
+    // Evict least recently used entries until the response fits
+    while (_count > 0 && (_count >= _maxEntries || _bytes + length > _maxBytes)) {
+        int oldest = -1;
+        for (int i = 0; i < _maxEntries; i++) {
+            if (_entries[i].text != nullptr &&
+                (oldest < 0 || _entries[i].lastUsed < _entries[oldest].lastUsed)) {
+                oldest = i;
+            }
+        }
+        _free(oldest);
+        _evictions++;
+    }
+
+    int slot = 0;
+    while (_entries[slot].text != nullptr) slot++;
+
+    // Response texts go to PSRAM when the board has it
+    char* copy = (char*)AI_API_Memory::allocate(length + 1);
+    if (copy == nullptr) return false;
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+
+    Entry& entry = _entries[slot];
+    entry.key = key;
+    entry.text = copy;
+    entry.length = length;
+    entry.storedAt = millis();
+    entry.ttlMs = ttlMs;
+    entry.lastUsed = ++_tick;
+    _bytes += length;
+    _count++;
+    return true;
+}
+
+void AI_API_Response_Cache::remove(uint64_t key) {
+    int index = _find(key);
+    if (index >= 0) _free(index);
+    if (_fs) {
+        String path = _flashPath(key);
+        if (_fs->exists(path)) _fs->remove(path);
+    }
+}
+
+void AI_API_Response_Cache::clear() {
+    if (_entries) {
+        for (int i = 0; i < _maxEntries; i++) _free(i);
+    }
+    if (_fs) {
+        // Collect a few paths per pass: removing while iterating skips files on some file systems
+        const int batchSize = 8;
+        int found;
+        do {
+            String paths[batchSize];
+            found = 0;
+            File dir = _fs->open(_dir);
+            if (!dir) return;
+            for (File file = dir.openNextFile(); file && found < batchSize; file = dir.openNextFile()) {
+                paths[found++] = _dir + "/" + file.name();
+                file.close();
+            }
+            dir.close();
+            for (int i = 0; i < found; i++) _fs->remove(paths[i]);
+        } while (found == batchSize);
+    }
+}
+
+AI_API_Response_Cache::Stats AI_API_Response_Cache::getStats() const {
+    Stats stats;
+    stats.hits = _hits;
+    stats.flashHits = _flashHits;
+    stats.misses = _misses;
+    stats.evictions = _evictions;
+    stats.expirations = _expirations;
+    stats.entries = _count;
+    stats.bytes = _bytes;
+    return stats;
+}
+
+void AI_API_Response_Cache::resetStats() {
+    _hits = 0;
+    _flashHits = 0;
+    _misses = 0;
+    _evictions = 0;
+    _expirations = 0;
+}
+
+String AI_API_Response_Cache::_flashPath(uint64_t key) const {
+    char name[17];
+    snprintf(name, sizeof(name), "%08lx%08lx", (unsigned long)(key >> 32), (unsigned long)(key & 0xFFFFFFFFUL));
+    return _dir + "/" + name;
+}
+
+bool AI_API_Response_Cache::_getFlash(uint64_t key, String& text, uint32_t& ttlMs) {
+    if (_fs == nullptr) return false;
+
+    String path = _flashPath(key);
+    if (!_fs->exists(path)) return false;
+    File file = _fs->open(path, FILE_READ);
+    if (!file) return false;
+
+    AI_API_Response_Cache_File_Header header;
+    bool valid = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                 header.magic == AI_API_RESPONSE_CACHE_FILE_MAGIC &&
+                 header.length == file.size() - sizeof(header);
+    if (valid && header.expiresAt != 0) {
+        uint32_t now = cacheEpochNow();
+        if (now == 0 || now >= header.expiresAt) {
+            valid = false;
+            if (now != 0) _expirations++;
+        } else {
+            uint32_t remaining = header.expiresAt - now;
+            ttlMs = (remaining < 0xFFFFFFFFUL / 1000) ? remaining * 1000 : 0xFFFFFFFFUL;
+        }
+    } else {
+        ttlMs = 0;
+    }
+
+    if (valid) {
+        char* buffer = (char*)malloc(header.length + 1);
+        valid = buffer != nullptr && file.read((uint8_t*)buffer, header.length) == header.length;
+        if (valid) {
+            buffer[header.length] = '\0';
+            text = buffer;
+        }
+        free(buffer);
+    }
+    file.close();
+
+    if (!valid && cacheEpochNow() != 0) {
+        _fs->remove(path); // Expired or corrupt
+    }
+    return valid;
+}
+
+void AI_API_Response_Cache::_putFlash(uint64_t key, const String& text, uint32_t ttlMs) {
+    if (_fs == nullptr) return;
+
+    AI_API_Response_Cache_File_Header header;
+    header.magic = AI_API_RESPONSE_CACHE_FILE_MAGIC;
+    header.length = text.length();
+    header.expiresAt = 0;
+    if (ttlMs != 0) {
+        uint32_t now = cacheEpochNow();
+        if (now == 0) return; // Expiry cannot be tracked across reboots without the time
+        header.expiresAt = now + (ttlMs + 999) / 1000;
+    }
+
+    String path = _flashPath(key);
+    if (!_fs->exists(path)) _makeFlashRoom();
+
+    File file = _fs->open(path, FILE_WRITE);
+    if (!file) return;
+    bool written = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                   file.write((const uint8_t*)text.c_str(), text.length()) == text.length();
+    file.close();
+    if (!written) _fs->remove(path); // Partial file (flash full)
+}
+
+void AI_API_Response_Cache::_makeFlashRoom() {
+    File dir = _fs->open(_dir);
+    if (!dir) return;
+
+    int files = 0;
+    String oldestPath;
+    time_t oldestTime = 0;
+    for (File file = dir.openNextFile(); file; file = dir.openNextFile()) {
+        time_t written = file.getLastWrite();
+        if (files == 0 || written < oldestTime) {
+            oldestTime = written;
+            oldestPath = _dir + "/" + file.name();
+        }
+        files++;
+        file.close();
+    }
+    dir.close();
+
+    if (files >= _maxFiles && !oldestPath.isEmpty()) {
+        _fs->remove(oldestPath);
+        _evictions++;
+    }
+}
+
+#endif // ENABLE_RESPONSE_CACHE
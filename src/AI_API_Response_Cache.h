@@ -0,0 +1,117 @@
+// ESP32_AI_Connect/AI_API_Response_Cache.h
+
+#ifndef AI_API_RESPONSE_CACHE_H
+#define AI_API_RESPONSE_CACHE_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+
+#ifdef ENABLE_RESPONSE_CACHE // Only compile this file's content if flag is set
+
+#include <Arduino.h>
+#include <FS.h>
+#include "AI_API_Request_Key.h"
+
+/**
+ * AI_API_Response_Cache - Exact-match cache for chat responses
+ *
+ * Maps a 64-bit request key (see AI_API_Request_Key.h) built from everything
+ * that shapes the reply to the response text. The memory tier keeps up to
+ * maxEntries responses within a byte budget, stored in PSRAM when available,
+ * and evicts the least recently used entry when full. An optional flash tier (e.g. LittleFS)
+ * keeps one file per response so answers survive a reboot; flash hits are
+ * promoted back into memory.
+ *
+ * Usage:
+ *   AI_API_Response_Cache cache;            // 16 entries, 16 KB, 1 hour TTL
+ *   LittleFS.begin(true);
+ *   cache.enableFlashTier(LittleFS);        // Optional
+ *   aiClient.setChatTemperature(0);         // Only deterministic requests are cached
+ *   aiClient.setResponseCache(&cache);
+ *
+ * Flash entries with a TTL need the system time (configTime/SNTP); without it
+ * only entries that never expire (TTL 0) use the flash tier.
+ */
+class AI_API_Response_Cache {
+public:
+    struct Stats {
+        uint32_t hits;         // Served from memory
+        uint32_t flashHits;    // Served from the flash tier
+        uint32_t misses;
+        uint32_t evictions;    // Entries dropped to make room (memory and flash)
+        uint32_t expirations;  // Entries dropped because their TTL passed
+        int entries;           // Entries currently in memory
+        size_t bytes;          // Response bytes currently in memory
+    };
+
+    explicit AI_API_Response_Cache(int maxEntries = AI_API_RESPONSE_CACHE_ENTRIES,
+                                   size_t maxBytes = AI_API_RESPONSE_CACHE_BYTES,
+                                   uint32_t defaultTtlMs = AI_API_RESPONSE_CACHE_TTL_MS);
+    ~AI_API_Response_Cache();
+
+    // Keep a copy of every response in 'dir' on 'fs' (mounted by the caller), at most maxFiles
+    bool enableFlashTier(fs::FS& fs, const char* dir = AI_API_RESPONSE_CACHE_FLASH_DIR,
+                         int maxFiles = AI_API_RESPONSE_CACHE_FLASH_FILES);
+    void disableFlashTier();
+
+    // Look up 'key'; on a hit copies the response into 'text' and returns true
+    bool get(uint64_t key, String& text);
+    // Store a response with the default TTL, or with ttlMs (0 = never expires)
+    bool put(uint64_t key, const String& text) { return put(key, text, _defaultTtlMs); }
+    bool put(uint64_t key, const String& text, uint32_t ttlMs);
+    // Drop one entry from both tiers
+    void remove(uint64_t key);
+    // Drop all entries from both tiers
+    void clear();
+
+    void setDefaultTTL(uint32_t ttlMs) { _defaultTtlMs = ttlMs; }
+    uint32_t getDefaultTTL() const { return _defaultTtlMs; }
+
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    struct Entry {
+        uint64_t key;
+        char* text;         // nullptr = free slot
+        size_t length;
+        uint32_t storedAt;  // millis() when stored
+        uint32_t ttlMs;     // 0 = never expires
+        uint32_t lastUsed;  // LRU tick
+    };
+
+    Entry* _entries = nullptr;  // Allocated on first put()
+    int _maxEntries;
+    size_t _maxBytes;
+    size_t _bytes = 0;
+    int _count = 0;
+    uint32_t _defaultTtlMs;
+    uint32_t _tick = 0;
+
+    fs::FS* _fs = nullptr;
+    String _dir;
+    int _maxFiles = 0;
+
+    uint32_t _hits = 0;
+    uint32_t _flashHits = 0;
+    uint32_t _misses = 0;
+    uint32_t _evictions = 0;
+    uint32_t _expirations = 0;
+
+    int _find(uint64_t key) const;
+    void _free(int index);
+    // Store in the memory tier only
+    bool _putMemory(uint64_t key, const char* text, size_t length, uint32_t ttlMs);
+
+    String _flashPath(uint64_t key) const;
+    bool _getFlash(uint64_t key, String& text, uint32_t& ttlMs);
+    void _putFlash(uint64_t key, const String& text, uint32_t ttlMs);
+    // Remove the oldest file if the flash tier is full
+    void _makeFlashRoom();
+
+    // Copying would duplicate the entry buffers
+    AI_API_Response_Cache(const AI_API_Response_Cache&);
+    AI_API_Response_Cache& operator=(const AI_API_Response_Cache&);
+};
+
+#endif // ENABLE_RESPONSE_CACHE
+#endif // AI_API_RESPONSE_CACHE_H
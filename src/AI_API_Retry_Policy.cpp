@@ -0,0 +1,55 @@
+// ESP32_AI_Connect/AI_API_Retry_Policy.cpp
+
+#include "AI_API_Retry_Policy.h"
+
+#ifdef ENABLE_RETRY // Only compile if flag is set
+
+static const char* retryHeaderKeys[] = { "retry-after", "retry-after-ms" };
+
+bool AI_API_Retry_Policy::isRetryable(int httpCode) const {
+    switch (httpCode) {
+        case HTTPC_ERROR_CONNECTION_REFUSED:
+        case HTTPC_ERROR_SEND_HEADER_FAILED:
+        case HTTPC_ERROR_SEND_PAYLOAD_FAILED:
+        case HTTPC_ERROR_NOT_CONNECTED:
+        case HTTPC_ERROR_NO_HTTP_SERVER:
+            return true;
+        case HTTPC_ERROR_CONNECTION_LOST:
+        case HTTPC_ERROR_READ_TIMEOUT:
+            return retryAfterSend; // The request may have been sent
+        case 408: // Request Timeout
+        case 429: // Too Many Requests
+            return true;
+        case 501: // Not Implemented
+        case 505: // HTTP Version Not Supported
+            return false;
+        default:
+            return httpCode >= 500 && httpCode < 600;
+    }
+}
+
+uint32_t AI_API_Retry_Policy::backoffMs(int attempt) const {
+    uint32_t delayMs = baseDelayMs;
+    for (int i = 1; i < attempt && delayMs < maxDelayMs; i++) delayMs *= 2;
+    if (delayMs > maxDelayMs) delayMs = maxDelayMs;
+    // Spread retries of clients that failed together
+    return delayMs / 2 + (delayMs > 1 ? esp_random() % (delayMs / 2 + 1) : 0);
+}
+
+uint32_t AI_API_Retry_Policy::retryAfterMs(HTTPClient& http) {
+    String value = http.header(retryHeaderKeys[1]);
+    if (!value.isEmpty()) return (uint32_t)value.toInt();
+    value = http.header(retryHeaderKeys[0]);
+    if (!value.isEmpty()) return (uint32_t)(value.toFloat() * 1000); // HTTP-date values are ignored
+    return 0;
+}
+
+const char** AI_API_Retry_Policy::getHeaderKeys() {
+    return retryHeaderKeys;
+}
+
+size_t AI_API_Retry_Policy::getHeaderKeyCount() {
+    return sizeof(retryHeaderKeys) / sizeof(retryHeaderKeys[0]);
+}
+
+#endif // ENABLE_RETRY
@@ -0,0 +1,47 @@
+// ESP32_AI_Connect/AI_API_Retry_Policy.h
+
+#ifndef AI_API_RETRY_POLICY_H
+#define AI_API_RETRY_POLICY_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+
+#ifdef ENABLE_RETRY // Only compile this file's content if flag is set
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+
+/**
+ * AI_API_Retry_Policy - When and how long to wait before sending a request again
+ *
+ * Retryable: failures to connect or send (negative HTTPClient codes), 408,
+ * 429 and 5xx except 501/505. Other 4xx answers are returned at once since
+ * sending them again cannot succeed. A read timeout or a connection lost
+ * while waiting can happen after the server got the request; sending it
+ * again may generate (and bill) it twice, so those are retried only with
+ * retryAfterSend.
+ *
+ * The wait before attempt n+1 is exponential with jitter: a random value
+ * between half and all of min(baseDelayMs * 2^(n-1), maxDelayMs). A longer
+ * retry-after (or retry-after-ms) from the server wins. No attempt starts
+ * once it could not begin within deadlineMs of the first one.
+ */
+struct AI_API_Retry_Policy {
+    uint8_t maxAttempts = AI_API_RETRY_MAX_ATTEMPTS; // Including the first; 1 disables retries
+    uint32_t baseDelayMs = AI_API_RETRY_BASE_DELAY_MS;
+    uint32_t maxDelayMs = AI_API_RETRY_MAX_DELAY_MS;
+    uint32_t deadlineMs = AI_API_RETRY_DEADLINE_MS;   // Across all attempts; 0 = none
+    bool retryAfterSend = false; // Also retry read timeouts and lost connections
+
+    bool isRetryable(int httpCode) const;
+    // Wait after failed attempt number 'attempt' (1 = the first request)
+    uint32_t backoffMs(int attempt) const;
+    // Wait the server asked for in the last response, 0 if none
+    static uint32_t retryAfterMs(HTTPClient& http);
+
+    // Response headers retryAfterMs() reads; pass to HTTPClient::collectHeaders()
+    static const char** getHeaderKeys();
+    static size_t getHeaderKeyCount();
+};
+
+#endif // ENABLE_RETRY
+#endif // AI_API_RETRY_POLICY_H
@@ -0,0 +1,110 @@
+// ESP32_AI_Connect/AI_API_Single_Flight.cpp
+
+#include "AI_API_Single_Flight.h"
+
+#ifdef ENABLE_SINGLE_FLIGHT // Only compile if flag is set
+
+AI_API_Single_Flight::AI_API_Single_Flight() {
+#ifndef ENABLE_LAZY_ALLOCATION // Else created by the first join()
+    _mutex = xSemaphoreCreateMutex();
+    if (_mutex == nullptr) {
+        Serial.println("ERROR: Failed to create single-flight mutex");
+    }
+#endif
+    for (int i = 0; i < AI_API_SINGLE_FLIGHT_SLOTS; i++) {
+        Flight& flight = _flights[i];
+        flight.key = 0;
+        flight.active = false;
+        flight.done = false;
+        flight.waiters = 0;
+        flight.pending = 0;
+#ifdef ENABLE_LAZY_ALLOCATION
+        flight.ready = nullptr; // Created when join() first leads a request on this slot
+#else
+        flight.ready = xSemaphoreCreateCounting(AI_API_SINGLE_FLIGHT_MAX_WAITERS, 0);
+#endif
+    }
+}
+
+AI_API_Single_Flight::~AI_API_Single_Flight() {
+    for (int i = 0; i < AI_API_SINGLE_FLIGHT_SLOTS; i++) {
+        if (_flights[i].ready != nullptr) vSemaphoreDelete(_flights[i].ready);
+    }
+    if (_mutex != nullptr) vSemaphoreDelete(_mutex);
+}
+
+int AI_API_Single_Flight::join(uint64_t key, bool& leader) {
+    leader = true;
+#ifdef ENABLE_LAZY_ALLOCATION
+    AI_API_Lazy_Mutex::get(_mutex);
+#endif
+    if (_mutex == nullptr || xSemaphoreTake(_mutex, portMAX_DELAY) != pdTRUE) return -1;
+
+    int freeSlot = -1;
+    for (int i = 0; i < AI_API_SINGLE_FLIGHT_SLOTS; i++) {
+        Flight& flight = _flights[i];
+        if (!flight.active) {
+            if (freeSlot < 0) freeSlot = i;
+        } else if (!flight.done && flight.key == key && flight.waiters < AI_API_SINGLE_FLIGHT_MAX_WAITERS) {
+            flight.waiters++;
+            _coalesced++;
+            leader = false;
+            xSemaphoreGive(_mutex);
+            return i;
+        }
+    }
+
+    if (freeSlot >= 0 && _flights[freeSlot].ready == nullptr) {
+        // Slots get their semaphore on first use; without one the call runs on its own
+        _flights[freeSlot].ready = xSemaphoreCreateCounting(AI_API_SINGLE_FLIGHT_MAX_WAITERS, 0);
+        if (_flights[freeSlot].ready == nullptr) freeSlot = -1;
+    }
+    if (freeSlot >= 0) {
+        Flight& flight = _flights[freeSlot];
+        flight.key = key;
+        flight.active = true;
+        flight.done = false;
+        flight.waiters = 0;
+        flight.pending = 0;
+    }
+    xSemaphoreGive(_mutex);
+    return freeSlot;
+}
+
+void AI_API_Single_Flight::complete(int slot, const String& result, const String& error) {
+    if (slot < 0 || slot >= AI_API_SINGLE_FLIGHT_SLOTS) return;
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
+    Flight& flight = _flights[slot];
+    flight.done = true;
+    flight.pending = flight.waiters;
+    if (flight.pending == 0) {
+        flight.active = false; // Nobody joined
+    } else {
+        flight.result = result;
+        flight.error = error;
+        for (int i = 0; i < flight.waiters; i++) {
+            xSemaphoreGive(flight.ready);
+        }
+    }
+
+    xSemaphoreGive(_mutex);
+}
+
+void AI_API_Single_Flight::wait(int slot, String& result, String& error) {
+    Flight& flight = _flights[slot];
+    xSemaphoreTake(flight.ready, portMAX_DELAY);
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    result = flight.result;
+    error = flight.error;
+    if (--flight.pending == 0) {
+        // Last waiter releases the slot
+        flight.active = false;
+        flight.result = "";
+        flight.error = "";
+    }
+    xSemaphoreGive(_mutex);
+}
+
+#endif // ENABLE_SINGLE_FLIGHT
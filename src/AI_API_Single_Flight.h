@@ -0,0 +1,72 @@
+// ESP32_AI_Connect/AI_API_Single_Flight.h
+
+#ifndef AI_API_SINGLE_FLIGHT_H
+#define AI_API_SINGLE_FLIGHT_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+
+#ifdef ENABLE_SINGLE_FLIGHT // Only compile this file's content if flag is set
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "AI_API_Lazy_Mutex.h"
+
+/**
+ * AI_API_Single_Flight - Coalesces identical concurrent requests
+ *
+ * The first task asking for a request key leads the call; tasks asking for
+ * the same key while it is in flight wait for the leader and receive its
+ * result instead of sending their own request.
+ *
+ *   bool leader;
+ *   int slot = flights.join(key, leader);
+ *   if (leader) {
+ *       String result = doRequest();
+ *       flights.complete(slot, result, error);
+ *   } else {
+ *       flights.wait(slot, result, error);
+ *   }
+ *
+ * join() returns -1 (as leader) when all slots are busy; the call then runs
+ * on its own and complete() ignores it. With ENABLE_LAZY_ALLOCATION the
+ * mutex and each slot's semaphore are created by the join() that first
+ * needs them, so an unused instance holds no FreeRTOS objects.
+ */
+class AI_API_Single_Flight {
+public:
+    AI_API_Single_Flight();
+    ~AI_API_Single_Flight();
+
+    // Join the in-flight call for 'key', or start one (leader = true)
+    int join(uint64_t key, bool& leader);
+    // Publish the leader's result to every task waiting on 'slot'
+    void complete(int slot, const String& result, const String& error);
+    // Block until the leader of 'slot' completes, then copy its result
+    void wait(int slot, String& result, String& error);
+
+    // Number of calls answered by another task's request
+    uint32_t getCoalescedCount() const { return _coalesced; }
+
+private:
+    struct Flight {
+        uint64_t key;
+        bool active;           // Slot in use
+        bool done;             // Result published; no new waiters may join
+        int waiters;           // Tasks that joined this flight
+        int pending;           // Waiters that have not copied the result yet
+        String result;
+        String error;
+        SemaphoreHandle_t ready; // Given once per waiter on completion
+    };
+
+    Flight _flights[AI_API_SINGLE_FLIGHT_SLOTS];
+    SemaphoreHandle_t _mutex = nullptr;
+    volatile uint32_t _coalesced = 0;
+
+    AI_API_Single_Flight(const AI_API_Single_Flight&);
+    AI_API_Single_Flight& operator=(const AI_API_Single_Flight&);
+};
+
+#endif // ENABLE_SINGLE_FLIGHT
+#endif // AI_API_SINGLE_FLIGHT_H
@@ -0,0 +1,29 @@
+// ESP32_AI_Connect/AI_API_Timeouts.h
+
+#ifndef AI_API_TIMEOUTS_H
+#define AI_API_TIMEOUTS_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include <HTTPClient.h>
+
+/**
+ * AI_API_Timeouts - Hands the phase budgets of a request to HTTPClient
+ *
+ * Shared by ESP32_AI_Connect (and its hedge task) and ESP32_AI_Client so
+ * both clients bound the TCP connect, the TLS handshake and the wait for
+ * the response the same way. Each budget is cut to remainingMs, the time
+ * left of an overall deadline.
+ */
+struct AI_API_Timeouts {
+    static void apply(HTTPClient& http, WiFiClientSecure& client, uint32_t connectMs,
+                      uint32_t tlsMs, uint32_t firstByteMs, uint32_t remainingMs = UINT32_MAX) {
+        http.setConnectTimeout(min(connectMs, remainingMs));
+        client.setHandshakeTimeout((min(tlsMs, remainingMs) + 999) / 1000); // Seconds
+        http.setTimeout((uint16_t)min(firstByteMs, remainingMs)); // Also bounds the response body reads
+    }
+};
+
+#endif // AI_API_TIMEOUTS_H
@@ -0,0 +1,91 @@
+// ESP32_AI_Connect/AI_API_Token_Estimator.cpp
+
+#include "AI_API_Token_Estimator.h"
+
+#ifdef ENABLE_TOKEN_ESTIMATOR // Only compile if flag is set
+
+// Weight of a new sample in the calibration average
+#define AI_API_TOKEN_ESTIMATOR_ALPHA 0.25f
+// Calibration never moves the estimate beyond these factors
+#define AI_API_TOKEN_ESTIMATOR_MIN_CALIBRATION 0.5f
+#define AI_API_TOKEN_ESTIMATOR_MAX_CALIBRATION 2.0f
+
+void AI_API_Token_Estimator::setPlatform(const String& platform) {
+    // Starting points relative to OpenAI's o200k/cl100k tokenizers for English text and JSON
+    if (platform == "claude") {
+        _platformScale = 1.15f;
+    } else if (platform == "gemini") {
+        _platformScale = 0.95f;
+    } else {
+        _platformScale = 1.0f; // openai, deepseek and OpenAI-compatible APIs
+    }
+    _calibration = 1.0f;
+    _lastErrorPercent = 0.0f;
+    _samples = 0;
+}
+
+int AI_API_Token_Estimator::countRaw(const char* text, size_t length) {
+    if (text == nullptr) return 0;
+
+    int tokens = 0;
+    size_t i = 0;
+    while (i < length) {
+        uint8_t c = (uint8_t)text[i];
+        size_t start = i;
+
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+            // Word: common words are one token, longer ones split roughly every 5 letters
+            while (i < length && (((uint8_t)text[i] >= 'a' && (uint8_t)text[i] <= 'z') ||
+                                  ((uint8_t)text[i] >= 'A' && (uint8_t)text[i] <= 'Z'))) {
+                i++;
+            }
+            tokens += (int)((i - start + 4) / 5);
+        } else if (c >= '0' && c <= '9') {
+            // Numbers are split into groups of up to three digits
+            while (i < length && text[i] >= '0' && text[i] <= '9') i++;
+            tokens += (int)((i - start + 2) / 3);
+        } else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            // A single space merges into the next word; other whitespace runs cost one token
+            bool hasNewline = false;
+            while (i < length && (text[i] == ' ' || text[i] == '\t' || text[i] == '\r' || text[i] == '\n')) {
+                if (text[i] == '\n') hasNewline = true;
+                i++;
+            }
+            if (hasNewline || i - start > 1) tokens++;
+        } else if (c < 0x80) {
+            // Punctuation: frequent pairs such as '":' or '},' are single tokens
+            while (i < length && (uint8_t)text[i] < 0x80 && ispunct((uint8_t)text[i])) i++;
+            if (i == start) i++; // Control characters
+            tokens += (int)((i - start + 1) / 2);
+        } else {
+            // Non-ASCII: about one token per character, two for 4-byte sequences (emoji)
+            size_t seqLen = (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3 : (c >= 0xC0) ? 2 : 1;
+            i += seqLen;
+            tokens += (seqLen == 4) ? 2 : 1;
+        }
+    }
+    return tokens;
+}
+
+int AI_API_Token_Estimator::scale(int rawTokens) const {
+    return (int)(rawTokens * _platformScale * _calibration + 0.5f);
+}
+
+void AI_API_Token_Estimator::calibrate(int rawTokens, int actualPromptTokens) {
+    if (rawTokens <= 0 || actualPromptTokens <= 0) return;
+
+    int estimated = scale(rawTokens);
+    _lastErrorPercent = 100.0f * (estimated - actualPromptTokens) / actualPromptTokens;
+
+    float ratio = (float)actualPromptTokens / (rawTokens * _platformScale);
+    if (_samples == 0) {
+        _calibration = ratio;
+    } else {
+        _calibration += AI_API_TOKEN_ESTIMATOR_ALPHA * (ratio - _calibration);
+    }
+    _calibration = constrain(_calibration, AI_API_TOKEN_ESTIMATOR_MIN_CALIBRATION,
+                             AI_API_TOKEN_ESTIMATOR_MAX_CALIBRATION);
+    _samples++;
+}
+
+#endif // ENABLE_TOKEN_ESTIMATOR
@@ -0,0 +1,58 @@
+// ESP32_AI_Connect/AI_API_Token_Estimator.h
+
+#ifndef AI_API_TOKEN_ESTIMATOR_H
+#define AI_API_TOKEN_ESTIMATOR_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+
+#ifdef ENABLE_TOKEN_ESTIMATOR // Only compile this file's content if flag is set
+
+#include <Arduino.h>
+
+/**
+ * AI_API_Token_Estimator - Local prompt token estimate
+ *
+ * Approximates BPE tokenizers without a vocabulary: text is split into runs
+ * of letters, digits, punctuation, whitespace and non-ASCII characters, and
+ * each run is charged the number of tokens such runs typically take
+ * (e.g. one token per short word, one per three digits). The raw count is
+ * then scaled by a per-platform factor and by a calibration ratio learned
+ * from the prompt token counts the provider reports, so the estimate tracks
+ * the actual tokenizer after a few requests.
+ */
+class AI_API_Token_Estimator {
+public:
+    // Select the platform defaults and drop any learned calibration
+    void setPlatform(const String& platform);
+
+    // Raw heuristic token count of 'text' (not scaled)
+    static int countRaw(const char* text, size_t length);
+    static int countRaw(const String& text) { return countRaw(text.c_str(), text.length()); }
+
+    // Raw count of one chat message, including its per-message overhead
+    static int countMessage(const char* text, size_t length) {
+        return countRaw(text, length) + AI_API_TOKEN_ESTIMATOR_MESSAGE_OVERHEAD;
+    }
+
+    // Scaled estimate for a raw count
+    int scale(int rawTokens) const;
+
+    // Learn from a request whose raw estimate was 'rawTokens' and which the provider
+    // billed as 'actualPromptTokens'
+    void calibrate(int rawTokens, int actualPromptTokens);
+
+    float getCalibration() const { return _calibration; }
+    // Relative error (percent) of the estimate for the last calibrated request
+    float getLastErrorPercent() const { return _lastErrorPercent; }
+    // Number of requests used for calibration since setPlatform()
+    uint32_t getSampleCount() const { return _samples; }
+
+private:
+    float _platformScale = 1.0f;  // Tokenizer-specific starting point
+    float _calibration = 1.0f;    // Learned correction (EWMA of actual / estimated)
+    float _lastErrorPercent = 0.0f;
+    uint32_t _samples = 0;
+};
+
+#endif // ENABLE_TOKEN_ESTIMATOR
+#endif // AI_API_TOKEN_ESTIMATOR_H
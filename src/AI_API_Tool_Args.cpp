@@ -0,0 +1,160 @@
+// ESP32_AI_Connect/AI_API_Tool_Args.cpp
+
+#include "AI_API_Tool_Args.h"
+
+#ifdef ENABLE_TOOL_CALLS // Only compile if flag is set
+
+// Longest argument name checked by validate(); longer names are reported as missing
+#define AI_API_TOOL_ARG_MAX_NAME_LEN 48
+
+char AI_API_Tool_Args::_typeCode(const char* type) {
+    // Case-insensitive so Gemini style schemas ("STRING") map the same way
+    if (type == nullptr) return '*';
+    if (strcasecmp(type, "string") == 0) return 's';
+    if (strcasecmp(type, "number") == 0) return 'n';
+    if (strcasecmp(type, "integer") == 0) return 'i';
+    if (strcasecmp(type, "boolean") == 0) return 'b';
+    if (strcasecmp(type, "object") == 0) return 'o';
+    if (strcasecmp(type, "array") == 0) return 'a';
+    return '*';
+}
+
+bool AI_API_Tool_Args::_matchesType(JsonVariantConst value, char typeCode) {
+    switch (typeCode) {
+        case 's': return value.is<const char*>();
+        case 'n': return value.is<double>();
+        case 'i':
+            // Accept whole numbers sent as floats (e.g. 3.0)
+            return value.is<long>() || (value.is<double>() && value.as<double>() == (double)(long)value.as<double>());
+        case 'b': return value.is<bool>();
+        case 'o': return value.is<JsonObjectConst>();
+        case 'a': return value.is<JsonArrayConst>();
+        default:  return true;
+    }
+}
+
+void AI_API_Tool_Args::buildSignature(const char* name, JsonObjectConst parameters, String& out) {
+    out += name;
+    out += '(';
+
+    JsonArrayConst required = parameters["required"];
+    bool first = true;
+    for (JsonPairConst kv : parameters["properties"].as<JsonObjectConst>()) {
+        if (!first) out += ',';
+        first = false;
+
+        out += kv.key().c_str();
+        out += ':';
+        out += _typeCode(kv.value()["type"].as<const char*>());
+
+        for (JsonVariantConst req : required) {
+            if (req == kv.key().c_str()) {
+                out += '!';
+                break;
+            }
+        }
+    }
+
+    out += ')';
+}
+
+bool AI_API_Tool_Args::signatureMatches(const char* signature, const char* name) {
+    if (signature == nullptr || name == nullptr) return false;
+    size_t len = strlen(name);
+    return strncmp(signature, name, len) == 0 && signature[len] == '(';
+}
+
+bool AI_API_Tool_Args::validate(JsonObjectConst args, const char* signature, String& errorMsg) {
+    const char* p = strchr(signature, '(');
+    if (p == nullptr) return true; // No parameter information - nothing to check
+    String toolName = String(signature).substring(0, p - signature);
+    p++;
+
+    while (*p != '\0' && *p != ')') {
+        // Entry format: name:T or name:T!
+        char argName[AI_API_TOOL_ARG_MAX_NAME_LEN];
+        size_t len = 0;
+        while (*p != '\0' && *p != ':') {
+            if (len < sizeof(argName) - 1) argName[len++] = *p;
+            p++;
+        }
+        argName[len] = '\0';
+        if (*p != ':') break;
+        p++;
+
+        char typeCode = *p;
+        if (typeCode != '\0') p++;
+        bool isRequired = (*p == '!');
+        if (isRequired) p++;
+        if (*p == ',') p++;
+
+        JsonVariantConst value = args[argName];
+        if (value.isNull()) {
+            if (isRequired) {
+                errorMsg = "Tool call '" + toolName + "' is missing required argument '" + String(argName) + "'";
+                return false;
+            }
+            continue;
+        }
+
+        if (!_matchesType(value, typeCode)) {
+            errorMsg = "Tool call '" + toolName + "' argument '" + String(argName) + "' has the wrong type";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool AI_API_Tool_Args::bind(JsonObjectConst args, const AI_API_Arg_Field* fields, int fieldCount, String& errorMsg) {
+    for (int i = 0; i < fieldCount; i++) {
+        const AI_API_Arg_Field& field = fields[i];
+        JsonVariantConst value = args[field.name];
+        if (value.isNull()) continue; // Optional argument not sent - keep the default
+
+        bool ok = true;
+        switch (field.type) {
+            case AI_API_Arg_Field::TYPE_CHARS: {
+                const char* str = value.as<const char*>();
+                if (str == nullptr || strlen(str) >= field.size) {
+                    ok = false;
+                    break;
+                }
+                strcpy((char*)field.target, str);
+                break;
+            }
+            case AI_API_Arg_Field::TYPE_STRING:
+                ok = value.is<const char*>();
+                if (ok) *(String*)field.target = value.as<const char*>();
+                break;
+            case AI_API_Arg_Field::TYPE_INT:
+                ok = _matchesType(value, 'i');
+                if (ok) *(int*)field.target = value.as<long>();
+                break;
+            case AI_API_Arg_Field::TYPE_LONG:
+                ok = _matchesType(value, 'i');
+                if (ok) *(long*)field.target = value.as<long>();
+                break;
+            case AI_API_Arg_Field::TYPE_FLOAT:
+                ok = value.is<double>();
+                if (ok) *(float*)field.target = value.as<float>();
+                break;
+            case AI_API_Arg_Field::TYPE_DOUBLE:
+                ok = value.is<double>();
+                if (ok) *(double*)field.target = value.as<double>();
+                break;
+            case AI_API_Arg_Field::TYPE_BOOL:
+                ok = value.is<bool>();
+                if (ok) *(bool*)field.target = value.as<bool>();
+                break;
+        }
+
+        if (!ok) {
+            errorMsg = "Tool call argument '" + String(field.name) + "' has the wrong type or does not fit";
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif // ENABLE_TOOL_CALLS
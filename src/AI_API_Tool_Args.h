@@ -0,0 +1,80 @@
+// ESP32_AI_Connect/AI_API_Tool_Args.h
+
+#ifndef AI_API_TOOL_ARGS_H
+#define AI_API_TOOL_ARGS_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+
+#ifdef ENABLE_TOOL_CALLS // Only compile this file's content if flag is set
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * AI_API_Arg_Field - Binds one tool call argument to a C++ variable
+ *
+ * Usage:
+ *   struct { char city[32]; int days = 1; bool alerts = false; } w;
+ *   AI_API_Arg_Field fields[] = {
+ *       AI_API_Arg_Field("city", w.city, sizeof(w.city)),
+ *       AI_API_Arg_Field("days", &w.days),
+ *       AI_API_Arg_Field("alerts", &w.alerts)
+ *   };
+ *   aiClient.tcBindToolArgs(call, fields, 3);
+ *
+ * Arguments missing from the call leave their variable untouched, so
+ * initialize optional fields with their defaults.
+ */
+class AI_API_Arg_Field {
+public:
+    enum Type { TYPE_CHARS, TYPE_STRING, TYPE_INT, TYPE_LONG, TYPE_FLOAT, TYPE_DOUBLE, TYPE_BOOL };
+
+    AI_API_Arg_Field(const char* name, char* buffer, size_t bufferSize)
+        : name(name), type(TYPE_CHARS), target(buffer), size(bufferSize) {}
+    AI_API_Arg_Field(const char* name, String* value) : name(name), type(TYPE_STRING), target(value), size(0) {}
+    AI_API_Arg_Field(const char* name, int* value) : name(name), type(TYPE_INT), target(value), size(0) {}
+    AI_API_Arg_Field(const char* name, long* value) : name(name), type(TYPE_LONG), target(value), size(0) {}
+    AI_API_Arg_Field(const char* name, float* value) : name(name), type(TYPE_FLOAT), target(value), size(0) {}
+    AI_API_Arg_Field(const char* name, double* value) : name(name), type(TYPE_DOUBLE), target(value), size(0) {}
+    AI_API_Arg_Field(const char* name, bool* value) : name(name), type(TYPE_BOOL), target(value), size(0) {}
+
+    const char* name;
+    Type type;
+    void* target;
+    size_t size; // Buffer size for TYPE_CHARS
+};
+
+/**
+ * AI_API_Tool_Args - Tool call argument validation and binding
+ *
+ * Tool parameters are summarized at setTCTools() time into a compact
+ * signature so arguments can be checked without touching the schema again:
+ *
+ *   get_weather(city:s!,unit:s,days:i)
+ *
+ * Type codes: s = string, n = number, i = integer, b = boolean,
+ * o = object, a = array, * = any. A trailing '!' marks a required argument.
+ */
+class AI_API_Tool_Args {
+public:
+    // Append the signature for tool 'name' with JSON schema 'parameters' to 'out'
+    static void buildSignature(const char* name, JsonObjectConst parameters, String& out);
+
+    // Returns true if 'signature' belongs to the tool called 'name'
+    static bool signatureMatches(const char* signature, const char* name);
+
+    // Check 'args' against 'signature' (required arguments present, types match)
+    // Returns false and sets errorMsg on the first violation
+    static bool validate(JsonObjectConst args, const char* signature, String& errorMsg);
+
+    // Copy arguments into the bound variables
+    // Returns false and sets errorMsg if an argument has the wrong type or does not fit
+    static bool bind(JsonObjectConst args, const AI_API_Arg_Field* fields, int fieldCount, String& errorMsg);
+
+private:
+    static char _typeCode(const char* type);
+    static bool _matchesType(JsonVariantConst value, char typeCode);
+};
+
+#endif // ENABLE_TOOL_CALLS
+#endif // AI_API_TOOL_ARGS_H
@@ -0,0 +1,367 @@
+// ESP32_AI_Connect/AI_API_Tool_Schema.h
+
+#ifndef AI_API_TOOL_SCHEMA_H
+#define AI_API_TOOL_SCHEMA_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+
+#ifdef ENABLE_TOOL_CALLS // Only compile this file's content if flag is set
+
+#include <stddef.h>
+#include "AI_API_Platform_Handler.h"
+
+/**
+ * AI_API_Tool_Schema - Compile-time tool definitions
+ *
+ * Declares tools with typed parameters and renders the JSON schema for every
+ * platform at compile time. The result lives in flash and is passed to
+ * setTCTools() as AI_API_Tool_Def entries, so tool calls requests no longer
+ * parse, convert or validate tool definitions at runtime.
+ *
+ * Usage:
+ *   using namespace AI_Tool_Schema;
+ *   static constexpr auto kWeatherTool = tool("get_weather", "Get the current weather for a city.",
+ *       required(stringParam("city", "The name of the city.")),
+ *       enumParam("unit", "Temperature unit.", "celsius", "fahrenheit"));
+ *
+ *   const AI_API_Tool_Def myTools[] = { kWeatherTool.def() };
+ *   aiClient.setTCTools(myTools, 1);
+ *
+ * Output per platform:
+ *   OpenAI/DeepSeek: {"type":"function","function":{"name":..,"description":..,"parameters":{..}}}
+ *   Claude:          {"name":..,"description":..,"input_schema":{..}}
+ *   Gemini:          {"name":..,"description":..,"parameters":{"type":"OBJECT",..}} (uppercase types)
+ *   Signature:       get_weather(city:s!,unit:s) for tool call validation (see AI_API_Tool_Args.h)
+ *
+ * Names, descriptions and enum values are copied verbatim, so they must not
+ * contain '"' or '\' characters.
+ *
+ * Written for C++11 (ESP32 Arduino core 2.x) - no C++14 features are used.
+ */
+namespace AI_Tool_Schema {
+
+// --- Index sequences (log-depth, C++11) ---
+template <size_t... I> struct IndexSeq {};
+
+template <class A, class B> struct JoinSeq;
+template <size_t... I, size_t... J>
+struct JoinSeq<IndexSeq<I...>, IndexSeq<J...> > {
+    typedef IndexSeq<I..., (sizeof...(I) + J)...> type;
+};
+
+template <size_t N> struct MakeIndexSeq {
+    typedef typename JoinSeq<typename MakeIndexSeq<N / 2>::type,
+                             typename MakeIndexSeq<N - N / 2>::type>::type type;
+};
+template <> struct MakeIndexSeq<0> { typedef IndexSeq<> type; };
+template <> struct MakeIndexSeq<1> { typedef IndexSeq<0> type; };
+
+// --- Fixed-size constexpr string (N characters plus terminator) ---
+template <size_t N> struct Str {
+    char c[N + 1];
+    static constexpr size_t length = N;
+    constexpr const char* c_str() const { return c; }
+};
+
+template <class... S> struct StrLen;
+template <> struct StrLen<> { static constexpr size_t value = 0; };
+template <size_t N, class... R> struct StrLen<Str<N>, R...> {
+    static constexpr size_t value = N + StrLen<R...>::value;
+};
+
+// Length of a string literal, usable in template arguments
+template <size_t M> constexpr size_t L(const char (&)[M]) { return M - 1; }
+
+template <size_t N, size_t... I>
+constexpr Str<N> strFromArray(const char (&s)[N + 1], IndexSeq<I...>) {
+    return Str<N>{{s[I]..., '\0'}};
+}
+
+// String literal -> Str
+template <size_t M>
+constexpr Str<M - 1> lit(const char (&s)[M]) {
+    return strFromArray<M - 1>(s, typename MakeIndexSeq<M - 1>::type());
+}
+
+template <size_t A, size_t B, size_t... I>
+constexpr Str<A + B> concatImpl(const Str<A>& a, const Str<B>& b, IndexSeq<I...>) {
+    return Str<A + B>{{(I < A ? a.c[I] : b.c[I - A])..., '\0'}};
+}
+
+template <size_t A, size_t B>
+constexpr Str<A + B> concat(const Str<A>& a, const Str<B>& b) {
+    return concatImpl(a, b, typename MakeIndexSeq<A + B>::type());
+}
+
+constexpr Str<0> cat() { return Str<0>{{'\0'}}; }
+
+template <size_t A>
+constexpr Str<A> cat(const Str<A>& a) { return a; }
+
+template <size_t A, size_t B, class... R>
+constexpr Str<StrLen<Str<A>, Str<B>, R...>::value> cat(const Str<A>& a, const Str<B>& b, const R&... rest) {
+    return cat(concat(a, b), rest...);
+}
+
+// Drops the leading character (used to remove the first separator of a joined list)
+template <size_t N> struct DropFirst {
+    template <size_t... I>
+    static constexpr Str<N - 1> apply(const Str<N>& s, IndexSeq<I...>) {
+        return Str<N - 1>{{s.c[I + 1]..., '\0'}};
+    }
+    static constexpr Str<N - 1> apply(const Str<N>& s) {
+        return apply(s, typename MakeIndexSeq<N - 1>::type());
+    }
+};
+template <> struct DropFirst<0> {
+    static constexpr Str<0> apply(const Str<0>& s) { return s; }
+};
+
+template <size_t N>
+constexpr Str<(N == 0 ? 0 : N - 1)> dropFirst(const Str<N>& s) { return DropFirst<N>::apply(s); }
+
+template <size_t N>
+constexpr Str<N + 2> quote(const Str<N>& s) { return cat(lit("\""), s, lit("\"")); }
+
+// --- Parameter types (lowercase for OpenAI/Claude JSON Schema, uppercase for Gemini) ---
+struct StringType {
+    static constexpr Str<6> lower() { return lit("string"); }
+    static constexpr Str<6> upper() { return lit("STRING"); }
+    static constexpr char code() { return 's'; } // Signature type code (see AI_API_Tool_Args.h)
+};
+struct NumberType {
+    static constexpr Str<6> lower() { return lit("number"); }
+    static constexpr Str<6> upper() { return lit("NUMBER"); }
+    static constexpr char code() { return 'n'; }
+};
+struct IntegerType {
+    static constexpr Str<7> lower() { return lit("integer"); }
+    static constexpr Str<7> upper() { return lit("INTEGER"); }
+    static constexpr char code() { return 'i'; }
+};
+struct BooleanType {
+    static constexpr Str<7> lower() { return lit("boolean"); }
+    static constexpr Str<7> upper() { return lit("BOOLEAN"); }
+    static constexpr char code() { return 'b'; }
+};
+
+// Length of one rendered property: "name":{"type":"T","description":"D"<extra>}
+template <size_t NN, size_t NT, size_t ND, size_t NE> struct PropLen {
+    static constexpr size_t value = (NN + 2) + L(":{\"type\":") + (NT + 2) +
+                                    L(",\"description\":") + (ND + 2) + NE + L("}");
+};
+
+template <size_t NN, size_t NT, size_t ND, size_t NE>
+constexpr Str<PropLen<NN, NT, ND, NE>::value> prop(const Str<NN>& name, const Str<NT>& type,
+                                                   const Str<ND>& desc, const Str<NE>& extra) {
+    return cat(quote(name), lit(":{\"type\":"), quote(type), lit(",\"description\":"), quote(desc), extra, lit("}"));
+}
+
+// One tool parameter, rendered for both type spellings
+template <bool Required, size_t NName, size_t NBody>
+struct Param {
+    Str<NName> name;
+    Str<NBody> lower; // "name":{"type":"string",...}
+    Str<NBody> upper; // "name":{"type":"STRING",...}
+    char code;        // Signature type code
+};
+
+template <bool R, size_t NN, size_t NT, size_t ND, size_t NE>
+constexpr Param<R, NN, PropLen<NN, NT, ND, NE>::value> makeParam(const Str<NN>& name, const Str<NT>& lowerType,
+                                                                 const Str<NT>& upperType, char code,
+                                                                 const Str<ND>& desc, const Str<NE>& extra) {
+    return Param<R, NN, PropLen<NN, NT, ND, NE>::value>{name, prop(name, lowerType, desc, extra),
+                                                        prop(name, upperType, desc, extra), code};
+}
+
+template <class T, size_t NN, size_t ND> struct ScalarParam {
+    typedef Param<false, NN - 1, PropLen<NN - 1, decltype(T::lower())::length, ND - 1, 0>::value> type;
+};
+
+// --- Parameter declarations ---
+template <size_t NN, size_t ND>
+constexpr typename ScalarParam<StringType, NN, ND>::type stringParam(const char (&name)[NN], const char (&desc)[ND]) {
+    return makeParam<false>(lit(name), StringType::lower(), StringType::upper(), StringType::code(), lit(desc), cat());
+}
+
+template <size_t NN, size_t ND>
+constexpr typename ScalarParam<NumberType, NN, ND>::type numberParam(const char (&name)[NN], const char (&desc)[ND]) {
+    return makeParam<false>(lit(name), NumberType::lower(), NumberType::upper(), NumberType::code(), lit(desc), cat());
+}
+
+template <size_t NN, size_t ND>
+constexpr typename ScalarParam<IntegerType, NN, ND>::type integerParam(const char (&name)[NN], const char (&desc)[ND]) {
+    return makeParam<false>(lit(name), IntegerType::lower(), IntegerType::upper(), IntegerType::code(), lit(desc), cat());
+}
+
+template <size_t NN, size_t ND>
+constexpr typename ScalarParam<BooleanType, NN, ND>::type booleanParam(const char (&name)[NN], const char (&desc)[ND]) {
+    return makeParam<false>(lit(name), BooleanType::lower(), BooleanType::upper(), BooleanType::code(), lit(desc), cat());
+}
+
+// ,"value" - one enum entry with its leading separator
+template <size_t K>
+constexpr Str<K + 2> enumItem(const char (&value)[K]) { return cat(lit(",\""), lit(value), lit("\"")); }
+
+template <size_t NN, size_t ND, size_t... K> struct EnumParam {
+    static constexpr size_t kExtraLen = L(",\"enum\":[") + StrLen<Str<K + 2>...>::value - 1 + L("]");
+    typedef Param<false, NN - 1, PropLen<NN - 1, 6, ND - 1, kExtraLen>::value> type;
+};
+
+// String parameter restricted to the listed values
+template <size_t NN, size_t ND, size_t... K>
+constexpr typename EnumParam<NN, ND, K...>::type enumParam(const char (&name)[NN], const char (&desc)[ND],
+                                                           const char (&... values)[K]) {
+    static_assert(sizeof...(K) > 0, "enumParam needs at least one value");
+    return makeParam<false>(lit(name), StringType::lower(), StringType::upper(), StringType::code(), lit(desc),
+                            cat(lit(",\"enum\":["), dropFirst(cat(enumItem(values)...)), lit("]")));
+}
+
+// Marks a parameter as required
+template <bool R, size_t NN, size_t NB>
+constexpr Param<true, NN, NB> required(const Param<R, NN, NB>& p) {
+    return Param<true, NN, NB>{p.name, p.lower, p.upper, p.code};
+}
+
+// --- Tool rendering ---
+template <size_t NN, size_t NB>
+constexpr Str<NB + 1> lowerItem(const Param<true, NN, NB>& p) { return concat(lit(","), p.lower); }
+template <size_t NN, size_t NB>
+constexpr Str<NB + 1> lowerItem(const Param<false, NN, NB>& p) { return concat(lit(","), p.lower); }
+template <size_t NN, size_t NB>
+constexpr Str<NB + 1> upperItem(const Param<true, NN, NB>& p) { return concat(lit(","), p.upper); }
+template <size_t NN, size_t NB>
+constexpr Str<NB + 1> upperItem(const Param<false, NN, NB>& p) { return concat(lit(","), p.upper); }
+
+// ,name:T! / ,name:T - one signature entry (see AI_API_Tool_Args.h)
+template <size_t NN, size_t NB>
+constexpr Str<NN + 4> signatureItem(const Param<true, NN, NB>& p) {
+    return cat(lit(","), p.name, Str<3>{{':', p.code, '!', '\0'}});
+}
+template <size_t NN, size_t NB>
+constexpr Str<NN + 3> signatureItem(const Param<false, NN, NB>& p) {
+    return cat(lit(","), p.name, Str<2>{{':', p.code, '\0'}});
+}
+
+// ,"name" for required parameters, nothing for optional ones
+template <size_t NN, size_t NB>
+constexpr Str<NN + 3> requiredItem(const Param<true, NN, NB>& p) { return cat(lit(",\""), p.name, lit("\"")); }
+template <size_t NN, size_t NB>
+constexpr Str<0> requiredItem(const Param<false, NN, NB>&) { return cat(); }
+
+// ,"required":[...] when at least one parameter is required
+template <bool HasItems> struct RequiredClause {
+    template <size_t N>
+    static constexpr Str<N + L(",\"required\":[") + L("]") - 1> apply(const Str<N>& items) {
+        return cat(lit(",\"required\":["), dropFirst(items), lit("]"));
+    }
+};
+template <> struct RequiredClause<false> {
+    static constexpr Str<0> apply(const Str<0>&) { return cat(); }
+};
+
+template <class... P>
+constexpr auto lowerProps(const P&... p) -> decltype(dropFirst(cat(lowerItem(p)...))) {
+    return dropFirst(cat(lowerItem(p)...));
+}
+
+template <class... P>
+constexpr auto upperProps(const P&... p) -> decltype(dropFirst(cat(upperItem(p)...))) {
+    return dropFirst(cat(upperItem(p)...));
+}
+
+template <class... P>
+constexpr auto requiredList(const P&... p)
+    -> decltype(RequiredClause<(decltype(cat(requiredItem(p)...))::length > 0)>::apply(cat(requiredItem(p)...))) {
+    return RequiredClause<(decltype(cat(requiredItem(p)...))::length > 0)>::apply(cat(requiredItem(p)...));
+}
+
+// {"type":"object","properties":{...},"required":[...]}
+template <class... P>
+constexpr auto objectSchema(const P&... p)
+    -> decltype(cat(lit("{\"type\":\"object\",\"properties\":{"), lowerProps(p...), lit("}"), requiredList(p...), lit("}"))) {
+    return cat(lit("{\"type\":\"object\",\"properties\":{"), lowerProps(p...), lit("}"), requiredList(p...), lit("}"));
+}
+
+// Gemini omits "parameters" entirely for tools without parameters
+template <bool HasParams> struct GeminiParameters {
+    template <class... P>
+    static constexpr auto apply(const P&... p)
+        -> decltype(cat(lit(",\"parameters\":{\"type\":\"OBJECT\",\"properties\":{"), upperProps(p...), lit("}"),
+                        requiredList(p...), lit("}"))) {
+        return cat(lit(",\"parameters\":{\"type\":\"OBJECT\",\"properties\":{"), upperProps(p...), lit("}"),
+                   requiredList(p...), lit("}"));
+    }
+};
+template <> struct GeminiParameters<false> {
+    static constexpr Str<0> apply() { return cat(); }
+};
+
+template <size_t NN, size_t ND, class... P>
+constexpr auto openaiTool(const Str<NN>& name, const Str<ND>& desc, const P&... p)
+    -> decltype(cat(lit("{\"type\":\"function\",\"function\":{\"name\":"), quote(name), lit(",\"description\":"),
+                    quote(desc), lit(",\"parameters\":"), objectSchema(p...), lit("}}"))) {
+    return cat(lit("{\"type\":\"function\",\"function\":{\"name\":"), quote(name), lit(",\"description\":"),
+               quote(desc), lit(",\"parameters\":"), objectSchema(p...), lit("}}"));
+}
+
+template <size_t NN, size_t ND, class... P>
+constexpr auto claudeTool(const Str<NN>& name, const Str<ND>& desc, const P&... p)
+    -> decltype(cat(lit("{\"name\":"), quote(name), lit(",\"description\":"), quote(desc),
+                    lit(",\"input_schema\":"), objectSchema(p...), lit("}"))) {
+    return cat(lit("{\"name\":"), quote(name), lit(",\"description\":"), quote(desc),
+               lit(",\"input_schema\":"), objectSchema(p...), lit("}"));
+}
+
+template <size_t NN, size_t ND, class... P>
+constexpr auto geminiTool(const Str<NN>& name, const Str<ND>& desc, const P&... p)
+    -> decltype(cat(lit("{\"name\":"), quote(name), lit(",\"description\":"), quote(desc),
+                    GeminiParameters<(sizeof...(P) > 0)>::apply(p...), lit("}"))) {
+    return cat(lit("{\"name\":"), quote(name), lit(",\"description\":"), quote(desc),
+               GeminiParameters<(sizeof...(P) > 0)>::apply(p...), lit("}"));
+}
+
+// name(arg:T!,...) used to validate tool call arguments
+template <size_t NN, class... P>
+constexpr auto toolSignature(const Str<NN>& name, const P&... p)
+    -> decltype(cat(name, lit("("), dropFirst(cat(signatureItem(p)...)), lit(")"))) {
+    return cat(name, lit("("), dropFirst(cat(signatureItem(p)...)), lit(")"));
+}
+
+// A complete tool: name, description and the schema for every platform
+template <size_t NName, size_t NDesc, size_t NOpenAI, size_t NClaude, size_t NGemini, size_t NSignature>
+struct Tool {
+    Str<NName> name;
+    Str<NDesc> description;
+    Str<NOpenAI> openai;
+    Str<NClaude> claude;
+    Str<NGemini> gemini;
+    Str<NSignature> signature;
+
+    // Flash-resident definition for setTCTools(); 'this' must have static storage duration
+    constexpr AI_API_Tool_Def def() const {
+        return AI_API_Tool_Def{name.c, description.c, openai.c, claude.c, gemini.c, signature.c};
+    }
+};
+
+template <size_t NN, size_t ND, class... P>
+constexpr auto tool(const char (&name)[NN], const char (&desc)[ND], const P&... p)
+    -> Tool<NN - 1, ND - 1,
+            decltype(openaiTool(lit(name), lit(desc), p...))::length,
+            decltype(claudeTool(lit(name), lit(desc), p...))::length,
+            decltype(geminiTool(lit(name), lit(desc), p...))::length,
+            decltype(toolSignature(lit(name), p...))::length> {
+    return Tool<NN - 1, ND - 1,
+                decltype(openaiTool(lit(name), lit(desc), p...))::length,
+                decltype(claudeTool(lit(name), lit(desc), p...))::length,
+                decltype(geminiTool(lit(name), lit(desc), p...))::length,
+                decltype(toolSignature(lit(name), p...))::length>{
+        lit(name), lit(desc), openaiTool(lit(name), lit(desc), p...),
+        claudeTool(lit(name), lit(desc), p...), geminiTool(lit(name), lit(desc), p...),
+        toolSignature(lit(name), p...)};
+}
+
+} // namespace AI_Tool_Schema
+
+#endif // ENABLE_TOOL_CALLS
+#endif // AI_API_TOOL_SCHEMA_H
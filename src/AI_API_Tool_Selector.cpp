@@ -0,0 +1,279 @@
+// ESP32_AI_Connect/AI_API_Tool_Selector.cpp
+
+#include "AI_API_Tool_Selector.h"
+
+#if defined(ENABLE_TOOL_CALLS) && defined(ENABLE_TOOL_SELECTION) // Only compile if both flags are set
+
+// Longest term kept for hashing; longer words are truncated
+#define AI_API_TOOL_SELECTION_MAX_TERM_LEN 24
+// Maximum number of distinct terms taken from a user message
+#define AI_API_TOOL_SELECTION_MAX_MSG_TERMS 64
+
+// Common words that carry no signal for tool selection
+static const char* const kStopWords[] = {
+    "the", "and", "for", "with", "what", "this", "that", "from", "are", "you",
+    "your", "get", "set", "can", "please", "about", "into", "has", "have", "was",
+    "will", "how", "its", "not", "but", "all", "any", "who", "when", "where"
+};
+
+AI_API_Tool_Selector::AI_API_Tool_Selector() {
+}
+
+AI_API_Tool_Selector::~AI_API_Tool_Selector() {
+    clear();
+}
+
+void AI_API_Tool_Selector::clear() {
+    delete[] _terms;
+    delete[] _weights;
+    delete[] _offsets;
+    delete[] _nameHashes;
+    delete[] _buildCounts;
+    _terms = nullptr;
+    _weights = nullptr;
+    _offsets = nullptr;
+    _nameHashes = nullptr;
+    _buildCounts = nullptr;
+    _toolCount = 0;
+}
+
+void AI_API_Tool_Selector::swap(AI_API_Tool_Selector& other) {
+    std::swap(_toolCount, other._toolCount);
+    std::swap(_terms, other._terms);
+    std::swap(_weights, other._weights);
+    std::swap(_offsets, other._offsets);
+    std::swap(_nameHashes, other._nameHashes);
+    std::swap(_buildCounts, other._buildCounts);
+}
+
+uint32_t AI_API_Tool_Selector::hashTerm(const char* str, size_t len) {
+    uint32_t hash = 2166136261UL; // FNV-1a offset basis
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)str[i];
+        hash *= 16777619UL;       // FNV-1a prime
+    }
+    return hash;
+}
+
+template <typename Fn>
+void AI_API_Tool_Selector::_forEachTerm(const char* text, Fn fn) {
+    if (text == nullptr) return;
+
+    char term[AI_API_TOOL_SELECTION_MAX_TERM_LEN];
+    size_t len = 0;
+    const char* p = text;
+
+    while (true) {
+        char c = *p;
+        bool isWordChar = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+
+        if (isWordChar) {
+            if (len < sizeof(term)) {
+                term[len++] = (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+            }
+        } else if (len > 0) {
+            // End of a word - normalize and emit it
+            size_t termLen = len;
+            len = 0;
+
+            // Naive plural folding so "cities" ~ "citie" and "lights" ~ "light" match their singular
+            if (termLen > 4 && term[termLen - 1] == 's' && term[termLen - 2] != 's') {
+                termLen--;
+            }
+
+            if (termLen >= 3) {
+                bool isStopWord = false;
+                for (size_t i = 0; i < sizeof(kStopWords) / sizeof(kStopWords[0]); i++) {
+                    if (strlen(kStopWords[i]) == termLen && strncmp(kStopWords[i], term, termLen) == 0) {
+                        isStopWord = true;
+                        break;
+                    }
+                }
+                if (!isStopWord) {
+                    fn(hashTerm(term, termLen));
+                }
+            }
+        }
+
+        if (c == '\0') break;
+        p++;
+    }
+}
+
+bool AI_API_Tool_Selector::beginIndex(int toolCount) {
+    clear();
+    if (toolCount <= 0) return true;
+
+    _terms = new uint32_t[toolCount * AI_API_TOOL_SELECTION_MAX_TERMS];
+    _weights = new uint8_t[toolCount * AI_API_TOOL_SELECTION_MAX_TERMS];
+    _offsets = new uint16_t[toolCount + 1];
+    _nameHashes = new uint32_t[toolCount];
+    _buildCounts = new uint16_t[toolCount];
+    if (!_terms || !_weights || !_offsets || !_nameHashes || !_buildCounts) {
+        clear();
+        return false;
+    }
+
+    for (int i = 0; i < toolCount; i++) {
+        _buildCounts[i] = 0;
+        _nameHashes[i] = 0;
+    }
+    _toolCount = toolCount;
+    return true;
+}
+
+void AI_API_Tool_Selector::_addTerms(int index, const char* text, uint8_t weight) {
+    uint32_t* toolTerms = _terms + index * AI_API_TOOL_SELECTION_MAX_TERMS;
+    uint8_t* toolWeights = _weights + index * AI_API_TOOL_SELECTION_MAX_TERMS;
+    uint16_t& count = _buildCounts[index];
+
+    _forEachTerm(text, [&](uint32_t hash) {
+        // Keep one entry per term with the highest weight seen
+        for (uint16_t i = 0; i < count; i++) {
+            if (toolTerms[i] == hash) {
+                if (toolWeights[i] < weight) toolWeights[i] = weight;
+                return;
+            }
+        }
+        if (count < AI_API_TOOL_SELECTION_MAX_TERMS) {
+            toolTerms[count] = hash;
+            toolWeights[count] = weight;
+            count++;
+        }
+    });
+}
+
+void AI_API_Tool_Selector::indexTool(int index, const char* name, const char* description, JsonArrayConst tags) {
+    if (index < 0 || index >= _toolCount || _buildCounts == nullptr) return;
+
+    if (name != nullptr) {
+        _nameHashes[index] = hashTerm(name, strlen(name));
+    }
+
+    // Name terms first so they survive the per-tool term limit
+    _addTerms(index, name, 3);
+    for (JsonVariantConst tag : tags) {
+        _addTerms(index, tag.as<const char*>(), 2);
+    }
+    _addTerms(index, description, 1);
+}
+
+void AI_API_Tool_Selector::endIndex() {
+    if (_buildCounts == nullptr) return;
+
+    // Compact the fixed-stride build buffers into exact-size arrays
+    uint16_t total = 0;
+    for (int i = 0; i < _toolCount; i++) {
+        total += _buildCounts[i];
+    }
+
+    uint32_t* terms = new uint32_t[total > 0 ? total : 1];
+    uint8_t* weights = new uint8_t[total > 0 ? total : 1];
+    if (!terms || !weights) {
+        // Keep the uncompacted layout rather than losing the index
+        delete[] terms;
+        delete[] weights;
+        for (int i = 0; i <= _toolCount; i++) {
+            _offsets[i] = i * AI_API_TOOL_SELECTION_MAX_TERMS;
+        }
+        return;
+    }
+
+    uint16_t pos = 0;
+    for (int i = 0; i < _toolCount; i++) {
+        _offsets[i] = pos;
+        memcpy(terms + pos, _terms + i * AI_API_TOOL_SELECTION_MAX_TERMS, _buildCounts[i] * sizeof(uint32_t));
+        memcpy(weights + pos, _weights + i * AI_API_TOOL_SELECTION_MAX_TERMS, _buildCounts[i]);
+        pos += _buildCounts[i];
+    }
+    _offsets[_toolCount] = pos;
+
+    delete[] _terms;
+    delete[] _weights;
+    delete[] _buildCounts;
+    _terms = terms;
+    _weights = weights;
+    _buildCounts = nullptr;
+}
+
+int AI_API_Tool_Selector::findTool(uint32_t nameHash) const {
+    if (_nameHashes == nullptr) return -1;
+    for (int t = 0; t < _toolCount; t++) {
+        if (_nameHashes[t] == nameHash) return t;
+    }
+    return -1;
+}
+
+int AI_API_Tool_Selector::selectTools(const String& message, int topK, int* outIndices, uint32_t forcedNameHash) const {
+    if (_toolCount == 0 || topK <= 0 || outIndices == nullptr || _buildCounts != nullptr) return 0;
+
+    // Collect distinct message terms
+    uint32_t msgTerms[AI_API_TOOL_SELECTION_MAX_MSG_TERMS];
+    int msgTermCount = 0;
+    _forEachTerm(message.c_str(), [&](uint32_t hash) {
+        for (int i = 0; i < msgTermCount; i++) {
+            if (msgTerms[i] == hash) return;
+        }
+        if (msgTermCount < AI_API_TOOL_SELECTION_MAX_MSG_TERMS) {
+            msgTerms[msgTermCount++] = hash;
+        }
+    });
+
+    // Score every tool
+    int* scores = new int[_toolCount];
+    if (scores == nullptr) return 0;
+
+    int bestScore = 0;
+    for (int t = 0; t < _toolCount; t++) {
+        int score = 0;
+        for (uint16_t i = _offsets[t]; i < _offsets[t + 1]; i++) {
+            for (int m = 0; m < msgTermCount; m++) {
+                if (_terms[i] == msgTerms[m]) {
+                    score += _weights[i];
+                    break;
+                }
+            }
+        }
+        scores[t] = score;
+        if (score > bestScore) bestScore = score;
+    }
+
+    if (bestScore == 0) {
+        delete[] scores;
+        return 0; // Nothing relevant - let the caller fall back to a fixed subset
+    }
+
+    // Forced tool (e.g. named by tool_choice) always takes a slot
+    int selected = 0;
+    int forcedIndex = forcedNameHash != 0 ? findTool(forcedNameHash) : -1;
+    if (forcedIndex >= 0) {
+        scores[forcedIndex] = -1; // Mark as taken
+        selected++;
+    }
+
+    // Pick the highest scoring remaining tools (ties keep the original order)
+    while (selected < topK) {
+        int bestIndex = -1;
+        for (int t = 0; t < _toolCount; t++) {
+            if (scores[t] > 0 && (bestIndex == -1 || scores[t] > scores[bestIndex])) {
+                bestIndex = t;
+            }
+        }
+        if (bestIndex == -1) break;
+        scores[bestIndex] = -1;
+        selected++;
+    }
+
+    // Emit indices in original order so the request stays stable across calls
+    int count = 0;
+    for (int t = 0; t < _toolCount; t++) {
+        if (scores[t] == -1) {
+            outIndices[count++] = t;
+        }
+    }
+
+    delete[] scores;
+    return count;
+}
+
+#endif // ENABLE_TOOL_CALLS && ENABLE_TOOL_SELECTION
@@ -0,0 +1,69 @@
+// ESP32_AI_Connect/AI_API_Tool_Selector.h
+
+#ifndef AI_API_TOOL_SELECTOR_H
+#define AI_API_TOOL_SELECTOR_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+
+#if defined(ENABLE_TOOL_CALLS) && defined(ENABLE_TOOL_SELECTION) // Only compile if both flags are set
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * AI_API_Tool_Selector - Relevance-based tool subset selection
+ *
+ * Keeps a compact keyword index of every tool registered with setTCTools().
+ * Each tool is reduced to a small set of hashed terms taken from its name,
+ * its optional "tags" array and its description. At request time the user
+ * message is tokenized the same way and every tool is scored by the weighted
+ * number of matching terms, so only the top-K tools need to be sent.
+ *
+ * Term weights: name = 3, tags = 2, description = 1.
+ */
+class AI_API_Tool_Selector {
+public:
+    AI_API_Tool_Selector();
+    ~AI_API_Tool_Selector();
+
+    // Start a new index for 'toolCount' tools (drops any previous index)
+    bool beginIndex(int toolCount);
+    // Add the keyword signature for tool 'index' (call once per tool, in order)
+    void indexTool(int index, const char* name, const char* description, JsonArrayConst tags);
+    // Compact the index once all tools were added
+    void endIndex();
+
+    // Exchange contents with another selector (used to commit a validated index)
+    void swap(AI_API_Tool_Selector& other);
+    void clear();
+
+    // Select up to 'topK' tools for 'message'.
+    // Writes selected tool indices into 'outIndices' (ascending, original order) and returns the count.
+    // The tool whose name hashes to 'forcedNameHash' (if non-zero) is always included.
+    // Returns 0 when no tool matched any term - callers then fall back to a fixed subset.
+    int selectTools(const String& message, int topK, int* outIndices, uint32_t forcedNameHash = 0) const;
+
+    int getToolCount() const { return _toolCount; }
+    // Index of the tool whose name hashes to 'nameHash', -1 if there is none
+    int findTool(uint32_t nameHash) const;
+
+    // FNV-1a hash used for all terms (exposed so callers can hash forced tool names)
+    static uint32_t hashTerm(const char* str, size_t len);
+
+private:
+    int _toolCount = 0;
+    uint32_t* _terms = nullptr;      // Term hashes for all tools, tool i in [_offsets[i], _offsets[i+1])
+    uint8_t* _weights = nullptr;     // Weight of each term
+    uint16_t* _offsets = nullptr;    // _toolCount + 1 entries
+    uint32_t* _nameHashes = nullptr; // Hash of each full tool name
+    uint16_t* _buildCounts = nullptr; // Per-tool term counts while the index is being built
+
+    // Append the terms of 'text' for tool 'index' with 'weight' (keeps the highest weight per term)
+    void _addTerms(int index, const char* text, uint8_t weight);
+    // Call 'fn(hash)' for every normalized term in 'text'
+    template <typename Fn>
+    static void _forEachTerm(const char* text, Fn fn);
+};
+
+#endif // ENABLE_TOOL_CALLS && ENABLE_TOOL_SELECTION
+#endif // AI_API_TOOL_SELECTOR_H
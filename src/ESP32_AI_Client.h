@@ -0,0 +1,221 @@
+// ESP32_AI_Connect/ESP32_AI_Client.h
+
+#ifndef ESP32_AI_CLIENT_H
+#define ESP32_AI_CLIENT_H
+
+#include "ESP32_AI_Connect_config.h" // Include config first
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include <HTTPClient.h>
+#include <ArduinoJson.h>
+#include "AI_API_Platform_Handler.h"
+#include "AI_API_Chat_Session.h"
+#include "AI_API_Memory.h"
+#include "AI_API_Timeouts.h"
+
+#ifdef USE_AI_API_OPENAI
+#include "AI_API_OpenAI.h"
+#endif
+#ifdef USE_AI_API_GEMINI
+#include "AI_API_Gemini.h"
+#endif
+#ifdef USE_AI_API_DEEPSEEK
+#include "AI_API_DeepSeek.h"
+#endif
+#ifdef USE_AI_API_CLAUDE
+#include "AI_API_Claude.h"
+#endif
+
+/**
+ * ESP32_AI_Client - Single-platform chat client bound to its handler at compile time
+ *
+ * For products that only ever talk to one provider. The handler is a member
+ * (no heap allocation, no registry lookup) and every handler call is a
+ * qualified, non-virtual call the compiler can inline. Handlers of other
+ * platforms are never referenced, so the linker drops their code even when
+ * their USE_AI_API_* flags stay enabled.
+ *
+ * Usage:
+ *   ESP32_AI_Client<AI_API_OpenAI_Handler> aiClient(apiKey, "gpt-4o-mini");
+ *   aiClient.setChatSystemRole("You are a helpful assistant.");
+ *   String reply = aiClient.chat("Hello!");
+ *
+ * Covers chat() with the same request settings and results as
+ * ESP32_AI_Connect; use ESP32_AI_Connect for tool calls, streaming,
+ * platform switching and the other optional features.
+ *
+ * The request is sent like a single ESP32_AI_Connect::chat() attempt with
+ * the same connect, TLS and first-byte budgets (AI_API_Timeouts). What
+ * ESP32_AI_Connect adds around that attempt is left out on purpose: the
+ * request deadline, retries, failover/hedging, keep-alive, the DNS cache,
+ * compression, cancel tokens, single-flight, the response cache and the
+ * rate limiter. examples/single_platform_client builds with either client
+ * for comparing their flash and RAM use.
+ */
+template <typename Handler>
+class ESP32_AI_Client {
+public:
+    ESP32_AI_Client(const char* apiKey, const char* modelName, const char* endpointUrl = nullptr) {
+        _wifiClient.setInsecure();
+        begin(apiKey, modelName, endpointUrl);
+    }
+
+    // Change key/model/endpoint (the platform is fixed by the template argument)
+    void begin(const char* apiKey, const char* modelName, const char* endpointUrl = nullptr) {
+        _apiKey = apiKey;
+        _modelName = modelName;
+        _customEndpoint = endpointUrl ? endpointUrl : "";
+        _lastError = "";
+    }
+
+    // Configuration methods for chat requests (same meaning as in ESP32_AI_Connect)
+    void setChatSystemRole(const char* systemRole) { _systemRole = systemRole; }
+    void setChatTemperature(float temperature) { _temperature = constrain(temperature, 0.0, 2.0); }
+    void setChatMaxTokens(int maxTokens) { _maxTokens = max(1, maxTokens); }
+    // Custom parameters in JSON format, e.g. {"top_p": 0.9}; returns false if the JSON is invalid
+    bool setChatParameters(const String& userParameterJsonStr) {
+        if (!userParameterJsonStr.isEmpty()) {
+            AI_API_Json_Document tempDoc; // Temporary document for validation
+            DeserializationError error = deserializeJson(tempDoc, userParameterJsonStr);
+            if (error) {
+                _lastError = "Invalid JSON in custom parameters: " + String(error.c_str());
+                return false;
+            }
+        }
+        _chatCustomParams = userParameterJsonStr;
+        return true;
+    }
+
+    String getChatSystemRole() const { return _systemRole; }
+    float getChatTemperature() const { return _temperature; }
+    int getChatMaxTokens() const { return _maxTokens; }
+    String getChatParameters() const { return _chatCustomParams; }
+
+    // Time budgets of each request phase (same meaning as ESP32_AI_Connect::setTimeouts());
+    // 0 keeps a budget unchanged
+    void setTimeouts(uint32_t connectMs, uint32_t tlsMs, uint32_t firstByteMs) {
+        if (connectMs > 0) _connectTimeoutMs = connectMs;
+        if (tlsMs > 0) _tlsTimeoutMs = tlsMs;
+        if (firstByteMs > 0) _firstByteTimeoutMs = min(firstByteMs, (uint32_t)65535); // HTTPClient limit
+    }
+    uint32_t getConnectTimeout() const { return _connectTimeoutMs; }
+    uint32_t getTlsTimeout() const { return _tlsTimeoutMs; }
+    uint32_t getFirstByteTimeout() const { return _firstByteTimeoutMs; }
+
+    String chat(const String& userMessage) { return _chat(userMessage, nullptr); }
+#ifdef ENABLE_CHAT_SESSION
+    // Multi-turn chat: sends the session history and appends the completed exchange to it
+    String chat(const String& userMessage, AI_API_Chat_Session& session) {
+        String responseContent = _chat(userMessage, &session);
+        if (!responseContent.isEmpty()) {
+            session.addUserTurn(userMessage);
+            session.addAssistantTurn(responseContent);
+        }
+        return responseContent;
+    }
+#endif
+
+    // Results of the last request
+    String getChatRawResponse() const { return _chatRawResponse; }
+    int getChatResponseCode() const { return _chatResponseCode; }
+    String getLastError() const { return _lastError; }
+    int getTotalTokens() const { return _handler.Handler::getTotalTokens(); }
+    int getPromptTokens() const { return _handler.Handler::getPromptTokens(); }
+    String getFinishReason() const { return _handler.Handler::getFinishReason(); }
+
+    // Direct access to the platform handler
+    Handler& getHandler() { return _handler; }
+
+private:
+    Handler _handler; // Embedded: bound at compile time, never allocated
+
+    String _apiKey;
+    String _modelName;
+    String _customEndpoint;
+    String _systemRole = "";
+    float _temperature = -1.0; // Use API default
+    int _maxTokens = -1;       // Use API default
+    String _chatCustomParams = "";
+    uint32_t _connectTimeoutMs = AI_API_CONNECT_TIMEOUT_MS;
+    uint32_t _tlsTimeoutMs = AI_API_TLS_TIMEOUT_MS;
+    uint32_t _firstByteTimeoutMs = AI_API_HTTP_TIMEOUT_MS;
+
+    String _chatRawResponse = "";
+    int _chatResponseCode = 0;
+    String _lastError = "";
+
+    WiFiClientSecure _wifiClient;
+    HTTPClient _httpClient;
+    AI_API_Json_Document _reqDoc;
+    AI_API_Json_Document _respDoc;
+
+    // One ESP32_AI_Connect::chat() attempt (see the class comment for what is left out);
+    // Handler:: qualification skips the vtable
+    String _chat(const String& userMessage, const AI_API_Chat_Session* session) {
+        _lastError = "";
+        _chatRawResponse = "";
+        _chatResponseCode = 0;
+
+        String url = _handler.Handler::getEndpoint(_modelName, _apiKey, _customEndpoint);
+        if (url.isEmpty()) {
+            _lastError = "Failed to get endpoint URL from platform handler.";
+            return "";
+        }
+
+        String requestBody = _handler.Handler::buildRequestBody(_modelName, _systemRole,
+                                                                _temperature, _maxTokens,
+                                                                userMessage, _reqDoc, _chatCustomParams,
+                                                                session);
+        if (requestBody.isEmpty()) {
+            if (_lastError.isEmpty()) _lastError = "Failed to build request body (handler returned empty).";
+            return "";
+        }
+        #ifdef ENABLE_DEBUG_OUTPUT
+        Serial.println("---------- AI Request ----------");
+        Serial.println("URL: " + url);
+        Serial.println("Body: " + requestBody);
+        Serial.println("-------------------------------");
+        #endif
+
+        String responseContent = "";
+        _httpClient.end(); // Ensure previous connection is closed
+        if (_httpClient.begin(_wifiClient, url)) {
+            _handler.Handler::setHeaders(_httpClient, _apiKey);
+            AI_API_Timeouts::apply(_httpClient, _wifiClient, _connectTimeoutMs, _tlsTimeoutMs, _firstByteTimeoutMs);
+            int httpCode = _httpClient.POST(requestBody);
+            _chatResponseCode = httpCode;
+
+            if (httpCode > 0) {
+                _chatRawResponse = _httpClient.getString();
+                #ifdef ENABLE_DEBUG_OUTPUT
+                Serial.println("---------- AI Response ----------");
+                Serial.println("HTTP Code: " + String(httpCode));
+                Serial.println("Payload: " + _chatRawResponse);
+                Serial.println("--------------------------------");
+                #endif
+
+                if (httpCode == HTTP_CODE_OK) {
+                    responseContent = _handler.Handler::parseResponseBody(_chatRawResponse, _lastError, _respDoc);
+                    if (responseContent.isEmpty() && _lastError.isEmpty()) {
+                        _lastError = "Handler failed to parse response or returned empty content.";
+                    }
+                } else {
+                    _lastError = "HTTP Error: " + String(httpCode) + " - Response: " + _chatRawResponse;
+                }
+            } else {
+                _lastError = String("HTTP Request Failed: ") + _httpClient.errorToString(httpCode).c_str();
+            }
+            _httpClient.end();
+        } else {
+            _lastError = "HTTP Client failed to begin connection to: " + url;
+        }
+        return responseContent;
+    }
+
+    // Copying would share the connection objects
+    ESP32_AI_Client(const ESP32_AI_Client&);
+    ESP32_AI_Client& operator=(const ESP32_AI_Client&);
+};
+
+#endif // ESP32_AI_CLIENT_H
@@ -1,17 +1,104 @@
 #include "ESP32_AI_Connect.h"
 
+#ifdef ENABLE_SINGLE_FLIGHT
+// Holds the request mutex for the rest of the enclosing scope. Waits at most 'wait'
+// ticks for it; held() tells whether it was taken.
+class AI_API_Request_Lock {
+public:
+    explicit AI_API_Request_Lock(SemaphoreHandle_t& mutex, TickType_t wait = portMAX_DELAY) : _mutex(mutex) {
+        #ifdef ENABLE_LAZY_ALLOCATION
+        _mutex = AI_API_Lazy_Mutex::get(mutex);
+        #endif
+        if (_mutex != nullptr && xSemaphoreTake(_mutex, wait) != pdTRUE) _held = false;
+    }
+    ~AI_API_Request_Lock() {
+        if (_mutex != nullptr && _held) xSemaphoreGive(_mutex);
+    }
+    bool held() const { return _held; }
+private:
+    SemaphoreHandle_t _mutex;
+    bool _held = true;
+};
+#endif
+
+#ifdef ENABLE_CANCELLATION
+// Lets the cancel token abort the client's connection for the rest of the enclosing scope
+class AI_API_Cancel_Scope {
+public:
+    AI_API_Cancel_Scope(AI_API_Cancel_Token* token, AI_API_Race_Client& client) : _token(token), _client(client) {
+        _client.setCancelToken(_token);
+    }
+    ~AI_API_Cancel_Scope() {
+        _client.setCancelToken(nullptr);
+        if (_token != nullptr) _token->detach();
+    }
+private:
+    AI_API_Cancel_Token* _token;
+    AI_API_Race_Client& _client;
+};
+#endif
+
+#ifdef ENABLE_HEDGING
+#include <freertos/task.h>
+
+// State shared by a hedged chat() call and its hedge task
+struct ESP32_AI_Connect::HedgeRace {
+    enum Winner { NONE, PRIMARY, HEDGE };
+
+    // Hedge request, copied by the caller so the task never reads the client
+    AI_API_Platform_Handler* handler = nullptr; // Borrowed; the caller waits for 'finished'
+    String url;
+    String apiKey;
+    String requestBody;
+    uint32_t delayMs = 0;
+    uint32_t connectMs = 0;
+    uint32_t tlsMs = 0;
+    uint32_t firstByteMs = 0;
+    uint32_t deadlineMs = UINT32_MAX;        // Time left before the request deadline at startedAt
+    uint32_t startedAt = 0;
+#ifdef ENABLE_CANCELLATION
+    const AI_API_Cancel_Token* cancelToken = nullptr;
+#endif
+
+    SemaphoreHandle_t lock;                  // Guards winner, primaryFailed and hedgeSent
+    SemaphoreHandle_t go;                    // Given once the primary answered or failed
+    SemaphoreHandle_t finished;              // Given by the hedge task when it is done with the race
+    Winner winner = NONE;
+    bool primaryFailed = false;
+    bool hedgeSent = false;
+    volatile bool primaryLost = false;       // The hedge won: the primary connection gives up
+    volatile bool hedgeLost = false;         // The primary won: the hedge connection gives up
+
+    // Hedge result, read by the caller once 'finished' was given
+    int responseCode = 0;
+    String content;
+    String rawResponse;
+    String error;
+    uint32_t ttfbMs = 0;
+    uint32_t totalMs = 0;
+};
+#endif
+
 // Constructor
 ESP32_AI_Connect::ESP32_AI_Connect(const char* platformIdentifier, const char* apiKey, const char* modelName) {
     // Set insecure client - consider making this configurable
     _wifiClient.setInsecure();
     
-#ifdef ENABLE_STREAM_CHAT
+#if defined(ENABLE_STREAM_CHAT) && !defined(ENABLE_LAZY_ALLOCATION) // Else created on first use
     // Initialize FreeRTOS mutex for thread safety
     _streamMutex = xSemaphoreCreateMutex();
     if (_streamMutex == nullptr) {
         Serial.println("ERROR: Failed to create stream mutex");
     }
 #endif
+
+#if defined(ENABLE_SINGLE_FLIGHT) && !defined(ENABLE_LAZY_ALLOCATION) // Else created on first use
+    // Serializes requests from different tasks (shared JSON documents and HTTP client)
+    _requestMutex = xSemaphoreCreateMutex();
+    if (_requestMutex == nullptr) {
+        Serial.println("ERROR: Failed to create request mutex");
+    }
+#endif
     
     begin(platformIdentifier, apiKey, modelName); // Call helper to initialize
 }
@@ -21,13 +108,21 @@ ESP32_AI_Connect::ESP32_AI_Connect(const char* platformIdentifier, const char* a
     // Set insecure client - consider making this configurable
     _wifiClient.setInsecure();
     
-#ifdef ENABLE_STREAM_CHAT
+#if defined(ENABLE_STREAM_CHAT) && !defined(ENABLE_LAZY_ALLOCATION) // Else created on first use
     // Initialize FreeRTOS mutex for thread safety
     _streamMutex = xSemaphoreCreateMutex();
     if (_streamMutex == nullptr) {
         Serial.println("ERROR: Failed to create stream mutex");
     }
 #endif
+
+#if defined(ENABLE_SINGLE_FLIGHT) && !defined(ENABLE_LAZY_ALLOCATION) // Else created on first use
+    // Serializes requests from different tasks (shared JSON documents and HTTP client)
+    _requestMutex = xSemaphoreCreateMutex();
+    if (_requestMutex == nullptr) {
+        Serial.println("ERROR: Failed to create request mutex");
+    }
+#endif
     
     begin(platformIdentifier, apiKey, modelName, endpointUrl); // Call helper to initialize
 }
@@ -35,6 +130,9 @@ ESP32_AI_Connect::ESP32_AI_Connect(const char* platformIdentifier, const char* a
 // Destructor
 ESP32_AI_Connect::~ESP32_AI_Connect() {
     _cleanupHandler();
+#ifdef ENABLE_FAILOVER
+    clearFailoverTargets();
+#endif
     
 #ifdef ENABLE_TOOL_CALLS
     // Clean up tool calls array if allocated
@@ -43,9 +141,18 @@ ESP32_AI_Connect::~ESP32_AI_Connect() {
         _tcToolsArray = nullptr;
         _tcToolsArraySize = 0;
     }
+    delete[] _tcToolSignatures;
+    _tcToolSignatures = nullptr;
     
     // Reset tool calls conversation history
     tcChatReset();
+    
+#ifdef ENABLE_TOOL_SELECTION
+    delete[] _tcSelectedTools;
+    _tcSelectedTools = nullptr;
+    delete[] _tcSelectedToolDefs;
+    _tcSelectedToolDefs = nullptr;
+#endif
 #endif
 
 #ifdef ENABLE_STREAM_CHAT
@@ -55,14 +162,52 @@ ESP32_AI_Connect::~ESP32_AI_Connect() {
         _streamMutex = nullptr;
     }
 #endif
+
+#ifdef ENABLE_SINGLE_FLIGHT
+    if (_requestMutex != nullptr) {
+        vSemaphoreDelete(_requestMutex);
+        _requestMutex = nullptr;
+    }
+#endif
 }
 
 // Cleanup helper
 void ESP32_AI_Connect::_cleanupHandler() {
-    delete _platformHandler;
+    for (int i = 0; i < _handlerCacheCount; i++) {
+        delete _handlerCache[i].handler;
+        _handlerCache[i].handler = nullptr;
+    }
+    _handlerCacheCount = 0;
     _platformHandler = nullptr;
 }
 
+// Handler for a lowercase platform identifier, reused from earlier begin() calls when possible
+AI_API_Platform_Handler* ESP32_AI_Connect::_acquireHandler(const String& platformStr) {
+    uint32_t id = AI_API_Handler_Registry::hash(platformStr.c_str());
+    for (int i = 0; i < _handlerCacheCount; i++) {
+        if (_handlerCache[i].id == id) {
+            _handlerCache[i].handler->reset(); // No token counts etc. from its last use
+            return _handlerCache[i].handler;
+        }
+    }
+
+    AI_API_Platform_Handler* handler = AI_API_Handler_Registry::create(platformStr);
+    if (handler == nullptr) return nullptr;
+
+    int slot;
+    if (_handlerCacheCount < AI_API_HANDLER_CACHE_SIZE) {
+        slot = _handlerCacheCount++;
+    } else {
+        // Cache full: replace entries in turn
+        slot = _handlerCacheNext;
+        _handlerCacheNext = (_handlerCacheNext + 1) % AI_API_HANDLER_CACHE_SIZE;
+        delete _handlerCache[slot].handler;
+    }
+    _handlerCache[slot].id = id;
+    _handlerCache[slot].handler = handler;
+    return handler;
+}
+
 // Initialization / Re-initialization logic
 bool ESP32_AI_Connect::begin(const char* platformIdentifier, const char* apiKey, const char* modelName) {
     return begin(platformIdentifier, apiKey, modelName, nullptr);
@@ -75,43 +220,34 @@ bool ESP32_AI_Connect::begin(const char* platformIdentifier, const char* apiKey,
     _customEndpoint = endpointUrl ? endpointUrl : "";  // Store custom endpoint if provided
     _lastError = "";
 
-    _cleanupHandler(); // Delete previous handler if any
+    _platformHandler = nullptr; // Previous handler stays cached for a later switch back
 
     String platformStr = platformIdentifier;
     platformStr.toLowerCase(); // Case-insensitive comparison
 
-    // --- Conditionally Create Platform Handler Instance ---
-    #ifdef USE_AI_API_OPENAI
-    if (platformStr == "openai" || platformStr == "openai-compatible") {
-        _platformHandler = new AI_API_OpenAI_Handler();
-    } else
-    #endif
-
-    #ifdef USE_AI_API_GEMINI
-    if (platformStr == "gemini") {
-        _platformHandler = new AI_API_Gemini_Handler(); 
-    } else
+    #ifdef ENABLE_TOKEN_ESTIMATOR
+    _tokenEstimator.setPlatform(platformStr); // Tokenizer defaults; calibration starts over
     #endif
 
-    #ifdef USE_AI_API_DEEPSEEK
-    if (platformStr == "deepseek") {
-        _platformHandler = new AI_API_DeepSeek_Handler();
-    } else
-    #endif
+    _platformHandler = _acquireHandler(platformStr);
+#ifdef ENABLE_SINGLE_FLIGHT
+    _chatFlightTarget = _platformHandler != nullptr ?
+        _targetKey(_platformHandler->getEndpoint(_modelName, _apiKey, _customEndpoint)) : 0;
+#endif
+    if (_platformHandler == nullptr) {
+        _lastError = "Platform '" + String(platformIdentifier) + "' is not registered (built-in platforms must be enabled in ESP32_AI_Connect_config.h)";
+        Serial.println("ERROR: " + _lastError);
+        return false; // Indicate failure
+    }
 
-    #ifdef USE_AI_API_CLAUDE
-    if (platformStr == "claude") {
-        _platformHandler = new AI_API_Claude_Handler();
-    } else
-    #endif
+#ifdef ENABLE_FAILOVER
+    _targetHealth[0] = TargetHealth(); // New primary target starts healthy
+#ifdef ENABLE_LATENCY_ROUTING
+    _targetLatency[0].reset();
+#endif
+#endif
 
-    { // Default case if no match found or platform not compiled
-        if (_platformHandler == nullptr) { // Only set error if no handler was created
-             _lastError = "Platform '" + String(platformIdentifier) + "' is not supported or not enabled in ESP32_AI_Connect_config.h";
-             Serial.println("ERROR: " + _lastError);
-             return false; // Indicate failure
-        }
-    }
+    _platformHandler->setPromptCaching(_promptCaching, _promptCacheKey);
 
     return true; // Indicate success
 }
@@ -150,7 +286,7 @@ bool ESP32_AI_Connect::setChatParameters(String userParameterJsonStr) {
     }
     
     // Validate JSON format
-    DynamicJsonDocument tempDoc(512); // Temporary document for validation
+    AI_API_Json_Document tempDoc; // Temporary document for validation
     DeserializationError error = deserializeJson(tempDoc, userParameterJsonStr);
     
     if (error) {
@@ -168,6 +304,315 @@ String ESP32_AI_Connect::getChatParameters() const {
     return _chatCustomParams;
 }
 
+// --- Timeouts ---
+void ESP32_AI_Connect::setTimeouts(uint32_t connectMs, uint32_t tlsMs, uint32_t firstByteMs, uint32_t chunkMs) {
+    if (connectMs > 0) _connectTimeoutMs = connectMs;
+    if (tlsMs > 0) _tlsTimeoutMs = tlsMs;
+    if (firstByteMs > 0) _firstByteTimeoutMs = min(firstByteMs, (uint32_t)65535); // HTTPClient limit
+    if (chunkMs > 0) _chunkTimeoutMs = chunkMs;
+}
+
+uint32_t ESP32_AI_Connect::getConnectTimeout() const {
+    return _connectTimeoutMs;
+}
+
+uint32_t ESP32_AI_Connect::getTlsTimeout() const {
+    return _tlsTimeoutMs;
+}
+
+uint32_t ESP32_AI_Connect::getFirstByteTimeout() const {
+    return _firstByteTimeoutMs;
+}
+
+uint32_t ESP32_AI_Connect::getChunkTimeout() const {
+    return _chunkTimeoutMs;
+}
+
+void ESP32_AI_Connect::setRequestDeadline(uint32_t deadlineMs) {
+    _requestDeadlineMs = deadlineMs;
+}
+
+uint32_t ESP32_AI_Connect::getRequestDeadline() const {
+    return _requestDeadlineMs;
+}
+
+ESP32_AI_Connect::TimeoutPhase ESP32_AI_Connect::getLastTimeoutPhase() const {
+    return _lastTimeoutPhase;
+}
+
+const char* ESP32_AI_Connect::getTimeoutPhaseName(TimeoutPhase phase) {
+    switch (phase) {
+        case TimeoutPhase::CONNECT: return "connect";
+        case TimeoutPhase::TLS: return "TLS handshake";
+        case TimeoutPhase::FIRST_BYTE: return "first byte";
+        case TimeoutPhase::CHUNK: return "stream chunk";
+        case TimeoutPhase::DEADLINE: return "request deadline";
+        default: return "none";
+    }
+}
+
+// "host:port" of an endpoint URL
+static String endpointHost(const String& url) {
+    int hostStart = url.indexOf("://");
+    bool secure = url.startsWith("https");
+    hostStart = hostStart < 0 ? 0 : hostStart + 3;
+    int hostEnd = url.indexOf('/', hostStart);
+    String host = url.substring(hostStart, hostEnd < 0 ? url.length() : hostEnd);
+    if (host.indexOf(':') < 0) host += secure ? ":443" : ":80";
+    return host;
+}
+
+// --- Connection Reuse ---
+bool ESP32_AI_Connect::warmup(uint32_t idleMs) {
+    _lastError = "";
+    if (!_platformHandler) {
+        _lastError = "Platform handler not initialized. Call begin() with a supported platform.";
+        return false;
+    }
+    String url = _platformHandler->getEndpoint(_modelName, _apiKey, _customEndpoint);
+    if (url.isEmpty()) {
+        _lastError = "Failed to get endpoint URL from platform handler.";
+        return false;
+    }
+#ifdef ENABLE_SINGLE_FLIGHT
+    AI_API_Request_Lock requestLock(_requestMutex);
+#endif
+    _prepareConnection(url);
+    String host = endpointHost(url);
+    if (!_wifiClient.connected()) {
+        int colon = host.lastIndexOf(':');
+        _startRequest(); // Timeouts only; a warmup has no deadline of its own
+        _applyTimeouts(_httpClient, _wifiClient);
+        uint32_t startedAt = millis();
+        bool connected = false;
+#ifdef ENABLE_DNS_CACHE
+        connected = _connectCached(host) && _wifiClient.connected();
+#endif
+        if (!connected && !_wifiClient.connect(host.substring(0, colon).c_str(), host.substring(colon + 1).toInt(),
+                                               _connectTimeoutMs)) {
+            _recordTimeout(HTTPC_ERROR_CONNECTION_REFUSED, millis() - startedAt);
+            _lastError = "Warmup failed to connect to " + host;
+            if (_lastTimeoutPhase != TimeoutPhase::NONE) {
+                _lastError += String(" (") + getTimeoutPhaseName(_lastTimeoutPhase) + " timeout)";
+            }
+            return false;
+        }
+        #ifdef ENABLE_DEBUG_OUTPUT
+        Serial.println("Warmup: connected to " + host + " in " + String(millis() - startedAt) + " ms");
+        #endif
+    }
+    _connHost = host;
+    _connUsedAt = millis();
+    _connIdleMs = idleMs > 0 ? idleMs : (_keepAliveMs > 0 ? _keepAliveMs : AI_API_WARMUP_HOLD_MS);
+    return true;
+}
+
+void ESP32_AI_Connect::setKeepAlive(uint32_t idleMs) {
+    _keepAliveMs = idleMs;
+}
+
+uint32_t ESP32_AI_Connect::getKeepAlive() const {
+    return _keepAliveMs;
+}
+
+void ESP32_AI_Connect::closeConnection() {
+#ifdef ENABLE_SINGLE_FLIGHT
+    AI_API_Request_Lock requestLock(_requestMutex);
+#endif
+    _httpClient.end();
+    _wifiClient.stop();
+    _connHost = "";
+}
+
+bool ESP32_AI_Connect::wasLastConnectionWarm() const {
+    return _lastConnectionWarm;
+}
+
+const AI_API_Memory_Usage& ESP32_AI_Connect::getLastMemoryUsage() const {
+    return _memoryUsage;
+}
+
+uint32_t ESP32_AI_Connect::getJsonOverflowCount() const {
+    return _jsonOverflows;
+}
+
+bool ESP32_AI_Connect::_requestOverflowed() {
+    if (!_reqDoc.overflowed()) return false;
+    _jsonOverflows++;
+    _lastError = "Request JSON ran out of memory.";
+    return true;
+}
+
+bool ESP32_AI_Connect::_responseOverflowed() {
+    if (!_respDoc.overflowed()) return false;
+    _jsonOverflows++;
+    _lastError = "Response JSON ran out of memory.";
+    return true;
+}
+
+#ifdef ENABLE_LAZY_ALLOCATION
+void ESP32_AI_Connect::setIdleRelease(uint32_t idleMs) {
+    _idleReleaseMs = idleMs;
+}
+
+uint32_t ESP32_AI_Connect::getIdleRelease() const {
+    return _idleReleaseMs;
+}
+
+bool ESP32_AI_Connect::releaseIdleResources() {
+#ifdef ENABLE_SINGLE_FLIGHT
+    // Never waits: called from loop(), and a client with a request running is not idle
+    AI_API_Request_Lock requestLock(_requestMutex, 0);
+    if (!requestLock.held()) return false;
+#endif
+    if (_idleReleaseMs == 0 || millis() - _docsUsedAt < _idleReleaseMs) return false;
+#ifdef ENABLE_STREAM_CHAT
+    if (_getStreamState() != StreamState::IDLE) return false;
+#endif
+    bool released = false;
+    if (_connHost.length() > 0 && millis() - _connUsedAt >= _connIdleMs) {
+        _httpClient.end();
+        _wifiClient.stop(); // Frees the TLS buffers
+        _connHost = "";
+        released = true;
+    }
+#ifdef ENABLE_TOOL_CALLS
+    bool keepResponse = _lastMessageWasToolCalls; // getToolCall() still reads it
+#else
+    bool keepResponse = false;
+#endif
+    if (_docsHeld && !keepResponse) {
+        _reqDoc.clear(); // Frees the documents' memory pools
+        _respDoc.clear();
+        _docsHeld = false;
+        released = true;
+    }
+    return released;
+}
+
+void ESP32_AI_Connect::_useDocuments() {
+    _docsUsedAt = millis();
+    _docsHeld = true;
+}
+#endif
+
+void ESP32_AI_Connect::_prepareConnection(const String& url) {
+    bool reusable = _connIdleMs > 0 && millis() - _connUsedAt < _connIdleMs &&
+                    _connHost == endpointHost(url) && _wifiClient.connected();
+    if (!reusable) {
+        _httpClient.end();
+        _wifiClient.stop(); // HTTPClient would otherwise send on a connection to another server
+        _connHost = "";
+    }
+    // Kept open: _httpClient.begin() and POST() pick the connection up as it is
+}
+
+#ifdef ENABLE_DNS_CACHE
+uint32_t ESP32_AI_Connect::getLastDnsTime() const {
+    return _lastDnsMs;
+}
+
+AI_API_DNS_Cache& ESP32_AI_Connect::getDnsCache() {
+    return _dnsCache;
+}
+
+bool ESP32_AI_Connect::_connectCached(const String& host) {
+    int colon = host.lastIndexOf(':');
+    String name = host.substring(0, colon);
+    IPAddress ip;
+    uint32_t lookupMs;
+    bool resolved = _dnsCache.resolve(name, ip, lookupMs);
+    _lastDnsMs += lookupMs;
+    if (!resolved) return false;
+
+    // The host name is passed on for SNI. The TCP connect runs on the client's socket timeout,
+    // so that holds the connect budget for it; HTTPClient then finds the connection open and
+    // leaves the timeout alone, so it is set to the read budget afterwards.
+    uint32_t remainingMs = _deadlineRemainingMs();
+    _setSocketTimeout(_wifiClient, min(_connectTimeoutMs, remainingMs));
+    bool connected = _wifiClient.connect(ip, host.substring(colon + 1).toInt(), name.c_str(), nullptr, nullptr, nullptr);
+    _setSocketTimeout(_wifiClient, min(_firstByteTimeoutMs, remainingMs));
+    if (!connected) {
+        #ifdef ENABLE_DEBUG_OUTPUT
+        Serial.println("DNS: connect to cached address of " + name + " failed, resolving again");
+        #endif
+        _dnsCache.invalidate(name); // The server may have moved
+    }
+    return true;
+}
+
+void ESP32_AI_Connect::_setSocketTimeout(WiFiClientSecure& client, uint32_t timeoutMs) {
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR >= 3
+    client.setTimeout(timeoutMs);
+#else
+    client.setTimeout((timeoutMs + 999) / 1000); // Core 2.x takes seconds here
+#endif
+}
+#endif
+
+void ESP32_AI_Connect::_startRequest() {
+    _requestStartedAt = millis();
+    _lastTimeoutPhase = TimeoutPhase::NONE;
+    _memoryUsage.begin();
+#ifdef ENABLE_DNS_CACHE
+    _lastDnsMs = 0;
+#endif
+#ifdef ENABLE_LAZY_ALLOCATION
+    _useDocuments();
+#endif
+}
+
+uint32_t ESP32_AI_Connect::_deadlineRemainingMs() const {
+    if (_requestDeadlineMs == 0) return UINT32_MAX;
+    uint32_t elapsed = millis() - _requestStartedAt;
+    return elapsed < _requestDeadlineMs ? _requestDeadlineMs - elapsed : 0;
+}
+
+void ESP32_AI_Connect::_applyTimeouts(HTTPClient& http, WiFiClientSecure& client) const {
+    AI_API_Timeouts::apply(http, client, _connectTimeoutMs, _tlsTimeoutMs, _firstByteTimeoutMs,
+                           _deadlineRemainingMs());
+}
+
+void ESP32_AI_Connect::_recordTimeout(int httpCode, uint32_t elapsedMs) {
+    const uint32_t slackMs = 250; // Timers fire late, not early
+    if (httpCode != HTTPC_ERROR_CONNECTION_REFUSED && httpCode != HTTPC_ERROR_READ_TIMEOUT) return;
+    if (_deadlineRemainingMs() <= slackMs) {
+        _lastTimeoutPhase = TimeoutPhase::DEADLINE; // Every phase budget was cut to the deadline
+    } else if (httpCode == HTTPC_ERROR_READ_TIMEOUT) {
+        _lastTimeoutPhase = TimeoutPhase::FIRST_BYTE;
+    } else if (elapsedMs >= _connectTimeoutMs && elapsedMs < _connectTimeoutMs + slackMs) {
+        // WiFiClientSecure reports both TCP and TLS failures as a refused connection;
+        // the time they took tells them apart
+        _lastTimeoutPhase = TimeoutPhase::CONNECT;
+    } else if (elapsedMs >= ((_tlsTimeoutMs + 999) / 1000) * 1000) {
+        _lastTimeoutPhase = TimeoutPhase::TLS;
+    }
+}
+
+String ESP32_AI_Connect::_requestFailedError(int httpCode) {
+#ifdef ENABLE_CANCELLATION
+    if (_requestCancelled()) return _lastError;
+#endif
+    String error = String("HTTP Request Failed: ") + _httpClient.errorToString(httpCode).c_str();
+    switch (_lastTimeoutPhase) {
+        case TimeoutPhase::CONNECT:
+            error += " (connect timeout, " + String(_connectTimeoutMs) + " ms)";
+            break;
+        case TimeoutPhase::TLS:
+            error += " (TLS handshake timeout, " + String(_tlsTimeoutMs) + " ms)";
+            break;
+        case TimeoutPhase::FIRST_BYTE:
+            error += " (first byte timeout, " + String(_firstByteTimeoutMs) + " ms)";
+            break;
+        case TimeoutPhase::DEADLINE:
+            error += " (request deadline of " + String(_requestDeadlineMs) + " ms reached)";
+            break;
+        default:
+            break;
+    }
+    return error;
+}
+
 // --- Raw Response Access Methods ---
 String ESP32_AI_Connect::getChatRawResponse() const {
     return _chatRawResponse;
@@ -223,6 +668,185 @@ String ESP32_AI_Connect::getFinishReason() const {
     return ""; // Return empty if no handler
 }
 
+#ifdef ENABLE_RESPONSE_CACHE
+// --- Response Cache ---
+void ESP32_AI_Connect::setResponseCache(AI_API_Response_Cache* cache, bool anyTemperature) {
+    _responseCache = cache;
+    _cacheAnyTemperature = anyTemperature;
+    _lastResponseCached = false;
+}
+
+AI_API_Response_Cache* ESP32_AI_Connect::getResponseCache() const {
+    return _responseCache;
+}
+
+bool ESP32_AI_Connect::isLastResponseCached() const {
+    return _lastResponseCached;
+}
+
+#endif
+
+#if defined(ENABLE_RESPONSE_CACHE) || defined(ENABLE_SINGLE_FLIGHT)
+uint64_t ESP32_AI_Connect::_targetKey(const String& url) const {
+    // The URL covers platform, endpoint and (for Gemini) model
+    uint64_t key = AI_API_Request_Key::add(AI_API_Request_Key::SEED, url);
+    return AI_API_Request_Key::add(key, _modelName);
+}
+
+uint64_t ESP32_AI_Connect::_chatRequestKey(const String& url, const String& userMessage) const {
+    return _chatRequestKey(_targetKey(url), userMessage);
+}
+
+uint64_t ESP32_AI_Connect::_chatRequestKey(uint64_t targetKey, const String& userMessage) const {
+    // Everything else that shapes the reply
+    uint64_t key = AI_API_Request_Key::add(targetKey, _systemRole);
+    key = AI_API_Request_Key::add(key, &_temperature, sizeof(_temperature));
+    key = AI_API_Request_Key::add(key, &_maxTokens, sizeof(_maxTokens));
+    key = AI_API_Request_Key::add(key, _chatCustomParams);
+    return AI_API_Request_Key::add(key, userMessage);
+}
+#endif
+
+// --- Prompt Caching ---
+void ESP32_AI_Connect::setPromptCaching(bool enable, const String& cacheKey) {
+    _promptCaching = enable;
+    _promptCacheKey = cacheKey;
+    if (_platformHandler) {
+        _platformHandler->setPromptCaching(enable, cacheKey);
+    }
+#ifdef ENABLE_FAILOVER
+    for (int i = 0; i < _failoverTargetCount; i++) {
+        _failoverTargets[i].handler->setPromptCaching(enable, cacheKey);
+    }
+#endif
+}
+
+bool ESP32_AI_Connect::getPromptCaching() const {
+    return _promptCaching;
+}
+
+int ESP32_AI_Connect::getCacheReadTokens() const {
+    if (_platformHandler) {
+        return _platformHandler->getCacheReadTokens();
+    }
+    return 0;
+}
+
+int ESP32_AI_Connect::getCacheWriteTokens() const {
+    if (_platformHandler) {
+        return _platformHandler->getCacheWriteTokens();
+    }
+    return 0;
+}
+
+#ifdef ENABLE_TOKEN_ESTIMATOR
+// --- Prompt Token Estimation ---
+int ESP32_AI_Connect::estimateChatTokens(const String& userMessage) {
+    return _tokenEstimator.scale(_rawChatTokens(_systemRole, userMessage, nullptr));
+}
+
+#ifdef ENABLE_CHAT_SESSION
+int ESP32_AI_Connect::estimateChatTokens(const String& userMessage, const AI_API_Chat_Session& session) {
+    return _tokenEstimator.scale(_rawChatTokens(_systemRole, userMessage, &session));
+}
+#endif
+
+#ifdef ENABLE_TOOL_CALLS
+// Raw token count of the tool definitions sent with a tool calls request
+static int rawToolTokens(const String* tools, int toolsSize, const AI_API_Tool_Def* toolDefs, int toolDefsSize) {
+    int tokens = 0;
+    for (int i = 0; i < toolsSize; i++) {
+        tokens += AI_API_Token_Estimator::countRaw(tools[i]);
+    }
+    for (int i = 0; i < toolDefsSize; i++) {
+        tokens += AI_API_Token_Estimator::countRaw(toolDefs[i].openai, strlen(toolDefs[i].openai));
+    }
+    return tokens;
+}
+
+// Counts all registered tools, an upper bound when tool selection is enabled
+int ESP32_AI_Connect::estimateTCChatTokens(const String& tcUserMessage) {
+    int raw = _rawChatTokens(_tcSystemRole, tcUserMessage, nullptr) +
+              rawToolTokens(_tcToolsArray, _tcToolsArraySize, _tcToolDefs, _tcToolDefsSize);
+    return _tokenEstimator.scale(raw);
+}
+#endif
+
+void ESP32_AI_Connect::setPromptTokenBudget(int maxPromptTokens) {
+    _promptTokenBudget = max(0, maxPromptTokens);
+}
+
+int ESP32_AI_Connect::getPromptTokenBudget() const {
+    return _promptTokenBudget;
+}
+
+int ESP32_AI_Connect::getLastEstimatedTokens() const {
+    return _lastEstimatedTokens;
+}
+
+int ESP32_AI_Connect::getPromptTokens() const {
+    if (_platformHandler) {
+        return _platformHandler->getPromptTokens();
+    }
+    return 0;
+}
+
+float ESP32_AI_Connect::getTokenEstimateError() const {
+    return _tokenEstimator.getLastErrorPercent();
+}
+
+int ESP32_AI_Connect::_rawChatTokens(const String& systemRole, const String& userMessage,
+                                     const AI_API_Chat_Session* session) const {
+    int tokens = AI_API_Token_Estimator::countMessage(userMessage.c_str(), userMessage.length());
+    if (!systemRole.isEmpty()) {
+        tokens += AI_API_Token_Estimator::countMessage(systemRole.c_str(), systemRole.length());
+    }
+#ifdef ENABLE_CHAT_SESSION
+    if (session) {
+        AI_API_Chat_Session::Cursor cursor = session->begin();
+        AI_API_Chat_Session::Turn turn;
+        while (session->nextTurn(cursor, turn)) {
+            tokens += AI_API_Token_Estimator::countMessage(turn.text, turn.length);
+        }
+    }
+#endif
+    return tokens;
+}
+
+bool ESP32_AI_Connect::_checkPromptBudget(int rawTokens) {
+    _lastRawEstimate = rawTokens;
+    _lastEstimatedTokens = _tokenEstimator.scale(rawTokens);
+
+    #ifdef ENABLE_DEBUG_OUTPUT
+    Serial.println("Token estimate: " + String(_lastEstimatedTokens) + " prompt tokens");
+    #endif
+
+    if (_promptTokenBudget > 0 && _lastEstimatedTokens > _promptTokenBudget) {
+        _lastError = "Estimated prompt tokens (" + String(_lastEstimatedTokens) +
+                     ") exceed the prompt token budget (" + String(_promptTokenBudget) + ")";
+        return false;
+    }
+    return true;
+}
+
+void ESP32_AI_Connect::_fitSessionToBudget(const String& systemRole, const String& userMessage,
+                                           AI_API_Chat_Session& session) {
+#ifdef ENABLE_CHAT_SESSION
+    if (_promptTokenBudget <= 0) return;
+    while (_tokenEstimator.scale(_rawChatTokens(systemRole, userMessage, &session)) > _promptTokenBudget &&
+           session.dropOldestTurn()) {
+    }
+#endif
+}
+
+void ESP32_AI_Connect::_calibrateTokenEstimate() {
+    if (_platformHandler) {
+        _tokenEstimator.calibrate(_lastRawEstimate, _platformHandler->getPromptTokens());
+    }
+    _lastRawEstimate = 0; // One sample per request
+}
+#endif
+
 #ifdef ENABLE_TOOL_CALLS
 // --- Tool Calls Configuration Setters ---
 void ESP32_AI_Connect::setTCChatSystemRole(const String& systemRole) {
@@ -273,33 +897,93 @@ String ESP32_AI_Connect::getTCReplyToolChoice() const {
 }
 
 // --- Tool Setup ---
+// Largest total size of tool definitions one request may carry
+static const size_t MAX_TOTAL_TC_LENGTH = AI_API_REQ_JSON_DOC_SIZE / 2; // Use half of request doc size as rough limit
+
+// Bytes of the tools one request can carry: all of them, or the largest topK (0: all)
+static size_t sentToolsLength(const String* tools, int toolsSize, int topK) {
+    size_t totalLength = 0;
+    if (topK <= 0 || topK >= toolsSize) {
+        for (int i = 0; i < toolsSize; i++) {
+            totalLength += tools[i].length();
+        }
+        return totalLength;
+    }
+    size_t previousMax = SIZE_MAX;
+    int previousMaxIndex = -1;
+    for (int k = 0; k < topK; k++) {
+        // Find the next largest tool (ties broken by index)
+        int maxIndex = -1;
+        for (int i = 0; i < toolsSize; i++) {
+            size_t len = tools[i].length();
+            bool belowPrevious = len < previousMax || (len == previousMax && i > previousMaxIndex);
+            if (belowPrevious && (maxIndex == -1 || len > tools[maxIndex].length())) {
+                maxIndex = i;
+            }
+        }
+        if (maxIndex == -1) break;
+        previousMax = tools[maxIndex].length();
+        previousMaxIndex = maxIndex;
+        totalLength += previousMax;
+    }
+    return totalLength;
+}
+
 bool ESP32_AI_Connect::setTCTools(String* tcTools, int tcToolsSize) {
     _lastError = "";
+#ifdef ENABLE_LAZY_ALLOCATION
+    _useDocuments(); // _reqDoc validates the definitions
+#endif
     
     // --- VALIDATION STEP 1: Check total length ---
-    size_t totalLength = 0;
-    
-    // Calculate total length of all tools
-    for (int i = 0; i < tcToolsSize; i++) {
-        totalLength += tcTools[i].length();
-    }
+#ifdef ENABLE_TOOL_SELECTION
+    // With tool selection only topK tools go into a request, so check the largest topK tools instead
+    size_t totalLength = sentToolsLength(tcTools, tcToolsSize, _tcToolSelectTopK);
+#else
+    size_t totalLength = sentToolsLength(tcTools, tcToolsSize, 0);
+#endif
     
-    // Check against maximum allowed size (adjust this value as needed)
-    const size_t MAX_TOTAL_TC_LENGTH = AI_API_REQ_JSON_DOC_SIZE / 2; // Use half of request doc size as rough limit
+    // Check against maximum allowed size
     if (totalLength > MAX_TOTAL_TC_LENGTH) {
         _lastError = "Tool calls definition too large. Total size: " + String(totalLength) + 
                     " bytes, maximum allowed: " + String(MAX_TOTAL_TC_LENGTH) + " bytes.";
         return false;
     }
     
+    // Validated copies of the tool definitions (tags are stripped before storing)
+    // and the argument signature of each tool, used to validate tool calls
+    String* validatedTools = nullptr;
+    String* signatures = nullptr;
+    if (tcToolsSize > 0) {
+        validatedTools = new String[tcToolsSize];
+        signatures = new String[tcToolsSize];
+        if (validatedTools == nullptr || signatures == nullptr) {
+            delete[] validatedTools;
+            delete[] signatures;
+            _lastError = "Memory allocation failed for tool calls array.";
+            return false;
+        }
+    }
+    
+#ifdef ENABLE_TOOL_SELECTION
+    // Build the keyword index alongside validation; it replaces the current index only on success
+    AI_API_Tool_Selector newSelector;
+    if (!newSelector.beginIndex(tcToolsSize)) {
+        delete[] validatedTools;
+        delete[] signatures;
+        _lastError = "Memory allocation failed for tool selection index.";
+        return false;
+    }
+#endif
+    
     // --- VALIDATION STEP 2: Validate JSON format of each tool ---
-    for (int i = 0; i < tcToolsSize; i++) {
+    for (int i = 0; i < tcToolsSize && _lastError.isEmpty(); i++) {
         _reqDoc.clear(); // Reuse request document for JSON validation
         DeserializationError error = deserializeJson(_reqDoc, tcTools[i]);
         
         if (error) {
             _lastError = "Invalid JSON in tool #" + String(i+1) + ": " + String(error.c_str());
-            return false;
+            break;
         }
         
         // Check for required fields in each tool - support both formats:
@@ -307,14 +991,16 @@ bool ESP32_AI_Connect::setTCTools(String* tcTools, int tcToolsSize) {
         // 2. OpenAI format: {"type": "function", "function": {"name": "...", ...}}
         bool hasName = false;
         bool hasParameters = false;
+        JsonObject function; // Object holding name/description in either format
         
         if (_reqDoc.containsKey("name")) {
             // Format 1 - Our simplified format
             hasName = true;
             hasParameters = _reqDoc.containsKey("parameters");
+            function = _reqDoc.as<JsonObject>();
         } else if (_reqDoc.containsKey("type") && _reqDoc.containsKey("function")) {
             // Format 2 - OpenAI format with type and function
-            JsonObject function = _reqDoc["function"];
+            function = _reqDoc["function"];
             if (function.containsKey("name")) {
                 hasName = true;
             }
@@ -325,15 +1011,37 @@ bool ESP32_AI_Connect::setTCTools(String* tcTools, int tcToolsSize) {
         
         if (!hasName) {
             _lastError = "Missing 'name' field in tool #" + String(i+1);
-            return false;
+            break;
         }
         
         if (!hasParameters) {
             _lastError = "Missing 'parameters' field in tool #" + String(i+1);
-            return false;
+            break;
+        }
+        
+        AI_API_Tool_Args::buildSignature(function["name"] | "", function["parameters"], signatures[i]);
+        
+#ifdef ENABLE_TOOL_SELECTION
+        // Optional "tags" array (top level, either format) is only used for tool selection
+        newSelector.indexTool(i, function["name"] | "", function["description"] | "",
+                              _reqDoc["tags"].as<JsonArrayConst>());
+#endif
+        
+        if (_reqDoc.containsKey("tags")) {
+            // Tags are not part of any platform's tool schema - strip them before storing
+            _reqDoc.remove("tags");
+            serializeJson(_reqDoc, validatedTools[i]);
+        } else {
+            validatedTools[i] = tcTools[i];
         }
     }
     
+    if (!_lastError.isEmpty()) {
+        delete[] validatedTools;
+        delete[] signatures;
+        return false;
+    }
+    
     // --- Clean up previous tools array if exists ---
     if (_tcToolsArray != nullptr) {
         delete[] _tcToolsArray;
@@ -342,23 +1050,187 @@ bool ESP32_AI_Connect::setTCTools(String* tcTools, int tcToolsSize) {
     }
     
     // --- Store the validated tool calls configuration ---
-    if (tcToolsSize > 0) {
-        _tcToolsArray = new String[tcToolsSize];
-        if (_tcToolsArray == nullptr) {
-            _lastError = "Memory allocation failed for tool calls array.";
+    _tcToolsArray = validatedTools;
+    _tcToolsArraySize = tcToolsSize;
+    delete[] _tcToolSignatures;
+    _tcToolSignatures = signatures;
+    _tcToolDefs = nullptr; // String tools replace any pre-rendered tools
+    _tcToolDefsSize = 0;
+    
+#ifdef ENABLE_TOOL_SELECTION
+    newSelector.endIndex();
+    _tcToolSelector.swap(newSelector);
+    _tcSelectedToolsSize = 0; // Previous selection refers to the old tools
+#endif
+    
+    return true;
+}
+
+bool ESP32_AI_Connect::setTCTools(const AI_API_Tool_Def* tcTools, int tcToolsSize) {
+    _lastError = "";
+    
+    if (tcToolsSize < 0 || (tcToolsSize > 0 && tcTools == nullptr)) {
+        _lastError = "Invalid tool definitions array.";
+        return false;
+    }
+    
+    // Schemas were rendered at compile time - only make sure every platform's entry exists
+    for (int i = 0; i < tcToolsSize; i++) {
+        const AI_API_Tool_Def& tool = tcTools[i];
+        if (tool.name == nullptr || tool.openai == nullptr || tool.claude == nullptr || tool.gemini == nullptr ||
+            tool.signature == nullptr) {
+            _lastError = "Incomplete definition in tool #" + String(i+1);
             return false;
         }
-        
-        // Copy tool definitions
-        for (int i = 0; i < tcToolsSize; i++) {
-            _tcToolsArray[i] = tcTools[i];
-        }
-        _tcToolsArraySize = tcToolsSize;
     }
     
+#ifdef ENABLE_TOOL_SELECTION
+    AI_API_Tool_Selector newSelector;
+    if (!newSelector.beginIndex(tcToolsSize)) {
+        _lastError = "Memory allocation failed for tool selection index.";
+        return false;
+    }
+    for (int i = 0; i < tcToolsSize; i++) {
+        newSelector.indexTool(i, tcTools[i].name, tcTools[i].description, JsonArrayConst());
+    }
+    newSelector.endIndex();
+    _tcToolSelector.swap(newSelector);
+    _tcSelectedToolsSize = 0;
+#endif
+    
+    // Pre-rendered tools replace any String tools
+    if (_tcToolsArray != nullptr) {
+        delete[] _tcToolsArray;
+        _tcToolsArray = nullptr;
+        _tcToolsArraySize = 0;
+    }
+    delete[] _tcToolSignatures;
+    _tcToolSignatures = nullptr;
+    
+    // Definitions are referenced, not copied (they normally live in flash)
+    _tcToolDefs = tcTools;
+    _tcToolDefsSize = tcToolsSize;
+    
     return true;
 }
 
+#ifdef ENABLE_TOOL_SELECTION
+// --- Tool Selection ---
+bool ESP32_AI_Connect::setTCToolSelection(int topK) {
+    _lastError = "";
+    topK = max(0, topK);
+    // A larger topK puts more of the registered tools into each request
+    size_t totalLength = sentToolsLength(_tcToolsArray, _tcToolsArraySize, topK);
+    if (totalLength > MAX_TOTAL_TC_LENGTH) {
+        _lastError = "Tool calls definition too large for topK " + String(topK) + ". Total size: " +
+                     String(totalLength) + " bytes, maximum allowed: " + String(MAX_TOTAL_TC_LENGTH) + " bytes.";
+        return false;
+    }
+    if (topK != _tcToolSelectTopK) {
+        delete[] _tcSelectedTools;
+        _tcSelectedTools = nullptr;
+        delete[] _tcSelectedToolDefs;
+        _tcSelectedToolDefs = nullptr;
+        _tcSelectedToolsSize = 0;
+    }
+    _tcToolSelectTopK = topK;
+    return true;
+}
+
+int ESP32_AI_Connect::getTCToolSelection() const {
+    return _tcToolSelectTopK;
+}
+
+int ESP32_AI_Connect::getTCSelectedToolCount() const {
+    return _tcSelectedToolsSize > 0 ? _tcSelectedToolsSize : _tcToolsArraySize + _tcToolDefsSize;
+}
+
+int ESP32_AI_Connect::getTCToolBytesSaved() const {
+    return _tcToolBytesSaved;
+}
+
+int ESP32_AI_Connect::getTCToolTokensSaved() const {
+    // Rough estimate: JSON schemas average about 4 bytes per token
+    return (_tcToolBytesSaved + 3) / 4;
+}
+
+// Pick the tools sent with the next tcChat (and reused by its tcReply follow-ups)
+void ESP32_AI_Connect::_selectTCTools(const String& userMessage) {
+    _tcSelectedToolsSize = 0;
+    _tcToolBytesSaved = 0;
+    
+    // Either String tools or pre-rendered tools are registered, never both
+    bool usesDefs = _tcToolDefsSize > 0;
+    int toolCount = usesDefs ? _tcToolDefsSize : _tcToolsArraySize;
+    if (_tcToolSelectTopK <= 0 || _tcToolSelectTopK >= toolCount) {
+        return; // Selection disabled or nothing to leave out
+    }
+    
+    if (usesDefs && _tcSelectedToolDefs == nullptr) {
+        _tcSelectedToolDefs = new AI_API_Tool_Def[_tcToolSelectTopK];
+        if (_tcSelectedToolDefs == nullptr) return; // Fall back to sending all tools
+    } else if (!usesDefs && _tcSelectedTools == nullptr) {
+        _tcSelectedTools = new String[_tcToolSelectTopK];
+        if (_tcSelectedTools == nullptr) return; // Fall back to sending all tools
+    }
+    
+    // A tool named by tool_choice must always be sent
+    uint32_t forcedNameHash = 0;
+    if (_tcToolChoice.startsWith("{")) {
+        AI_API_Json_Document choiceDoc;
+        if (!deserializeJson(choiceDoc, _tcToolChoice)) {
+            // OpenAI: {"type":"function","function":{"name":"..."}}, Claude: {"type":"tool","name":"..."}
+            const char* forcedName = choiceDoc["function"]["name"] | (choiceDoc["name"] | "");
+            if (forcedName[0] != '\0') {
+                forcedNameHash = AI_API_Tool_Selector::hashTerm(forcedName, strlen(forcedName));
+            }
+        }
+    }
+    
+    int* indices = new int[_tcToolSelectTopK];
+    if (indices == nullptr) return;
+    int count = _tcToolSelector.selectTools(userMessage, _tcToolSelectTopK, indices, forcedNameHash);
+    if (count == 0) {
+        // No relevant tool found: send the first topK tools. All tools could exceed the size
+        // limit, which setTCTools() checked for topK tools only.
+        for (int i = 0; i < _tcToolSelectTopK; i++) {
+            indices[i] = i;
+        }
+        count = _tcToolSelectTopK;
+        // The forced tool must be among them, or the provider rejects tool_choice
+        int forcedIndex = forcedNameHash != 0 ? _tcToolSelector.findTool(forcedNameHash) : -1;
+        if (forcedIndex >= count) indices[count - 1] = forcedIndex; // Still ascending
+    }
+    
+    // Pre-rendered tools are measured by their OpenAI rendering
+    auto toolBytes = [this, usesDefs](int i) -> size_t {
+        return usesDefs ? strlen(_tcToolDefs[i].openai) : _tcToolsArray[i].length();
+    };
+    
+    size_t sentBytes = 0;
+    size_t totalBytes = 0;
+    for (int i = 0; i < toolCount; i++) {
+        totalBytes += toolBytes(i);
+    }
+    for (int i = 0; i < count; i++) {
+        if (usesDefs) {
+            _tcSelectedToolDefs[i] = _tcToolDefs[indices[i]];
+        } else {
+            _tcSelectedTools[i] = _tcToolsArray[indices[i]];
+        }
+        sentBytes += toolBytes(indices[i]);
+    }
+    delete[] indices;
+    _tcSelectedToolsSize = count;
+    _tcToolBytesSaved = totalBytes - sentBytes;
+    
+    #ifdef ENABLE_DEBUG_OUTPUT
+    Serial.println("Tool selection: sending " + String(count) + " of " + String(toolCount) +
+                   " tools, " + String(_tcToolBytesSaved) + " bytes saved");
+    #endif
+}
+#endif
+
 // --- Reset Tool Calls ---
 void ESP32_AI_Connect::tcChatReset() {
     _lastUserMessage = "";
@@ -379,13 +1251,26 @@ void ESP32_AI_Connect::tcChatReset() {
     // Reset follow-up configuration to defaults
     _tcFollowUpMaxToken = -1;
     _tcFollowUpToolChoice = "";
+    
+#ifdef ENABLE_TOOL_SELECTION
+    // Keep the topK setting (it belongs to the tool definitions) but forget the last selection
+    _tcSelectedToolsSize = 0;
+    _tcToolBytesSaved = 0;
+#endif
 }
 
 // --- Perform Tool Calls Chat ---
 String ESP32_AI_Connect::tcChat(const String& tcUserMessage) {
+#ifdef ENABLE_SINGLE_FLIGHT
+    AI_API_Request_Lock requestLock(_requestMutex);
+#endif
     _lastError = "";
     _tcRawResponse = ""; // Clear previous raw response
     _tcChatResponseCode = 0; // Reset response code
+    _startRequest();
+#ifdef ENABLE_CANCELLATION
+    AI_API_Cancel_Scope cancelScope(_cancelToken, _wifiClient);
+#endif
     
     // Check if platform handler is initialized
     if (!_platformHandler) {
@@ -394,7 +1279,7 @@ String ESP32_AI_Connect::tcChat(const String& tcUserMessage) {
     }
     
     // Check if tool calls setup has been performed
-    if (_tcToolsArray == nullptr || _tcToolsArraySize == 0) {
+    if (_tcToolsArraySize == 0 && _tcToolDefsSize == 0) {
         _lastError = "Tool calls not set up. Call setTCTools() first.";
         return "";
     }
@@ -404,6 +1289,29 @@ String ESP32_AI_Connect::tcChat(const String& tcUserMessage) {
     _lastAssistantToolCallsJson = "";
     _lastMessageWasToolCalls = false;
     
+    // Tools sent with this request (a relevant subset when tool selection is enabled)
+    const String* tools = _tcToolsArray;
+    int toolsSize = _tcToolsArraySize;
+    const AI_API_Tool_Def* toolDefs = _tcToolDefs;
+    int toolDefsSize = _tcToolDefsSize;
+#ifdef ENABLE_TOOL_SELECTION
+    _selectTCTools(tcUserMessage);
+    if (_tcSelectedToolsSize > 0 && toolDefsSize > 0) {
+        toolDefs = _tcSelectedToolDefs;
+        toolDefsSize = _tcSelectedToolsSize;
+    } else if (_tcSelectedToolsSize > 0) {
+        tools = _tcSelectedTools;
+        toolsSize = _tcSelectedToolsSize;
+    }
+#endif
+    
+#ifdef ENABLE_TOKEN_ESTIMATOR
+    if (!_checkPromptBudget(_rawChatTokens(_tcSystemRole, tcUserMessage, nullptr) +
+                            rawToolTokens(tools, toolsSize, toolDefs, toolDefsSize))) {
+        return "";
+    }
+#endif
+    
     // Get endpoint URL (same as regular chat)
     String url = _platformHandler->getEndpoint(_modelName, _apiKey, _customEndpoint);
     if (url.isEmpty()) {
@@ -412,9 +1320,12 @@ String ESP32_AI_Connect::tcChat(const String& tcUserMessage) {
     }
     
     // Build request body using the platform handler's tool calls method
+    _platformHandler->setPrebuiltTools(toolDefs, toolDefsSize);
     String requestBody = _platformHandler->buildToolCallsRequestBody(
-        _modelName, _tcToolsArray, _tcToolsArraySize, 
+        _modelName, tools, toolsSize, 
         _tcSystemRole, _tcToolChoice, _tcMaxToken, tcUserMessage, _reqDoc);
+    if (_requestOverflowed()) requestBody = "";
+    _platformHandler->setPrebuiltTools(nullptr, 0);
     
     if (requestBody.isEmpty()) {
         if (_lastError.isEmpty()) _lastError = "Failed to build tool calls request body.";
@@ -429,18 +1340,30 @@ String ESP32_AI_Connect::tcChat(const String& tcUserMessage) {
     #endif
     
     // Perform HTTP POST Request (same pattern as regular chat)
-    _httpClient.end(); // Ensure previous connection is closed
+    _prepareConnection(url); // Reuse a warm connection, close any other
     if (_httpClient.begin(_wifiClient, url)) {
         _platformHandler->setHeaders(_httpClient, _apiKey); // Same headers as regular chat
-        _httpClient.setTimeout(AI_API_HTTP_TIMEOUT_MS);
-        int httpCode = _httpClient.POST(requestBody);
+#ifdef ENABLE_RATE_LIMITER
+        if (!_rateLimitAcquire(requestBody, _tcMaxToken)) {
+            _httpClient.end();
+            _tcChatResponseCode = 429;
+            return "";
+        }
+#endif
+        int httpCode = _postRequest(url, requestBody);
         
         // Store the HTTP response code
         _tcChatResponseCode = httpCode;
         
         // Handle Response
         if (httpCode > 0) {
-            String responsePayload = _httpClient.getString();
+            String responsePayload = _readResponseBody();
+#ifdef ENABLE_CANCELLATION
+            if (_requestCancelled()) {
+                _httpClient.end();
+                return ""; // The payload is incomplete
+            }
+#endif
             // Store the raw response
             _tcRawResponse = responsePayload;
             
@@ -455,10 +1378,18 @@ String ESP32_AI_Connect::tcChat(const String& tcUserMessage) {
                 // Parse response using the platform handler's tool calls response parser
                 String responseContent = _platformHandler->parseToolCallsResponseBody(
                     responsePayload, _lastError, _respDoc);
+                if (_responseOverflowed()) responseContent = "";
                 
                 if (responseContent.isEmpty() && _lastError.isEmpty()) {
                     _lastError = "Handler failed to parse tool calls response.";
                 } else {
+                    #ifdef ENABLE_TOKEN_ESTIMATOR
+                    _calibrateTokenEstimate();
+                    #endif
+                    #ifdef ENABLE_RATE_LIMITER
+                    _rateLimitSettle();
+                    #endif
+                    
                     // Track finish reason for potential follow-up
                     String finishReason = _platformHandler->getFinishReason();
                     if (finishReason == "tool_calls" || finishReason == "tool_use") {
@@ -475,7 +1406,7 @@ String ESP32_AI_Connect::tcChat(const String& tcUserMessage) {
                 _lastError = "HTTP Error: " + String(httpCode) + " - Response: " + responsePayload;
             }
         } else {
-            _lastError = String("HTTP Request Failed: ") + _httpClient.errorToString(httpCode).c_str();
+            _lastError = _requestFailedError(httpCode);
         }
         _httpClient.end(); // Clean up connection
     } else {
@@ -485,11 +1416,66 @@ String ESP32_AI_Connect::tcChat(const String& tcUserMessage) {
     return ""; // Return empty string on error
 }
 
+// --- Decoded Tool Calls ---
+const char* ESP32_AI_Connect::_findTCToolSignature(const char* name) const {
+    for (int i = 0; i < _tcToolDefsSize; i++) {
+        if (AI_API_Tool_Args::signatureMatches(_tcToolDefs[i].signature, name)) {
+            return _tcToolDefs[i].signature;
+        }
+    }
+    for (int i = 0; i < _tcToolsArraySize && _tcToolSignatures != nullptr; i++) {
+        if (AI_API_Tool_Args::signatureMatches(_tcToolSignatures[i].c_str(), name)) {
+            return _tcToolSignatures[i].c_str();
+        }
+    }
+    return nullptr;
+}
+
+int ESP32_AI_Connect::tcGetToolCallCount() {
+    if (!_platformHandler || !_lastMessageWasToolCalls) return 0;
+    return _platformHandler->getToolCallCount(_respDoc);
+}
+
+bool ESP32_AI_Connect::tcGetToolCall(int index, AI_API_Tool_Call& call) {
+    _lastError = "";
+    
+    if (!_platformHandler || !_lastMessageWasToolCalls) {
+        _lastError = "No tool calls available. Call tcChat first and ensure it returns tool calls.";
+        return false;
+    }
+    
+    // Read the call straight from the parsed response - no intermediate JSON strings
+    if (!_platformHandler->getToolCall(_respDoc, index, call, _tcArgsDoc)) {
+        _lastError = "Tool call #" + String(index + 1) + " not found or its arguments are not a JSON object.";
+        return false;
+    }
+    
+    // Validate against the registered definition in the same pass
+    const char* signature = _findTCToolSignature(call.name);
+    if (signature == nullptr) {
+        _lastError = "Tool call to unknown tool '" + String(call.name) + "'";
+        return false;
+    }
+    return AI_API_Tool_Args::validate(call.args, signature, _lastError);
+}
+
+bool ESP32_AI_Connect::tcBindToolArgs(const AI_API_Tool_Call& call, const AI_API_Arg_Field* fields, int fieldCount) {
+    _lastError = "";
+    return AI_API_Tool_Args::bind(call.args, fields, fieldCount, _lastError);
+}
+
 // --- Reply to Tool Calls with Results ---
 String ESP32_AI_Connect::tcReply(const String& toolResultsJson) {
+#ifdef ENABLE_SINGLE_FLIGHT
+    AI_API_Request_Lock requestLock(_requestMutex);
+#endif
     _lastError = "";
     _tcRawResponse = ""; // Clear previous raw response
     _tcReplyResponseCode = 0; // Reset response code
+    _startRequest();
+#ifdef ENABLE_CANCELLATION
+    AI_API_Cancel_Scope cancelScope(_cancelToken, _wifiClient);
+#endif
     
     // Check if platform handler is initialized
     if (!_platformHandler) {
@@ -498,7 +1484,7 @@ String ESP32_AI_Connect::tcReply(const String& toolResultsJson) {
     }
     
     // Check if tool calls setup has been performed
-    if (_tcToolsArray == nullptr || _tcToolsArraySize == 0) {
+    if (_tcToolsArraySize == 0 && _tcToolDefsSize == 0) {
         _lastError = "Tool calls not set up. Call setTCTools() first.";
         return "";
     }
@@ -516,132 +1502,998 @@ String ESP32_AI_Connect::tcReply(const String& toolResultsJson) {
                     String(AI_API_REQ_JSON_DOC_SIZE / 2) + " bytes.";
         return "";
     }
-    
-    // Validate JSON format
-    _reqDoc.clear();
-    DeserializationError error = deserializeJson(_reqDoc, toolResultsJson);
-    if (error) {
-        _lastError = "Invalid JSON in tool results: " + String(error.c_str());
-        return "";
+    
+    // Validate JSON format
+    _reqDoc.clear();
+    DeserializationError error = deserializeJson(_reqDoc, toolResultsJson);
+    if (error) {
+        _lastError = "Invalid JSON in tool results: " + String(error.c_str());
+        return "";
+    }
+    
+    // Check basic structure
+    if (!_reqDoc.is<JsonArray>()) {
+        _lastError = "Tool results must be a JSON array.";
+        return "";
+    }
+    
+    // Validate each tool result
+    JsonArray resultsArray = _reqDoc.as<JsonArray>();
+    for (JsonObject result : resultsArray) {
+        if (!result.containsKey("tool_call_id")) {
+            _lastError = "Each tool result must have a 'tool_call_id' field.";
+            return "";
+        }
+        if (!result.containsKey("function")) {
+            _lastError = "Each tool result must have a 'function' field.";
+            return "";
+        }
+        JsonObject function = result["function"];
+        if (!function.containsKey("name")) {
+            _lastError = "Each tool result function must have a 'name' field.";
+            return "";
+        }
+        if (!function.containsKey("output")) {
+            _lastError = "Each tool result function must have an 'output' field.";
+            return "";
+        }
+    }
+    
+    // --- Build and send the follow-up request ---
+    String url = _platformHandler->getEndpoint(_modelName, _apiKey, _customEndpoint);
+    if (url.isEmpty()) {
+        _lastError = "Failed to get endpoint URL from platform handler.";
+        return "";
+    }
+    
+    // Follow-ups send the same tools as the tcChat that started the conversation
+    const String* tools = _tcToolsArray;
+    int toolsSize = _tcToolsArraySize;
+    const AI_API_Tool_Def* toolDefs = _tcToolDefs;
+    int toolDefsSize = _tcToolDefsSize;
+#ifdef ENABLE_TOOL_SELECTION
+    if (_tcSelectedToolsSize > 0 && toolDefsSize > 0) {
+        toolDefs = _tcSelectedToolDefs;
+        toolDefsSize = _tcSelectedToolsSize;
+    } else if (_tcSelectedToolsSize > 0) {
+        tools = _tcSelectedTools;
+        toolsSize = _tcSelectedToolsSize;
+    }
+#endif
+    
+    // Build request body using the platform handler's tool calls follow-up method
+    _platformHandler->setPrebuiltTools(toolDefs, toolDefsSize);
+    String requestBody = _platformHandler->buildToolCallsFollowUpRequestBody(
+        _modelName, tools, toolsSize,
+        _tcSystemRole, _tcToolChoice,
+        _lastUserMessage, _lastAssistantToolCallsJson,
+        toolResultsJson, _tcFollowUpMaxToken, _tcFollowUpToolChoice, _reqDoc);
+    if (_requestOverflowed()) requestBody = "";
+    _platformHandler->setPrebuiltTools(nullptr, 0);
+    
+    if (requestBody.isEmpty()) {
+        if (_lastError.isEmpty()) _lastError = "Failed to build tool calls follow-up request body.";
+        return "";
+    }
+    
+    #ifdef ENABLE_DEBUG_OUTPUT
+    Serial.println("---------- AI Tool Calls Follow-up Request ----------");
+    Serial.println("URL: " + url);
+    Serial.println("Body: " + requestBody);
+    Serial.println("--------------------------------------------------");
+    #endif
+    
+    // Perform HTTP POST Request
+    _prepareConnection(url); // Reuse a warm connection, close any other
+    if (_httpClient.begin(_wifiClient, url)) {
+        _platformHandler->setHeaders(_httpClient, _apiKey);
+#ifdef ENABLE_RATE_LIMITER
+        if (!_rateLimitAcquire(requestBody, _tcFollowUpMaxToken)) {
+            _httpClient.end();
+            _tcReplyResponseCode = 429;
+            return "";
+        }
+#endif
+        int httpCode = _postRequest(url, requestBody);
+        
+        // Store the HTTP response code
+        _tcReplyResponseCode = httpCode;
+        
+        // Handle Response
+        if (httpCode > 0) {
+            String responsePayload = _readResponseBody();
+#ifdef ENABLE_CANCELLATION
+            if (_requestCancelled()) {
+                _httpClient.end();
+                return ""; // The payload is incomplete
+            }
+#endif
+            // Store the raw response
+            _tcRawResponse = responsePayload;
+            
+            #ifdef ENABLE_DEBUG_OUTPUT
+            Serial.println("---------- AI Tool Calls Follow-up Response ----------");
+            Serial.println("HTTP Code: " + String(httpCode));
+            Serial.println("Payload: " + responsePayload);
+            Serial.println("-----------------------------------------------------");
+            #endif
+            
+            if (httpCode == HTTP_CODE_OK) {
+                // Parse response - same as regular tool calls
+                String responseContent = _platformHandler->parseToolCallsResponseBody(
+                    responsePayload, _lastError, _respDoc);
+                if (_responseOverflowed()) responseContent = "";
+                
+                if (responseContent.isEmpty() && _lastError.isEmpty()) {
+                    _lastError = "Handler failed to parse tool calls follow-up response.";
+                } else {
+                    #ifdef ENABLE_RATE_LIMITER
+                    _rateLimitSettle();
+                    #endif
+                    // Track finish reason for potential further follow-up
+                    String finishReason = _platformHandler->getFinishReason();
+                    if (finishReason == "tool_calls" || finishReason == "tool_use") {
+                        // If the response requests more tool calls, update tracking
+                        _lastMessageWasToolCalls = true;
+                        _lastAssistantToolCallsJson = responseContent;
+                        // Note: we don't update _lastUserMessage as we want to maintain the original context
+                    } else {
+                        // If the response is a regular message, mark that we can't do more follow-ups
+                        _lastMessageWasToolCalls = false;
+                    }
+                }
+                
+                _httpClient.end(); // Clean up connection
+                return responseContent;
+            } else {
+                _lastError = "HTTP Error: " + String(httpCode) + " - Response: " + responsePayload;
+            }
+        } else {
+            _lastError = _requestFailedError(httpCode);
+        }
+        _httpClient.end(); // Clean up connection
+    } else {
+        _lastError = "HTTP Client failed to begin connection to: " + url;
+    }
+    
+    return ""; // Return empty string on error
+}
+#endif // ENABLE_TOOL_CALLS
+
+#ifdef ENABLE_FAILOVER
+// --- Provider Failover ---
+bool ESP32_AI_Connect::addFailoverTarget(const char* platformIdentifier, const char* apiKey,
+                                         const char* modelName, const char* endpointUrl) {
+    if (_failoverTargetCount >= AI_API_FAILOVER_MAX_TARGETS - 1) {
+        _lastError = "Too many failover targets (maximum is " + String(AI_API_FAILOVER_MAX_TARGETS - 1) + ")";
+        return false;
+    }
+
+    String platformStr = platformIdentifier;
+    platformStr.toLowerCase();
+    // Not cached: a target may use the same platform as the active one, and hedging runs both at once
+    AI_API_Platform_Handler* handler = AI_API_Handler_Registry::create(platformStr);
+    if (handler == nullptr) {
+        _lastError = "Platform '" + String(platformIdentifier) + "' is not registered (built-in platforms must be enabled in ESP32_AI_Connect_config.h)";
+        return false;
+    }
+    handler->setPromptCaching(_promptCaching, _promptCacheKey);
+
+    FailoverTarget& target = _failoverTargets[_failoverTargetCount];
+    target.handler = handler;
+    target.apiKey = apiKey;
+    target.modelName = modelName;
+    target.endpoint = endpointUrl ? endpointUrl : "";
+    _failoverTargetCount++;
+    _targetHealth[_failoverTargetCount] = TargetHealth();
+#ifdef ENABLE_LATENCY_ROUTING
+    _targetLatency[_failoverTargetCount].reset();
+#endif
+    return true;
+}
+
+void ESP32_AI_Connect::clearFailoverTargets() {
+    for (int i = 0; i < _failoverTargetCount; i++) {
+        delete _failoverTargets[i].handler;
+        _failoverTargets[i] = FailoverTarget();
+    }
+    _failoverTargetCount = 0;
+}
+
+int ESP32_AI_Connect::getFailoverTargetCount() const {
+    return _failoverTargetCount;
+}
+
+int ESP32_AI_Connect::getLastServedTarget() const {
+    return _lastServedTarget;
+}
+
+int ESP32_AI_Connect::getTargetFailureCount(int index) const {
+    if (index < 0 || index > _failoverTargetCount) return 0;
+    return _targetHealth[index].failures;
+}
+
+bool ESP32_AI_Connect::isTargetAvailable(int index) const {
+    if (index < 0 || index > _failoverTargetCount) return false;
+    const TargetHealth& health = _targetHealth[index];
+    // After the cool-down the breaker lets one request through; another failure reopens it
+    return health.failures < AI_API_FAILOVER_FAILURE_THRESHOLD ||
+           (uint32_t)(millis() - health.openedAt) >= AI_API_FAILOVER_COOLDOWN_MS;
+}
+
+#ifdef ENABLE_LATENCY_ROUTING
+// --- Latency Routing ---
+void ESP32_AI_Connect::setLatencyRouting(bool enable, float exploration) {
+    _latencyRouting = enable;
+    _routingExploration = constrain(exploration, 0.0f, 1.0f);
+}
+
+bool ESP32_AI_Connect::getLatencyRouting() const {
+    return _latencyRouting;
+}
+
+int ESP32_AI_Connect::getLastRoutedTarget() const {
+    return _lastRoutedTarget;
+}
+
+bool ESP32_AI_Connect::wasLastRouteExploration() const {
+    return _lastRouteExplored;
+}
+
+const AI_API_Latency_Stats* ESP32_AI_Connect::getTargetLatency(int index) const {
+    if (index < 0 || index > _failoverTargetCount) return nullptr;
+    return &_targetLatency[index];
+}
+
+uint32_t ESP32_AI_Connect::getLastTTFB() const {
+    return _lastTtfbMs;
+}
+
+uint32_t ESP32_AI_Connect::getLastTTFT() const {
+    return _lastTtftMs;
+}
+
+uint32_t ESP32_AI_Connect::getLastTotalLatency() const {
+    return _lastTotalMs;
+}
+
+void ESP32_AI_Connect::resetLatencyStats() {
+    for (int i = 0; i < AI_API_FAILOVER_MAX_TARGETS; i++) {
+        _targetLatency[i].reset();
+    }
+}
+#endif
+
+#ifdef ENABLE_HEDGING
+// --- Hedged Requests ---
+void ESP32_AI_Connect::setHedging(uint32_t delayMs) {
+    _hedgeDelayMs = delayMs;
+}
+
+uint32_t ESP32_AI_Connect::getHedgingDelay() const {
+    return _hedgeDelayMs;
+}
+
+uint32_t ESP32_AI_Connect::getHedgeEligibleCount() const {
+    return _hedgeEligible;
+}
+
+uint32_t ESP32_AI_Connect::getHedgeSentCount() const {
+    return _hedgeSent;
+}
+
+uint32_t ESP32_AI_Connect::getHedgeWinCount() const {
+    return _hedgeWins;
+}
+
+float ESP32_AI_Connect::getHedgeRate() const {
+    return _hedgeEligible ? (float)_hedgeSent / _hedgeEligible : 0.0f;
+}
+
+void ESP32_AI_Connect::resetHedgeStats() {
+    _hedgeEligible = 0;
+    _hedgeSent = 0;
+    _hedgeWins = 0;
+}
+
+int ESP32_AI_Connect::_pickHedgeTarget(const int* order, int first, bool anyAvailable) const {
+    if (_hedgeDelayMs == 0) return -1;
+    for (int k = first + 1; k <= _failoverTargetCount; k++) {
+        if (!anyAvailable || isTargetAvailable(order[k])) return order[k];
+    }
+    return -1;
+}
+
+String ESP32_AI_Connect::_hedgedChat(const FailoverTarget& hedge, const String& userMessage,
+                                     const AI_API_Chat_Session* session, int& outcome) {
+    outcome = 0;
+    HedgeRace race;
+    race.handler = hedge.handler;
+    race.url = hedge.handler->getEndpoint(hedge.modelName, hedge.apiKey, hedge.endpoint);
+    race.apiKey = hedge.apiKey;
+    {
+        // Own JSON document: the primary request uses the shared ones
+        AI_API_Json_Document reqDoc;
+        race.requestBody = hedge.handler->buildRequestBody(hedge.modelName, _systemRole,
+                                                           _temperature, _maxTokens,
+                                                           userMessage, reqDoc, _chatCustomParams, session);
+        if (reqDoc.overflowed()) {
+            _jsonOverflows++;
+            race.requestBody = ""; // Incomplete: send no hedge
+        }
+    }
+    race.delayMs = _hedgeDelayMs;
+    race.connectMs = _connectTimeoutMs;
+    race.tlsMs = _tlsTimeoutMs;
+    race.firstByteMs = _firstByteTimeoutMs;
+    race.deadlineMs = _deadlineRemainingMs();
+    race.startedAt = millis();
+#ifdef ENABLE_CANCELLATION
+    race.cancelToken = _cancelToken;
+#endif
+    race.lock = xSemaphoreCreateMutex();
+    race.go = xSemaphoreCreateBinary();
+    race.finished = xSemaphoreCreateBinary();
+
+    TaskHandle_t task = nullptr;
+    bool started = !race.url.isEmpty() && !race.requestBody.isEmpty() &&
+                   race.lock && race.go && race.finished &&
+                   xTaskCreate(_hedgeTask, "ai_hedge", AI_API_HEDGE_TASK_STACK, &race,
+                               uxTaskPriorityGet(nullptr), &task) == pdPASS;
+
+    String responseContent;
+    if (!started) {
+        #ifdef ENABLE_DEBUG_OUTPUT
+        Serial.println("Hedging: could not prepare the hedge, sending unhedged");
+        #endif
+        responseContent = _chat(userMessage, session);
+    } else {
+        _hedgeRace = &race;
+        _wifiClient.setLostFlag(&race.primaryLost);
+        responseContent = _chat(userMessage, session);
+        _hedgeRace = nullptr;
+
+        // Decide the race if _chat() did not: a usable answer ends it, a failure sends the hedge now
+        xSemaphoreTake(race.lock, portMAX_DELAY);
+        if (race.winner == HedgeRace::NONE) {
+            bool failed = responseContent.isEmpty() &&
+                          (_chatResponseCode < 0 || _chatResponseCode == 429 || _chatResponseCode >= 500);
+#ifdef ENABLE_CANCELLATION
+            if (_isCancelled()) failed = false; // Ends the race without an answer
+#endif
+            if (failed) {
+                race.primaryFailed = true;
+            } else {
+                race.winner = HedgeRace::PRIMARY;
+                race.hedgeLost = true;
+            }
+        }
+        xSemaphoreGive(race.lock);
+        xSemaphoreGive(race.go);
+        xSemaphoreTake(race.finished, portMAX_DELAY);
+
+        _wifiClient.setLostFlag(nullptr);
+        if (race.primaryLost) {
+            // The primary gave up on a response still under way; never reuse its connection
+            _httpClient.end();
+            _wifiClient.stop();
+            _connHost = "";
+        }
+
+        if (race.hedgeSent) {
+            _hedgeSent++;
+            outcome = 1;
+        }
+        if (race.winner == HedgeRace::HEDGE) {
+            outcome = 2;
+            _hedgeWins++;
+            responseContent = race.content;
+            _chatRawResponse = race.rawResponse;
+            _chatResponseCode = race.responseCode;
+            _lastError = race.error;
+            #ifdef ENABLE_LATENCY_ROUTING
+            _lastTtfbMs = race.ttfbMs;
+            _lastTotalMs = race.totalMs;
+            #endif
+        }
+
+        #ifdef ENABLE_DEBUG_OUTPUT
+        if (race.hedgeSent) {
+            Serial.println(String("Hedging: hedge ") + (outcome == 2 ? "answered first" : "lost or failed"));
+        }
+        #endif
+    }
+
+    if (race.lock) vSemaphoreDelete(race.lock);
+    if (race.go) vSemaphoreDelete(race.go);
+    if (race.finished) vSemaphoreDelete(race.finished);
+    return responseContent;
+}
+
+bool ESP32_AI_Connect::_claimHedgeRace(int httpCode) {
+    HedgeRace& race = *_hedgeRace;
+    bool answered = httpCode > 0 && httpCode != 429 && httpCode < 500;
+
+    xSemaphoreTake(race.lock, portMAX_DELAY);
+    bool lost = race.winner == HedgeRace::HEDGE;
+    if (!lost && answered && race.winner == HedgeRace::NONE) {
+        race.winner = HedgeRace::PRIMARY;
+        race.hedgeLost = true;
+    }
+    xSemaphoreGive(race.lock);
+
+    if (answered && !lost) xSemaphoreGive(race.go); // The hedge is no longer needed
+    return !lost;
+}
+
+void ESP32_AI_Connect::_hedgeTask(void* param) {
+    HedgeRace& race = *(HedgeRace*)param;
+
+    // Wait for the hedge delay unless the primary answers or fails first
+    xSemaphoreTake(race.go, pdMS_TO_TICKS(race.delayMs));
+
+    {
+        // Own connection: the primary request is using the client's
+        AI_API_Race_Client client;
+        HTTPClient http;
+        client.setInsecure();
+        client.setLostFlag(&race.hedgeLost);
+#ifdef ENABLE_CANCELLATION
+        client.setCancelToken(race.cancelToken);
+#endif
+
+        xSemaphoreTake(race.lock, portMAX_DELAY);
+        race.hedgeSent = race.winner == HedgeRace::NONE && !client.isAborted();
+        xSemaphoreGive(race.lock);
+
+        if (race.hedgeSent) {
+            uint32_t elapsed = millis() - race.startedAt;
+            uint32_t remaining = race.deadlineMs == UINT32_MAX ? UINT32_MAX :
+                                 (elapsed < race.deadlineMs ? race.deadlineMs - elapsed : 0);
+            uint32_t requestStart = millis();
+            int httpCode = 0;
+            if (http.begin(client, race.url)) {
+                race.handler->setHeaders(http, race.apiKey);
+                // The race's copies of the budgets: the hedge task must not read the client's fields
+                AI_API_Timeouts::apply(http, client, race.connectMs, race.tlsMs, race.firstByteMs, remaining);
+                httpCode = http.POST(race.requestBody);
+            }
+            race.ttfbMs = millis() - requestStart;
+            bool answered = httpCode > 0 && httpCode != 429 && httpCode < 500;
+
+            xSemaphoreTake(race.lock, portMAX_DELAY);
+            bool won = answered && race.winner == HedgeRace::NONE && !client.isAborted();
+            if (won) {
+                race.winner = HedgeRace::HEDGE;
+                race.primaryLost = true; // The primary request gives up at its next poll
+            }
+            xSemaphoreGive(race.lock);
+
+            race.responseCode = httpCode;
+            if (won) {
+                race.rawResponse = http.getString();
+                race.totalMs = millis() - requestStart;
+                if (httpCode == HTTP_CODE_OK) {
+                    AI_API_Json_Document respDoc;
+                    race.content = race.handler->parseResponseBody(race.rawResponse, race.error, respDoc);
+                    if (respDoc.overflowed()) {
+                        race.content = "";
+                        race.error = "Response JSON ran out of memory.";
+                    } else if (race.content.isEmpty() && race.error.isEmpty()) {
+                        race.error = "Handler failed to parse response or returned empty content.";
+                    }
+                } else {
+                    race.error = "HTTP Error: " + String(httpCode) + " - Response: " + race.rawResponse;
+                }
+            }
+            http.end();
+        }
+        client.stop(); // This task's own connection, closed here whether it won or lost
+    } // Release the connection before the caller may return
+
+    xSemaphoreGive(race.finished); // 'race' belongs to the caller from here on
+    vTaskDelete(nullptr);
+}
+#endif
+
+void ESP32_AI_Connect::_swapTarget(int index) {
+    if (index <= 0) return; // The begin() target is already active
+    FailoverTarget& target = _failoverTargets[index - 1];
+    std::swap(_platformHandler, target.handler);
+    std::swap(_apiKey, target.apiKey);
+    std::swap(_modelName, target.modelName);
+    std::swap(_customEndpoint, target.endpoint);
+#ifdef ENABLE_RATE_LIMITER
+    std::swap(_rateLimiter, target.rateLimiter);
+#endif
+}
+
+void ESP32_AI_Connect::_recordTargetResult(int index, bool failed) {
+    TargetHealth& health = _targetHealth[index];
+    if (!failed) {
+        health.failures = 0;
+        return;
+    }
+    if (health.failures < 255) health.failures++;
+    if (health.failures >= AI_API_FAILOVER_FAILURE_THRESHOLD) {
+        health.openedAt = millis();
+    }
+}
+
+void ESP32_AI_Connect::_orderTargets(int* order, bool byFirstToken) {
+    int count = _failoverTargetCount + 1;
+    for (int i = 0; i < count; i++) order[i] = i;
+
+#ifdef ENABLE_LATENCY_ROUTING
+    _lastRouteExplored = false;
+    if (_latencyRouting) {
+        // Fastest first by EWMA; targets without samples yet go first so they get measured
+        AI_API_Latency_Stats::Metric m = byFirstToken ? AI_API_Latency_Stats::TTFT : AI_API_Latency_Stats::TOTAL;
+        for (int i = 1; i < count; i++) {
+            int target = order[i];
+            float score = _targetLatency[target].getSampleCount(m) ? _targetLatency[target].getEwma(m) : 0;
+            int j = i;
+            while (j > 0) {
+                int prev = order[j - 1];
+                float prevScore = _targetLatency[prev].getSampleCount(m) ? _targetLatency[prev].getEwma(m) : 0;
+                if (prevScore <= score) break;
+                order[j] = prev;
+                j--;
+            }
+            order[j] = target;
+        }
+
+        // Exploration: now and then lead with another target to keep its estimates fresh
+        if (count > 1 && (esp_random() % 1000) < (uint32_t)(_routingExploration * 1000)) {
+            int pick = 1 + esp_random() % (count - 1);
+            int first = order[0];
+            order[0] = order[pick];
+            order[pick] = first;
+            _lastRouteExplored = true;
+        }
+        _lastRoutedTarget = order[0];
+
+        #ifdef ENABLE_DEBUG_OUTPUT
+        Serial.println("Latency routing: target " + String(order[0]) + (_lastRouteExplored ? " (exploring)" : ""));
+        #endif
+    }
+#endif
+}
+#endif
+
+String ESP32_AI_Connect::_sendChat(const String& userMessage, const AI_API_Chat_Session* session) {
+    _startRequest();
+#ifdef ENABLE_CANCELLATION
+    AI_API_Cancel_Scope cancelScope(_cancelToken, _wifiClient);
+#endif
+#ifdef ENABLE_FAILOVER
+    _lastServedTarget = -1;
+    if (_failoverTargetCount > 0) {
+        // With every breaker open, try all targets rather than fail without a request
+        bool anyAvailable = false;
+        for (int i = 0; i <= _failoverTargetCount && !anyAvailable; i++) {
+            anyAvailable = isTargetAvailable(i);
+        }
+
+        int order[AI_API_FAILOVER_MAX_TARGETS];
+        _orderTargets(order, false);
+        
+        String responseContent;
+#ifdef ENABLE_HEDGING
+        bool firstAttempt = true;
+        int skipTarget = -1; // Hedge target that already failed in this call
+#endif
+        for (int k = 0; k <= _failoverTargetCount; k++) {
+            int i = order[k];
+            if (anyAvailable && !isTargetAvailable(i)) continue;
+            if (_deadlineRemainingMs() == 0) break; // Out of time: report the last attempt
+#ifdef ENABLE_CANCELLATION
+            if (_isCancelled()) break;
+#endif
+            int served = i;
+
+#ifdef ENABLE_HEDGING
+            if (i == skipTarget) continue;
+            // Only the first attempt is hedged, with the next target in line
+            int hedge = firstAttempt ? _pickHedgeTarget(order, k, anyAvailable) : -1;
+            int hedgeOutcome = 0;
+            firstAttempt = false;
+            FailoverTarget hedgeTarget;
+            if (hedge >= 0) {
+                _hedgeEligible++;
+                if (hedge == 0) {
+                    hedgeTarget.handler = _platformHandler;
+                    hedgeTarget.apiKey = _apiKey;
+                    hedgeTarget.modelName = _modelName;
+                    hedgeTarget.endpoint = _customEndpoint;
+                } else {
+                    hedgeTarget = _failoverTargets[hedge - 1];
+                }
+            }
+
+            _swapTarget(i);
+            if (hedge >= 0) {
+                responseContent = _hedgedChat(hedgeTarget, userMessage, session, hedgeOutcome);
+                if (hedgeOutcome == 2) served = hedge;
+            } else {
+                responseContent = _chat(userMessage, session);
+            }
+            _swapTarget(i);
+#else
+            _swapTarget(i);
+            responseContent = _chat(userMessage, session);
+            _swapTarget(i);
+#endif
+
+            // Connection failures, timeouts (negative codes), rate limits and server errors are
+            // worth another target; a response code of 0 means nothing was sent
+            bool failed = responseContent.isEmpty() &&
+                          (_chatResponseCode < 0 || _chatResponseCode == 429 || _chatResponseCode >= 500);
+            if (!failed) {
+                if (_chatResponseCode > 0) _recordTargetResult(served, false);
+                #ifdef ENABLE_LATENCY_ROUTING
+                if (_chatResponseCode == HTTP_CODE_OK) {
+                    _targetLatency[served].addSample(AI_API_Latency_Stats::TTFB, _lastTtfbMs);
+                    _targetLatency[served].addSample(AI_API_Latency_Stats::TOTAL, _lastTotalMs);
+                }
+                #endif
+                if (_chatResponseCode > 0 || !responseContent.isEmpty()) _lastServedTarget = served;
+                return responseContent;
+            }
+            _recordTargetResult(i, true);
+            #ifdef ENABLE_HEDGING
+            if (hedgeOutcome == 1) {
+                // The hedge was sent and did not answer either
+                _recordTargetResult(hedge, true);
+                skipTarget = hedge;
+            }
+            #endif
+            #ifdef ENABLE_DEBUG_OUTPUT
+            Serial.println("Failover: target " + String(i) + " failed (" + String(_chatResponseCode) + ")");
+            #endif
+        }
+        return responseContent; // Every target failed; _lastError describes the last attempt
+    }
+#endif
+    String responseContent = _chat(userMessage, session);
+#ifdef ENABLE_FAILOVER
+    if (_chatResponseCode > 0 || !responseContent.isEmpty()) _lastServedTarget = 0;
+#endif
+    return responseContent;
+}
+
+// --- Main Chat Function (Delegates to Handler) ---
+String ESP32_AI_Connect::chat(const String& userMessage) {
+#ifdef ENABLE_SINGLE_FLIGHT
+    uint64_t targetKey = _chatFlightTarget;
+    if (targetKey != 0) {
+        // Identical requests already in flight from other tasks share that request's result
+        bool leader;
+        int slot = _chatFlights.join(_chatRequestKey(targetKey, userMessage), leader);
+        if (!leader) {
+            String responseContent;
+            String error;
+            _chatFlights.wait(slot, responseContent, error);
+            AI_API_Request_Lock requestLock(_requestMutex); // _lastError is shared with the other tasks
+            _lastError = error;
+            return responseContent;
+        }
+        
+        AI_API_Request_Lock requestLock(_requestMutex);
+        String responseContent = _sendChat(userMessage, nullptr);
+        _chatFlights.complete(slot, responseContent, _lastError);
+        return responseContent;
+    }
+#endif
+    return _sendChat(userMessage, nullptr);
+}
+
+#ifdef ENABLE_SINGLE_FLIGHT
+uint32_t ESP32_AI_Connect::getCoalescedRequestCount() const {
+    return _chatFlights.getCoalescedCount();
+}
+#endif
+
+#ifdef ENABLE_RATE_LIMITER
+void ESP32_AI_Connect::setRateLimiter(AI_API_Rate_Limiter* limiter, uint32_t maxWaitMs) {
+    _rateLimiter = limiter;
+    _rateLimitMaxWaitMs = maxWaitMs;
+}
+
+AI_API_Rate_Limiter* ESP32_AI_Connect::getRateLimiter() const {
+    return _rateLimiter;
+}
+
+bool ESP32_AI_Connect::_rateLimitAcquire(const String& requestBody, int maxTokens) {
+    _rateLimitReserved = 0;
+    if (_rateLimiter == nullptr) return true;
+
+    // Prompt (about 4 bytes per token) plus the completion budget; settled once usage is known
+    int tokens = requestBody.length() / 4 + (maxTokens > 0 ? maxTokens : 0);
+    uint32_t waitMs = 0;
+    if (!_rateLimiter->acquire(tokens, min(_rateLimitMaxWaitMs, _deadlineRemainingMs()), waitMs)) {
+        _lastError = "Rate limit reached: request not sent (budget available again in " +
+                     String(waitMs) + " ms)";
+        return false;
+    }
+    _rateLimitReserved = tokens;
+    return true;
+}
+
+void ESP32_AI_Connect::_rateLimitUpdate(int httpCode) {
+    if (_rateLimiter != nullptr) _rateLimiter->update(_httpClient, httpCode);
+}
+
+void ESP32_AI_Connect::_rateLimitSettle() {
+    if (_rateLimiter != nullptr && _rateLimitReserved > 0) {
+        _rateLimiter->settle(_rateLimitReserved, _platformHandler->getTotalTokens());
+        _rateLimitReserved = 0;
+    }
+}
+#endif
+
+#ifdef ENABLE_RETRY
+void ESP32_AI_Connect::setRetryPolicy(uint8_t maxAttempts, uint32_t baseDelayMs,
+                                      uint32_t maxDelayMs, uint32_t deadlineMs, bool retryAfterSend) {
+    _retryPolicy.maxAttempts = max((uint8_t)1, maxAttempts);
+    _retryPolicy.baseDelayMs = baseDelayMs;
+    _retryPolicy.maxDelayMs = max(baseDelayMs, maxDelayMs);
+    _retryPolicy.deadlineMs = deadlineMs;
+    _retryPolicy.retryAfterSend = retryAfterSend;
+}
+
+const AI_API_Retry_Policy& ESP32_AI_Connect::getRetryPolicy() const {
+    return _retryPolicy;
+}
+
+int ESP32_AI_Connect::getLastAttemptCount() const {
+    return _lastAttempts;
+}
+
+uint32_t ESP32_AI_Connect::getRetryCount() const {
+    return _retries;
+}
+#endif
+
+#ifdef ENABLE_CANCELLATION
+void ESP32_AI_Connect::setCancelToken(AI_API_Cancel_Token* token) {
+    _cancelToken = token;
+}
+
+AI_API_Cancel_Token* ESP32_AI_Connect::getCancelToken() const {
+    return _cancelToken;
+}
+
+bool ESP32_AI_Connect::_isCancelled() const {
+    return _cancelToken != nullptr && _cancelToken->isCancelled();
+}
+
+bool ESP32_AI_Connect::_requestCancelled() {
+    if (!_isCancelled()) return false;
+    _cancelToken->markAborted();
+    _lastError = "Request cancelled";
+    return true;
+}
+#endif
+
+void ESP32_AI_Connect::_collectResponseHeaders() {
+    const char* keys[24];
+    size_t keyCount = 0;
+    const char** featureKeys = nullptr;
+    size_t featureKeyCount = 0;
+#ifdef ENABLE_RETRY
+    featureKeys = AI_API_Retry_Policy::getHeaderKeys();
+    featureKeyCount = AI_API_Retry_Policy::getHeaderKeyCount();
+#endif
+#ifdef ENABLE_RATE_LIMITER
+    if (_rateLimiter != nullptr) {
+        // Includes the retry-after headers
+        featureKeys = AI_API_Rate_Limiter::getHeaderKeys();
+        featureKeyCount = AI_API_Rate_Limiter::getHeaderKeyCount();
+    }
+#endif
+    for (size_t i = 0; i < featureKeyCount && keyCount < 22; i++) keys[keyCount++] = featureKeys[i];
+#ifdef ENABLE_COMPRESSION
+    keys[keyCount++] = "Content-Encoding";
+    keys[keyCount++] = "Transfer-Encoding";
+#endif
+    if (keyCount > 0) _httpClient.collectHeaders(keys, keyCount);
+}
+
+String ESP32_AI_Connect::_readResponseBody() {
+#ifdef ENABLE_LAZY_ALLOCATION
+    _docsUsedAt = millis(); // Idle from the end of the request
+#endif
+#ifdef ENABLE_COMPRESSION
+    AI_API_Gzip_Decoder::Format format;
+    if (_responseFormat(format)) {
+        String body; // The handlers parse a String, so the inflated body is held whole
+        AI_API_Gzip_Decoder decoder;
+        int written = decoder.begin(body, format) ? _httpClient.writeToStream(&decoder) : -1;
+        _memoryUsage.sample();
+        _lastWireBytes = decoder.getCompressedBytes();
+        _lastBodyBytes = decoder.getInflatedBytes();
+        if (written < 0 || !decoder.isFinished()) {
+            #ifdef ENABLE_DEBUG_OUTPUT
+            Serial.println("Decompression failed: " + String(decoder.hasError() ? decoder.getError() : "body incomplete"));
+            #endif
+            return ""; // Parsed as an empty response
+        }
+        #ifdef ENABLE_DEBUG_OUTPUT
+        Serial.println("Response inflated from " + String(_lastWireBytes) + " to " + String(_lastBodyBytes) + " bytes");
+        #endif
+        return body;
+    }
+    String body = _httpClient.getString();
+    _memoryUsage.sample();
+    _lastWireBytes = body.length();
+    _lastBodyBytes = body.length();
+    return body;
+#else
+    String body = _httpClient.getString();
+    _memoryUsage.sample();
+    return body;
+#endif
+}
+
+#ifdef ENABLE_COMPRESSION
+void ESP32_AI_Connect::setCompression(bool enable) {
+    _compression = enable;
+}
+
+bool ESP32_AI_Connect::getCompression() const {
+    return _compression;
+}
+
+uint32_t ESP32_AI_Connect::getLastWireBytes() const {
+    return _lastWireBytes;
+}
+
+uint32_t ESP32_AI_Connect::getLastBodyBytes() const {
+    return _lastBodyBytes;
+}
+
+bool ESP32_AI_Connect::_responseFormat(AI_API_Gzip_Decoder::Format& format) {
+    return _compression && AI_API_Gzip_Decoder::formatFor(_httpClient.header("Content-Encoding"), format);
+}
+#endif
+
+int ESP32_AI_Connect::_postAttempt(const String& requestBody) {
+    _collectResponseHeaders();
+    _applyTimeouts(_httpClient, _wifiClient);
+    if (_deadlineRemainingMs() == 0) {
+        _lastTimeoutPhase = TimeoutPhase::DEADLINE; // Not sent
+        return HTTPC_ERROR_READ_TIMEOUT;
     }
-    
-    // Check basic structure
-    if (!_reqDoc.is<JsonArray>()) {
-        _lastError = "Tool results must be a JSON array.";
-        return "";
+#ifdef ENABLE_CANCELLATION
+    if (_isCancelled()) return HTTPC_ERROR_CONNECTION_LOST; // Not sent
+#endif
+
+#ifdef ENABLE_COMPRESSION
+    // Over HTTP/1.1, HTTPClient sends its own "Accept-Encoding: identity;...,*;q=0", which
+    // would leave the server two conflicting headers. It leaves that header out of HTTP/1.0
+    // requests, and servers answer those without chunked framing.
+    // useHTTP10() also sets reuse, so it goes first and setReuse() overrides it.
+    _httpClient.useHTTP10(_compression);
+    if (_compression) {
+        _httpClient.addHeader("Accept-Encoding", "gzip, deflate");
+    }
+    _httpClient.setReuse(_keepAliveMs > 0 && !_compression); // HTTP/1.0 closes the connection
+#else
+    _httpClient.setReuse(_keepAliveMs > 0);
+#endif
+    _lastConnectionWarm = _wifiClient.connected(); // HTTPClient sends on an open connection
+#ifdef ENABLE_DNS_CACHE
+    if (!_lastConnectionWarm && !_connectCached(_connHost)) {
+        return HTTPC_ERROR_CONNECTION_REFUSED; // Host name does not resolve; not sent
     }
-    
-    // Validate each tool result
-    JsonArray resultsArray = _reqDoc.as<JsonArray>();
-    for (JsonObject result : resultsArray) {
-        if (!result.containsKey("tool_call_id")) {
-            _lastError = "Each tool result must have a 'tool_call_id' field.";
-            return "";
-        }
-        if (!result.containsKey("function")) {
-            _lastError = "Each tool result must have a 'function' field.";
-            return "";
-        }
-        JsonObject function = result["function"];
-        if (!function.containsKey("name")) {
-            _lastError = "Each tool result function must have a 'name' field.";
-            return "";
+#endif
+
+    uint32_t sentAt = millis();
+    int httpCode = _httpClient.POST(requestBody);
+    _recordTimeout(httpCode, millis() - sentAt);
+    _memoryUsage.sample(); // Request body and TLS session
+#ifdef ENABLE_RATE_LIMITER
+    _rateLimitUpdate(httpCode);
+#endif
+    return httpCode;
+}
+
+int ESP32_AI_Connect::_postRequest(const String& url, const String& requestBody) {
+    _lastTimeoutPhase = TimeoutPhase::NONE;
+    _connHost = endpointHost(url);
+    _connIdleMs = _keepAliveMs;
+    int httpCode = _postAttempt(requestBody);
+    _connUsedAt = millis();
+
+#ifdef ENABLE_RETRY
+    _lastAttempts = 1;
+    uint32_t startedAt = millis();
+    while (_lastAttempts < _retryPolicy.maxAttempts && _retryPolicy.isRetryable(httpCode)) {
+#ifdef ENABLE_HEDGING
+        if (_hedgeRace != nullptr) break; // The hedge already covers this request
+#endif
+#ifdef ENABLE_CANCELLATION
+        if (_isCancelled()) break;
+#endif
+        uint32_t waitMs = _retryPolicy.backoffMs(_lastAttempts);
+        if (httpCode > 0) waitMs = max(waitMs, AI_API_Retry_Policy::retryAfterMs(_httpClient));
+        if ((_retryPolicy.deadlineMs > 0 && millis() - startedAt + waitMs >= _retryPolicy.deadlineMs) ||
+            waitMs >= _deadlineRemainingMs()) {
+            break; // The retry could not start in time; report this attempt's result
         }
-        if (!function.containsKey("output")) {
-            _lastError = "Each tool result function must have an 'output' field.";
-            return "";
+
+        #ifdef ENABLE_DEBUG_OUTPUT
+        Serial.println("Retry: attempt " + String(_lastAttempts) + " failed (" + String(httpCode) +
+                       "), retrying in " + String(waitMs) + " ms");
+        #endif
+        _httpClient.end();
+        if (httpCode < 0) _wifiClient.stop(); // Start over with a fresh TLS session
+#ifdef ENABLE_CANCELLATION
+        if (_cancelToken != nullptr && _cancelToken->sleep(waitMs)) break;
+        if (_cancelToken == nullptr) delay(waitMs);
+#else
+        delay(waitMs);
+#endif
+
+        if (!_httpClient.begin(_wifiClient, url)) break;
+        _platformHandler->setHeaders(_httpClient, _apiKey);
+#ifdef ENABLE_RATE_LIMITER
+        uint32_t limiterWaitMs;
+        if (_rateLimiter != nullptr &&
+            !_rateLimiter->acquire(0, min(_rateLimitMaxWaitMs, _deadlineRemainingMs()), limiterWaitMs)) {
+            break; // No request budget for the retry
         }
+#endif
+
+        _lastAttempts++;
+        _retries++;
+        httpCode = _postAttempt(requestBody);
+        _connUsedAt = millis();
     }
-    
-    // --- Build and send the follow-up request ---
-    String url = _platformHandler->getEndpoint(_modelName, _apiKey, _customEndpoint);
-    if (url.isEmpty()) {
-        _lastError = "Failed to get endpoint URL from platform handler.";
-        return "";
-    }
-    
-    // Build request body using the platform handler's tool calls follow-up method
-    String requestBody = _platformHandler->buildToolCallsFollowUpRequestBody(
-        _modelName, _tcToolsArray, _tcToolsArraySize,
-        _tcSystemRole, _tcToolChoice,
-        _lastUserMessage, _lastAssistantToolCallsJson,
-        toolResultsJson, _tcFollowUpMaxToken, _tcFollowUpToolChoice, _reqDoc);
-    
-    if (requestBody.isEmpty()) {
-        if (_lastError.isEmpty()) _lastError = "Failed to build tool calls follow-up request body.";
-        return "";
+#endif
+    return httpCode;
+}
+
+#ifdef ENABLE_CHAT_SESSION
+String ESP32_AI_Connect::chat(const String& userMessage, AI_API_Chat_Session& session) {
+#ifdef ENABLE_SINGLE_FLIGHT
+    AI_API_Request_Lock requestLock(_requestMutex);
+#endif
+#ifdef ENABLE_TOKEN_ESTIMATOR
+    _fitSessionToBudget(_systemRole, userMessage, session);
+#endif
+    String responseContent = _sendChat(userMessage, &session);
+    if (!responseContent.isEmpty()) {
+        // Only completed exchanges become history
+        session.addUserTurn(userMessage);
+        session.addAssistantTurn(responseContent);
     }
+    return responseContent;
+}
+
+int ESP32_AI_Connect::getChatHistoryTurnsSent() const {
+    return _chatHistoryTurnsSent;
+}
+
+size_t ESP32_AI_Connect::getChatHistoryBytesSent() const {
+    return _chatHistoryBytesSent;
+}
+
+void ESP32_AI_Connect::_trackChatHistory(const AI_API_Chat_Session* session) {
+    _chatHistoryTurnsSent = session ? session->getTurnCount() : 0;
+    _chatHistoryBytesSent = session ? session->getTextBytes() : 0;
     
     #ifdef ENABLE_DEBUG_OUTPUT
-    Serial.println("---------- AI Tool Calls Follow-up Request ----------");
-    Serial.println("URL: " + url);
-    Serial.println("Body: " + requestBody);
-    Serial.println("--------------------------------------------------");
-    #endif
-    
-    // Perform HTTP POST Request
-    _httpClient.end(); // Ensure previous connection is closed
-    if (_httpClient.begin(_wifiClient, url)) {
-        _platformHandler->setHeaders(_httpClient, _apiKey);
-        _httpClient.setTimeout(AI_API_HTTP_TIMEOUT_MS);
-        int httpCode = _httpClient.POST(requestBody);
-        
-        // Store the HTTP response code
-        _tcReplyResponseCode = httpCode;
-        
-        // Handle Response
-        if (httpCode > 0) {
-            String responsePayload = _httpClient.getString();
-            // Store the raw response
-            _tcRawResponse = responsePayload;
-            
-            #ifdef ENABLE_DEBUG_OUTPUT
-            Serial.println("---------- AI Tool Calls Follow-up Response ----------");
-            Serial.println("HTTP Code: " + String(httpCode));
-            Serial.println("Payload: " + responsePayload);
-            Serial.println("-----------------------------------------------------");
-            #endif
-            
-            if (httpCode == HTTP_CODE_OK) {
-                // Parse response - same as regular tool calls
-                String responseContent = _platformHandler->parseToolCallsResponseBody(
-                    responsePayload, _lastError, _respDoc);
-                
-                if (responseContent.isEmpty() && _lastError.isEmpty()) {
-                    _lastError = "Handler failed to parse tool calls follow-up response.";
-                } else {
-                    // Track finish reason for potential further follow-up
-                    String finishReason = _platformHandler->getFinishReason();
-                    if (finishReason == "tool_calls" || finishReason == "tool_use") {
-                        // If the response requests more tool calls, update tracking
-                        _lastMessageWasToolCalls = true;
-                        _lastAssistantToolCallsJson = responseContent;
-                        // Note: we don't update _lastUserMessage as we want to maintain the original context
-                    } else {
-                        // If the response is a regular message, mark that we can't do more follow-ups
-                        _lastMessageWasToolCalls = false;
-                    }
-                }
-                
-                _httpClient.end(); // Clean up connection
-                return responseContent;
-            } else {
-                _lastError = "HTTP Error: " + String(httpCode) + " - Response: " + responsePayload;
-            }
-        } else {
-            _lastError = String("HTTP Request Failed: ") + _httpClient.errorToString(httpCode).c_str();
-        }
-        _httpClient.end(); // Clean up connection
-    } else {
-        _lastError = "HTTP Client failed to begin connection to: " + url;
+    if (session) {
+        Serial.println("Chat session: sending " + String(_chatHistoryTurnsSent) + " turns, " +
+                       String((unsigned long)_chatHistoryBytesSent) + " bytes of history");
     }
-    
-    return ""; // Return empty string on error
+    #endif
 }
-#endif // ENABLE_TOOL_CALLS
+#endif
 
-// --- Main Chat Function (Delegates to Handler) ---
-String ESP32_AI_Connect::chat(const String& userMessage) {
+String ESP32_AI_Connect::_chat(const String& userMessage, const AI_API_Chat_Session* session) {
     _lastError = "";
     String responseContent = "";
     _chatRawResponse = ""; // Clear previous raw response
@@ -659,11 +2511,41 @@ String ESP32_AI_Connect::chat(const String& userMessage) {
         return "";
     }
 
+#ifdef ENABLE_RESPONSE_CACHE
+    // Deterministic single-turn requests can be answered from the response cache
+    _lastResponseCached = false;
+    bool useCache = _responseCache != nullptr && session == nullptr &&
+                    (_temperature == 0 || _cacheAnyTemperature);
+    uint64_t cacheKey = 0;
+    if (useCache) {
+        cacheKey = _chatRequestKey(url, userMessage);
+        if (_responseCache->get(cacheKey, responseContent)) {
+            _lastResponseCached = true;
+            #ifdef ENABLE_DEBUG_OUTPUT
+            Serial.println("Response cache hit - no request sent");
+            #endif
+            return responseContent;
+        }
+    }
+#endif
+
+#ifdef ENABLE_TOKEN_ESTIMATOR
+    if (!_checkPromptBudget(_rawChatTokens(_systemRole, userMessage, session))) {
+        return "";
+    }
+#endif
+
+
     // Build request body using handler and shared JSON doc
     // Using values set by setChatSystemRole, setChatTemperature, setChatMaxTokens, and setChatParameters
+#ifdef ENABLE_CHAT_SESSION
+    _trackChatHistory(session);
+#endif
     String requestBody = _platformHandler->buildRequestBody(_modelName, _systemRole,
                                                             _temperature, _maxTokens,
-                                                            userMessage, _reqDoc, _chatCustomParams);
+                                                            userMessage, _reqDoc, _chatCustomParams,
+                                                            session);
+    if (_requestOverflowed()) requestBody = "";
     if (requestBody.isEmpty()) {
         // Assume handler sets _lastError or check its return value pattern if defined
         if (_lastError.isEmpty()) _lastError = "Failed to build request body (handler returned empty).";
@@ -680,18 +2562,50 @@ String ESP32_AI_Connect::chat(const String& userMessage) {
 
 
     // --- Perform HTTP POST Request ---
-    _httpClient.end(); // Ensure previous connection is closed
+    _prepareConnection(url); // Reuse a warm connection, close any other
     if (_httpClient.begin(_wifiClient, url)) {
         _platformHandler->setHeaders(_httpClient, _apiKey); // Set headers via handler
-        _httpClient.setTimeout(AI_API_HTTP_TIMEOUT_MS); // Use configured timeout
-        int httpCode = _httpClient.POST(requestBody);
+#ifdef ENABLE_RATE_LIMITER
+        if (!_rateLimitAcquire(requestBody, _maxTokens)) {
+            _httpClient.end();
+            _chatResponseCode = 429; // Lets failover move on to the next target
+            return "";
+        }
+#endif
+#ifdef ENABLE_LATENCY_ROUTING
+        uint32_t requestStart = millis();
+#endif
+        int httpCode = _postRequest(url, requestBody);
+#ifdef ENABLE_LATENCY_ROUTING
+        _lastTtfbMs = millis() - requestStart; // POST returns once the response headers are read
+        _lastTtftMs = 0;
+#endif
+        
+#ifdef ENABLE_HEDGING
+        if (_hedgeRace != nullptr && !_claimHedgeRace(httpCode)) {
+            // The hedge answered first; _hedgedChat() closes this connection
+            _httpClient.end();
+            _chatResponseCode = httpCode;
+            _lastError = "Request superseded by its hedge";
+            return "";
+        }
+#endif
         
         // Store the HTTP response code
         _chatResponseCode = httpCode;
 
         // --- Handle Response ---
         if (httpCode > 0) {
-            String responsePayload = _httpClient.getString();
+            String responsePayload = _readResponseBody();
+#ifdef ENABLE_LATENCY_ROUTING
+            _lastTotalMs = millis() - requestStart;
+#endif
+#ifdef ENABLE_CANCELLATION
+            if (_requestCancelled()) {
+                _httpClient.end();
+                return ""; // The payload is incomplete
+            }
+#endif
             // Store the raw response
             _chatRawResponse = responsePayload;
             
@@ -708,15 +2622,27 @@ String ESP32_AI_Connect::chat(const String& userMessage) {
                 // Parse response using handler and shared JSON doc
                 // Handler's parseResponseBody should set _lastError on failure
                 responseContent = _platformHandler->parseResponseBody(responsePayload, _lastError, _respDoc);
+                if (_responseOverflowed()) responseContent = "";
                 // If responseContent is "" but _lastError is also "", handler failed silently
                 if(responseContent.isEmpty() && _lastError.isEmpty()){
                     _lastError = "Handler failed to parse response or returned empty content.";
                 }
+                #ifdef ENABLE_TOKEN_ESTIMATOR
+                _calibrateTokenEstimate();
+                #endif
+                #ifdef ENABLE_RATE_LIMITER
+                _rateLimitSettle();
+                #endif
+                #ifdef ENABLE_RESPONSE_CACHE
+                if (useCache && !responseContent.isEmpty()) {
+                    _responseCache->put(cacheKey, responseContent);
+                }
+                #endif
             } else {
                 _lastError = "HTTP Error: " + String(httpCode) + " - Response: " + responsePayload;
             }
         } else {
-            _lastError = String("HTTP Request Failed: ") + _httpClient.errorToString(httpCode).c_str();
+            _lastError = _requestFailedError(httpCode);
         }
         _httpClient.end(); // Clean up connection
     } else {
@@ -728,12 +2654,19 @@ String ESP32_AI_Connect::chat(const String& userMessage) {
 }
 
 #ifdef ENABLE_STREAM_CHAT
+#include <lwip/sockets.h>
+
 // --- Enhanced Thread-Safe Helper Methods ---
 
 // Thread-safe helper methods
 bool ESP32_AI_Connect::_acquireStreamLock(uint32_t timeoutMs) const {
-    if (_streamMutex == nullptr) return false;
-    return xSemaphoreTake(_streamMutex, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+#ifdef ENABLE_LAZY_ALLOCATION
+    SemaphoreHandle_t mutex = AI_API_Lazy_Mutex::get(_streamMutex);
+#else
+    SemaphoreHandle_t mutex = _streamMutex;
+#endif
+    if (mutex == nullptr) return false;
+    return xSemaphoreTake(mutex, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
 }
 
 void ESP32_AI_Connect::_releaseStreamLock() const {
@@ -796,7 +2729,7 @@ bool ESP32_AI_Connect::setStreamChatParameters(String userParameterJsonStr) {
     }
     
     // Validate JSON format
-    DynamicJsonDocument tempDoc(512); // Temporary document for validation
+    AI_API_Json_Document tempDoc; // Temporary document for validation
     DeserializationError error = deserializeJson(tempDoc, userParameterJsonStr);
     
     if (error) {
@@ -919,6 +2852,80 @@ void ESP32_AI_Connect::streamChatReset() {
 
 // Enhanced thread-safe streaming method
 bool ESP32_AI_Connect::streamChat(const String& userMessage, StreamCallback callback) {
+#ifdef ENABLE_SINGLE_FLIGHT
+    AI_API_Request_Lock requestLock(_requestMutex);
+#endif
+    return _sendStreamChat(userMessage, callback, nullptr);
+}
+
+#ifdef ENABLE_CHAT_SESSION
+bool ESP32_AI_Connect::streamChat(const String& userMessage, AI_API_Chat_Session& session, StreamCallback callback) {
+#ifdef ENABLE_SINGLE_FLIGHT
+    AI_API_Request_Lock requestLock(_requestMutex);
+#endif
+    if (!callback) {
+        _lastError = "Callback function is null";
+        return false;
+    }
+    
+#ifdef ENABLE_TOKEN_ESTIMATOR
+    _fitSessionToBudget(getStreamChatSystemRole(), userMessage, session);
+#endif
+    
+    // Collect the streamed reply so it can be added to the session
+    String reply;
+    bool success = _sendStreamChat(userMessage, [&reply, &callback](const StreamChunkInfo& chunkInfo) {
+        reply += chunkInfo.content;
+        return callback(chunkInfo);
+    }, &session);
+    
+    if (success && !reply.isEmpty()) {
+        session.addUserTurn(userMessage);
+        session.addAssistantTurn(reply);
+    }
+    return success;
+}
+#endif
+
+bool ESP32_AI_Connect::_sendStreamChat(const String& userMessage, StreamCallback callback,
+                                       const AI_API_Chat_Session* session) {
+    _startRequest();
+#ifdef ENABLE_CANCELLATION
+    AI_API_Cancel_Scope cancelScope(_cancelToken, _wifiClient);
+#endif
+#ifdef ENABLE_LATENCY_ROUTING
+    if (_latencyRouting && _failoverTargetCount > 0) {
+        // A stream cannot move to another target once started; pick the fastest available one
+        int order[AI_API_FAILOVER_MAX_TARGETS];
+        _orderTargets(order, true);
+        int target = order[0];
+        for (int k = 0; k <= _failoverTargetCount; k++) {
+            if (isTargetAvailable(order[k])) {
+                target = order[k];
+                break;
+            }
+        }
+
+        _swapTarget(target);
+        bool success = _streamChat(userMessage, callback, session);
+        _swapTarget(target);
+
+        int code = getStreamChatResponseCode();
+        if (code != 0) {
+            _recordTargetResult(target, code < 0 || code == 429 || code >= 500);
+            _lastServedTarget = target;
+        }
+        if (code == HTTP_CODE_OK) {
+            _targetLatency[target].addSample(AI_API_Latency_Stats::TTFB, _lastTtfbMs);
+            if (_lastTtftMs > 0) _targetLatency[target].addSample(AI_API_Latency_Stats::TTFT, _lastTtftMs);
+        }
+        return success;
+    }
+#endif
+    return _streamChat(userMessage, callback, session);
+}
+
+bool ESP32_AI_Connect::_streamChat(const String& userMessage, StreamCallback callback, const AI_API_Chat_Session* session) {
     // Quick state check without lock first
     if (_getStreamState() != StreamState::IDLE) {
         _lastError = "Streaming operation already in progress";
@@ -974,8 +2981,8 @@ bool ESP32_AI_Connect::streamChat(const String& userMessage, StreamCallback call
 
     // Build streaming request body using handler (get parameters safely)
     String systemRole, customParams;
-    float temperature;
-    int maxTokens;
+    float temperature = -1.0;
+    int maxTokens = -1;
     
     if (_acquireStreamLock(100)) {
         systemRole = _streamSystemRole;
@@ -985,9 +2992,21 @@ bool ESP32_AI_Connect::streamChat(const String& userMessage, StreamCallback call
         _releaseStreamLock();
     }
     
+#ifdef ENABLE_TOKEN_ESTIMATOR
+    if (!_checkPromptBudget(_rawChatTokens(systemRole, userMessage, session))) {
+        _setStreamState(StreamState::ERROR);
+        return false;
+    }
+#endif
+
+#ifdef ENABLE_CHAT_SESSION
+    _trackChatHistory(session);
+#endif
     String requestBody = _platformHandler->buildStreamRequestBody(_modelName, systemRole,
                                                                  temperature, maxTokens,
-                                                                 userMessage, _reqDoc, customParams);
+                                                                 userMessage, _reqDoc, customParams,
+                                                                 session);
+    if (_requestOverflowed()) requestBody = "";
     if (requestBody.isEmpty()) {
         if (_lastError.isEmpty()) _lastError = "Failed to build streaming request body";
         _setStreamState(StreamState::ERROR);
@@ -1002,7 +3021,7 @@ bool ESP32_AI_Connect::streamChat(const String& userMessage, StreamCallback call
     #endif
 
     // Perform streaming setup (outside of lock to avoid blocking)
-    bool success = _processStreamResponse(url, requestBody);
+    bool success = _processStreamResponse(url, requestBody, maxTokens);
     
     if (success) {
         // Successful completion (including user interruption)
@@ -1015,12 +3034,24 @@ bool ESP32_AI_Connect::streamChat(const String& userMessage, StreamCallback call
     return success;
 }
 
+bool ESP32_AI_Connect::_waitForStreamData(uint32_t timeoutMs) {
+    int fd = _wifiClient.fd();
+    if (fd < 0) {
+        delay(min(timeoutMs, (uint32_t)10)); // Not a socket we can wait on
+        return false;
+    }
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(fd, &readable);
+    struct timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+    return select(fd + 1, &readable, nullptr, nullptr, &timeout) > 0;
+}
+
 // Enhanced stream processing with thread safety and metrics
-bool ESP32_AI_Connect::_processStreamResponse(const String& url, const String& requestBody) {
-    // Clean up any previous connections first
-    _httpClient.end();
-    _wifiClient.stop();
-    delay(50); // Give time for cleanup
+bool ESP32_AI_Connect::_processStreamResponse(const String& url, const String& requestBody, int maxTokens) {
+    _prepareConnection(url); // Reuse a warm connection, close any other
     
     // Start new connection
     if (!_httpClient.begin(_wifiClient, url)) {
@@ -1029,9 +3060,26 @@ bool ESP32_AI_Connect::_processStreamResponse(const String& url, const String& r
     }
 
     _platformHandler->setHeaders(_httpClient, _apiKey); // Set headers via handler
-    _httpClient.setTimeout(AI_API_HTTP_TIMEOUT_MS); // Use configured timeout
     
-    int httpCode = _httpClient.POST(requestBody);
+#ifdef ENABLE_RATE_LIMITER
+    if (!_rateLimitAcquire(requestBody, maxTokens)) { // The stream's limit, not chat()'s
+        _httpClient.end();
+        if (_acquireStreamLock(10)) {
+            _streamResponseCode = 429;
+            _releaseStreamLock();
+        }
+        return false;
+    }
+#endif
+#ifdef ENABLE_LATENCY_ROUTING
+    uint32_t requestStart = millis();
+#endif
+    int httpCode = _postRequest(url, requestBody);
+#ifdef ENABLE_LATENCY_ROUTING
+    _lastTtfbMs = millis() - requestStart;
+    _lastTtftMs = 0;
+    _lastTotalMs = 0;
+#endif
     
     // Store HTTP response code safely
     if (_acquireStreamLock(10)) {
@@ -1040,14 +3088,14 @@ bool ESP32_AI_Connect::_processStreamResponse(const String& url, const String& r
     }
 
     if (httpCode <= 0) {
-        _lastError = String("HTTP Request Failed: ") + _httpClient.errorToString(httpCode).c_str();
+        _lastError = _requestFailedError(httpCode);
         _httpClient.end();
         _wifiClient.stop();
         return false;
     }
 
     if (httpCode != HTTP_CODE_OK) {
-        String responsePayload = _httpClient.getString();
+        String responsePayload = _readResponseBody();
         _lastError = "HTTP Error: " + String(httpCode) + " - Response: " + responsePayload;
         _httpClient.end();
         _wifiClient.stop();
@@ -1066,15 +3114,42 @@ bool ESP32_AI_Connect::_processStreamResponse(const String& url, const String& r
 
     // Process streaming response with enhanced metrics
     Stream* stream = _httpClient.getStreamPtr();
+#ifdef ENABLE_COMPRESSION
+    AI_API_Gzip_Decoder decoder;
+    AI_API_Gzip_Decoder::Format format;
+    bool compressed = _responseFormat(format);
+    if (compressed) {
+        // Events are read from the inflated stream; HTTPClient leaves chunked framing to us
+        if (!decoder.begin(*stream, _httpClient.header("Transfer-Encoding").equalsIgnoreCase("chunked"), format)) {
+            _lastError = decoder.getError();
+            _httpClient.end();
+            _wifiClient.stop();
+            return false;
+        }
+        decoder.setTimeout(_chunkTimeoutMs);
+        stream = &decoder;
+    }
+#endif
     unsigned long lastChunkTime = millis();
     bool streamComplete = false;
     bool userInterrupted = false;
     uint32_t localChunkCount = 0;
+    bool woken = false; // The last wait ended with the socket readable
     
     while (_httpClient.connected() && _getStreamState() == StreamState::ACTIVE && 
            !streamComplete && !userInterrupted) {
         
+        if (_deadlineRemainingMs() == 0) {
+            _lastTimeoutPhase = TimeoutPhase::DEADLINE;
+            _lastError = "Stream timeout: request deadline of " + String(_requestDeadlineMs) + "ms reached";
+            break;
+        }
+#ifdef ENABLE_CANCELLATION
+        if (_requestCancelled()) break;
+#endif
+        
         if (stream->available()) {
+            woken = false;
             String chunk = stream->readStringUntil('\n');
             lastChunkTime = millis();
             localChunkCount++;
@@ -1110,6 +3185,12 @@ bool ESP32_AI_Connect::_processStreamResponse(const String& url, const String& r
             chunkInfo.elapsedMs = getStreamElapsedTime();
             chunkInfo.errorMsg = errorMsg;
             
+#ifdef ENABLE_LATENCY_ROUTING
+            if (!content.isEmpty() && _lastTtftMs == 0) {
+                _lastTtftMs = millis() - requestStart;
+            }
+#endif
+            
             // Call user callback with enhanced info
             if (!content.isEmpty() || isComplete) {
                 // Get callback safely
@@ -1133,8 +3214,10 @@ bool ESP32_AI_Connect::_processStreamResponse(const String& url, const String& r
             #endif
         } else {
             // Check for timeout and state changes
-            if (millis() - lastChunkTime > STREAM_CHAT_CHUNK_TIMEOUT_MS) {
-                _lastError = "Stream timeout: No data received within " + String(STREAM_CHAT_CHUNK_TIMEOUT_MS) + "ms";
+            uint32_t idleMs = millis() - lastChunkTime;
+            if (idleMs > _chunkTimeoutMs) {
+                _lastTimeoutPhase = TimeoutPhase::CHUNK;
+                _lastError = "Stream timeout: No data received within " + String(_chunkTimeoutMs) + "ms";
                 break;
             }
             
@@ -1142,15 +3225,36 @@ bool ESP32_AI_Connect::_processStreamResponse(const String& url, const String& r
                 userInterrupted = true;
                 break;
             }
+#ifdef ENABLE_COMPRESSION
+            if (decoder.hasError()) {
+                _lastError = String("Stream decompression failed: ") + decoder.getError();
+                break;
+            }
+#endif
             
-            delay(10); // Yield to other tasks
+            if (woken) {
+                // Readable but no complete TLS record decrypted yet: yield instead of spinning
+                delay(1);
+            }
+            // Sleep until data arrives; the slice bounds how long stopStreaming() takes
+            uint32_t waitMs = min(min(_chunkTimeoutMs - idleMs + 1, _deadlineRemainingMs()),
+                                  (uint32_t)STREAM_CHAT_WAIT_SLICE_MS);
+            woken = _waitForStreamData(waitMs);
         }
     }
     
+#ifdef ENABLE_LATENCY_ROUTING
+    _lastTotalMs = millis() - requestStart;
+#endif
+    _memoryUsage.sample();
+#ifdef ENABLE_COMPRESSION
+    _lastWireBytes = compressed ? decoder.getCompressedBytes() : _streamTotalBytes;
+    _lastBodyBytes = compressed ? decoder.getInflatedBytes() : _streamTotalBytes;
+#endif
+    
     // Comprehensive cleanup
     _httpClient.end();
     _wifiClient.stop();
-    delay(100); // Give extra time for connection cleanup
     
     // Handle different exit conditions
     if (userInterrupted) {
@@ -14,6 +14,26 @@
 // Include configuration and base handler FIRST
 #include "ESP32_AI_Connect_config.h"
 #include "AI_API_Platform_Handler.h"
+#include "AI_API_Handler_Registry.h"
+#include "AI_API_Tool_Selector.h"
+#include "AI_API_Tool_Schema.h"
+#include "AI_API_Tool_Args.h"
+#include "AI_API_Chat_Session.h"
+#include "AI_API_Token_Estimator.h"
+#include "AI_API_Request_Key.h"
+#include "AI_API_Response_Cache.h"
+#include "AI_API_Single_Flight.h"
+#include "AI_API_Request_Scheduler.h"
+#include "AI_API_Latency_Stats.h"
+#include "AI_API_Rate_Limiter.h"
+#include "AI_API_Retry_Policy.h"
+#include "AI_API_Cancel_Token.h"
+#include "AI_API_Race_Client.h"
+#include "AI_API_DNS_Cache.h"
+#include "AI_API_Gzip_Decoder.h"
+#include "AI_API_Memory.h"
+#include "AI_API_Lazy_Mutex.h"
+#include "AI_API_Timeouts.h"
 
 // --- Conditionally Include Platform Implementations ---
 // The preprocessor will only include headers for platforms enabled in the config file
@@ -31,6 +51,13 @@
 #endif
 // Add other conditional includes here
 
+#if defined(ENABLE_LATENCY_ROUTING) && !defined(ENABLE_FAILOVER)
+#error "ENABLE_LATENCY_ROUTING requires ENABLE_FAILOVER (routing chooses among the failover targets)"
+#endif
+#if defined(ENABLE_HEDGING) && !defined(ENABLE_FAILOVER)
+#error "ENABLE_HEDGING requires ENABLE_FAILOVER (the hedge goes to a failover target)"
+#endif
+
 class ESP32_AI_Connect {
 public:
     // Constructor: Takes platform identifier string, API key, model name
@@ -71,8 +98,168 @@ public:
     // Returns the current custom parameters set for standard chat requests as JSON string
     String getChatParameters() const;
 
+    // --- Timeouts ---
+    // Phase of a request that ran out of time
+    enum class TimeoutPhase : uint8_t {
+        NONE,        // The last request did not time out
+        CONNECT,     // TCP connection to the server
+        TLS,         // TLS handshake
+        FIRST_BYTE,  // Sending the request until the response headers arrive
+        CHUNK,       // Gap between streamed chunks (streamChat only)
+        DEADLINE     // Request deadline, across all attempts and targets
+    };
+    // Budgets of each request phase in milliseconds (0 keeps the current value).
+    // The TLS budget is rounded up to whole seconds; the first-byte budget is at most 65535.
+    void setTimeouts(uint32_t connectMs, uint32_t tlsMs, uint32_t firstByteMs, uint32_t chunkMs = 0);
+    uint32_t getConnectTimeout() const;
+    uint32_t getTlsTimeout() const;
+    uint32_t getFirstByteTimeout() const;
+    uint32_t getChunkTimeout() const;
+    // Upper bound on each chat/tcChat/tcReply/streamChat call including retries and failover;
+    // every phase budget is cut to the time left. 0 = no deadline.
+    void setRequestDeadline(uint32_t deadlineMs);
+    uint32_t getRequestDeadline() const;
+    // Phase that expired in the last request (NONE if it did not time out)
+    TimeoutPhase getLastTimeoutPhase() const;
+    static const char* getTimeoutPhaseName(TimeoutPhase phase);
+
+    // --- Connection Reuse ---
+    // Resolve DNS, connect and complete the TLS handshake to the active endpoint now, so the next
+    // chat()/streamChat() skips them. The connection is held for idleMs (0 = keep-alive period,
+    // or AI_API_WARMUP_HOLD_MS with keep-alive off).
+    bool warmup(uint32_t idleMs = 0);
+    // How long the connection stays open for the next request after one completes;
+    // 0 (the default) closes it after every request. An open connection holds about 40 KB of heap.
+    // Compressed requests (setCompression()) always close it.
+    void setKeepAlive(uint32_t idleMs);
+    uint32_t getKeepAlive() const;
+    // Close an idle connection now (frees its TLS buffers)
+    void closeConnection();
+    // True if the last request was sent on an already open connection
+    bool wasLastConnectionWarm() const;
+    // Peak heap the last request took in internal RAM and in PSRAM
+    const AI_API_Memory_Usage& getLastMemoryUsage() const;
+    // Requests built and responses parsed that failed because their JSON document ran out of heap
+    uint32_t getJsonOverflowCount() const;
+#ifdef ENABLE_LAZY_ALLOCATION
+    // Once no request was made for idleMs, releaseIdleResources() frees the memory the JSON
+    // documents grew to and closes an expired keep-alive connection; call it from loop().
+    // 0 never releases.
+    void setIdleRelease(uint32_t idleMs);
+    uint32_t getIdleRelease() const;
+    // True if anything was freed. The documents are kept while tool calls await tcReply().
+    // Returns false at once while a request holds the client.
+    bool releaseIdleResources();
+#endif
+#ifdef ENABLE_DNS_CACHE
+    // Time the last request spent resolving host names (0 if cached or the connection was open)
+    uint32_t getLastDnsTime() const;
+    // Cached endpoint addresses of this client (hit/miss counts, invalidate(), clear())
+    AI_API_DNS_Cache& getDnsCache();
+#endif
+#ifdef ENABLE_COMPRESSION
+    // Ask for gzip/deflate compressed responses (off by default); they are inflated as they
+    // arrive, in front of the JSON parser and the stream chunk parser. Requests are then sent
+    // as HTTP/1.0, the only way to keep HTTPClient from refusing compression in its own header,
+    // so compression turns keep-alive off. Only the wire bytes shrink: chat() and tcChat()
+    // still hold the whole inflated body in a String before parsing it.
+    void setCompression(bool enable);
+    bool getCompression() const;
+    // Body bytes of the last response as received and once inflated (equal if it was not compressed)
+    uint32_t getLastWireBytes() const;
+    uint32_t getLastBodyBytes() const;
+#endif
+
     // Main chat function - delegates to the handler
     String chat(const String& userMessage);
+#ifdef ENABLE_FAILOVER
+    // --- Provider Failover ---
+    // Add a fallback target for chat(). Targets are tried in order after the begin() target
+    // when a request fails to connect, times out, or gets HTTP 429 or 5xx. A target that fails
+    // AI_API_FAILOVER_FAILURE_THRESHOLD times in a row is skipped for AI_API_FAILOVER_COOLDOWN_MS.
+    bool addFailoverTarget(const char* platformIdentifier, const char* apiKey, const char* modelName,
+                           const char* endpointUrl = nullptr);
+    void clearFailoverTargets();
+    // Number of fallback targets (the begin() target is not counted)
+    int getFailoverTargetCount() const;
+    // Target that answered the last chat() call: 0 = begin() target, 1.. = fallback targets, -1 = none
+    int getLastServedTarget() const;
+    // Consecutive failures of a target (same numbering as getLastServedTarget())
+    int getTargetFailureCount(int index) const;
+    // False while a target's circuit breaker is open
+    bool isTargetAvailable(int index) const;
+#ifdef ENABLE_LATENCY_ROUTING
+    // Try the fastest healthy target first: chat() ranks targets by total latency, streamChat()
+    // by time to first token. 'exploration' is the share of calls that lead with another target
+    // so its estimates stay current.
+    void setLatencyRouting(bool enable, float exploration = AI_API_ROUTING_EXPLORATION);
+    bool getLatencyRouting() const;
+    // Target chosen first by the last routing decision, and whether it was an exploration pick
+    int getLastRoutedTarget() const;
+    bool wasLastRouteExploration() const;
+    // Latency estimates of a target (same numbering as getLastServedTarget()), nullptr if none
+    const AI_API_Latency_Stats* getTargetLatency(int index) const;
+    void resetLatencyStats();
+    // Timings of the last chat/streamChat request in milliseconds (TTFT is streamChat only)
+    uint32_t getLastTTFB() const;
+    uint32_t getLastTTFT() const;
+    uint32_t getLastTotalLatency() const;
+#endif
+#ifdef ENABLE_HEDGING
+    // Send chat() to the next available target as well when the first has not answered
+    // (response headers) within delayMs; the first answer is used and the other request is
+    // aborted. 0 disables hedging.
+    void setHedging(uint32_t delayMs = AI_API_HEDGE_DELAY_MS);
+    uint32_t getHedgingDelay() const;
+    // Requests that could be hedged, hedges sent, and hedges that answered first
+    uint32_t getHedgeEligibleCount() const;
+    uint32_t getHedgeSentCount() const;
+    uint32_t getHedgeWinCount() const;
+    // Share of eligible requests that sent a hedge
+    float getHedgeRate() const;
+    void resetHedgeStats();
+#endif
+#endif
+
+#ifdef ENABLE_SINGLE_FLIGHT
+    // Calls from different tasks are serialized; a chat(userMessage) identical to one already
+    // in flight waits for it and returns its result. Returns how many calls were served that way.
+    uint32_t getCoalescedRequestCount() const;
+#endif
+#ifdef ENABLE_RATE_LIMITER
+    // Pace requests to the begin() target with 'limiter' (nullptr to remove). A request waits
+    // up to maxWaitMs for budget; if it would wait longer it is not sent, its response code
+    // is set to 429 and failover, when enabled, moves on to the next target.
+    void setRateLimiter(AI_API_Rate_Limiter* limiter, uint32_t maxWaitMs = AI_API_RATE_LIMIT_MAX_WAIT_MS);
+    AI_API_Rate_Limiter* getRateLimiter() const;
+#endif
+#ifdef ENABLE_RETRY
+    // Send a request again after a connect/send error, 408, 429 or 5xx (see AI_API_Retry_Policy.h).
+    // maxAttempts includes the first request; 1 (the default) disables retries. With failover,
+    // a target is retried before the next one is tried. retryAfterSend also retries read
+    // timeouts and lost connections, which may send a request the server already got again.
+    void setRetryPolicy(uint8_t maxAttempts, uint32_t baseDelayMs = AI_API_RETRY_BASE_DELAY_MS,
+                        uint32_t maxDelayMs = AI_API_RETRY_MAX_DELAY_MS,
+                        uint32_t deadlineMs = AI_API_RETRY_DEADLINE_MS, bool retryAfterSend = false);
+    const AI_API_Retry_Policy& getRetryPolicy() const;
+    // Attempts made by the last chat/tool calls/stream request, and retries sent in total
+    int getLastAttemptCount() const;
+    uint32_t getRetryCount() const;
+#endif
+#ifdef ENABLE_CANCELLATION
+    // Let 'token' abort this client's requests (chat, tool calls, streams) from another task;
+    // nullptr to remove. An aborted request returns with getLastError() "Request cancelled".
+    void setCancelToken(AI_API_Cancel_Token* token);
+    AI_API_Cancel_Token* getCancelToken() const;
+#endif
+#ifdef ENABLE_CHAT_SESSION
+    // Multi-turn chat: sends the turns kept in 'session' ahead of userMessage,
+    // then records userMessage and the reply in 'session' on success
+    String chat(const String& userMessage, AI_API_Chat_Session& session);
+    // History sent with the last chat/streamChat request
+    int getChatHistoryTurnsSent() const;
+    size_t getChatHistoryBytesSent() const;
+#endif
     
     // Raw response access methods
     String getChatRawResponse() const;
@@ -97,6 +284,50 @@ public:
     // Get the finish reason from the last response
     String getFinishReason() const;
 
+#ifdef ENABLE_RESPONSE_CACHE
+    // Answer repeated chat() requests from 'cache' (nullptr disables; the cache is not owned).
+    // Only requests with temperature 0 are cached unless anyTemperature is true;
+    // chat session requests are never cached.
+    void setResponseCache(AI_API_Response_Cache* cache, bool anyTemperature = false);
+    AI_API_Response_Cache* getResponseCache() const;
+    // True if the last chat() reply came from the cache; token and finish reason
+    // getters still describe the last request actually sent
+    bool isLastResponseCached() const;
+#endif
+
+    // Prompt caching: marks the system role, tools and chat session history as a cacheable
+    // prefix (Claude cache_control breakpoints; OpenAI prompt_cache_key when cacheKey is set).
+    // DeepSeek and Gemini cache prefixes automatically and only report the counts below.
+    void setPromptCaching(bool enable, const String& cacheKey = "");
+    bool getPromptCaching() const;
+    // Prompt tokens read from / written to the provider's cache by the last request
+    int getCacheReadTokens() const;
+    int getCacheWriteTokens() const;
+
+#ifdef ENABLE_TOKEN_ESTIMATOR
+    // --- Prompt Token Estimation ---
+    // Estimated prompt tokens of chat(userMessage) with the current system role
+    int estimateChatTokens(const String& userMessage);
+#ifdef ENABLE_CHAT_SESSION
+    // Same, including the history kept in 'session'
+    int estimateChatTokens(const String& userMessage, const AI_API_Chat_Session& session);
+#endif
+#ifdef ENABLE_TOOL_CALLS
+    // Estimated prompt tokens of tcChat(tcUserMessage), including the tool definitions sent
+    int estimateTCChatTokens(const String& tcUserMessage);
+#endif
+    // Rejects chat, streamChat and tcChat requests estimated above maxPromptTokens without
+    // sending them (0 = no limit, the default). Session requests drop their oldest turns first.
+    void setPromptTokenBudget(int maxPromptTokens);
+    int getPromptTokenBudget() const;
+    // Estimate made for the last request
+    int getLastEstimatedTokens() const;
+    // Prompt tokens the provider reported for the last response
+    int getPromptTokens() const;
+    // Error of the last estimate against the provider's count, in percent
+    float getTokenEstimateError() const;
+#endif
+
 #ifdef ENABLE_TOOL_CALLS
     // --- Tool Calls Methods ---
     
@@ -104,6 +335,28 @@ public:
     // tcTools: array of JSON strings, each representing a tool definition
     // tcToolsSize: number of elements in the tcTools array
     bool setTCTools(String* tcTools, int tcToolsSize);
+    // Setup pre-rendered tool definitions (see AI_API_Tool_Schema.h)
+    // The array is referenced, not copied - it must outlive its use (e.g. static const in flash)
+    bool setTCTools(const AI_API_Tool_Def* tcTools, int tcToolsSize);
+    
+#ifdef ENABLE_TOOL_SELECTION
+    // Tool selection configuration
+    // Sends only the topK tools most relevant to the user message (0 = send all tools, the default).
+    // When no tool is relevant, the first topK tools are sent, with the tool forced by
+    // setTCChatToolChoice() among them.
+    // The tool size limit is checked against the largest topK tools, both here for tools
+    // already registered and in setTCTools(). Returns false (and keeps the old setting) if
+    // they exceed it.
+    bool setTCToolSelection(int topK);
+    // Returns the current topK setting for tool selection
+    int getTCToolSelection() const;
+    // Returns the number of tools sent with the last tcChat/tcReply request
+    int getTCSelectedToolCount() const;
+    // Returns the tool definition bytes left out of the last tcChat/tcReply request
+    int getTCToolBytesSaved() const;
+    // Returns the estimated prompt tokens left out of the last tcChat/tcReply request
+    int getTCToolTokensSaved() const;
+#endif
     
     // Tool call configuration setters
     // Sets the System Role for initial tool calls to define the AI's behavior in tool calling conversations
@@ -157,6 +410,18 @@ public:
     // Reset the tool calls conversation history and configuration
     // Call this when you want to start a new conversation
     void tcChatReset();
+    
+    // --- Decoded Tool Calls ---
+    // Access the tool calls of the last tcChat/tcReply response without parsing the returned JSON string.
+    // Views are valid until the next request; for OpenAI/DeepSeek the args of a call are valid
+    // until the next tcGetToolCall().
+    // Returns the number of tool calls in the last response (0 if it was a regular message)
+    int tcGetToolCallCount();
+    // Decode tool call 'index' and validate its arguments against the registered tool definition
+    // Returns false on error or if the arguments do not match the schema (check getLastError())
+    bool tcGetToolCall(int index, AI_API_Tool_Call& call);
+    // Copy the arguments of 'call' into the bound variables (see AI_API_Tool_Args.h)
+    bool tcBindToolArgs(const AI_API_Tool_Call& call, const AI_API_Arg_Field* fields, int fieldCount);
 #endif
 
 #ifdef ENABLE_STREAM_CHAT
@@ -185,6 +450,10 @@ public:
 
     // Main streaming method with enhanced thread safety
     bool streamChat(const String& userMessage, StreamCallback callback);
+#ifdef ENABLE_CHAT_SESSION
+    // Multi-turn streaming chat: same as chat(userMessage, session) with the reply streamed
+    bool streamChat(const String& userMessage, AI_API_Chat_Session& session, StreamCallback callback);
+#endif
 
     // Thread-safe streaming control methods
     bool isStreaming() const;
@@ -232,6 +501,8 @@ private:
     float _temperature = -1.0; // Use API default
     int _maxTokens = -1;       // Use API default
     String _chatCustomParams = ""; // Store custom parameters as JSON string
+    bool _promptCaching = false;   // Applied to every handler created by begin()
+    String _promptCacheKey = "";
     
     // Raw response storage
     String _chatRawResponse = "";    // Store the raw response from chat method
@@ -244,6 +515,13 @@ private:
     // Tool calls configuration storage
     String* _tcToolsArray = nullptr;
     int _tcToolsArraySize = 0;
+    String* _tcToolSignatures = nullptr;  // Argument signature of each String tool (see AI_API_Tool_Args.h)
+    const AI_API_Tool_Def* _tcToolDefs = nullptr; // Pre-rendered tools (not owned)
+    int _tcToolDefsSize = 0;
+    AI_API_Json_Document _tcArgsDoc; // Arguments of the last decoded tool call when sent as a string
+    
+    // Returns the argument signature of the registered tool called 'name', nullptr if unknown
+    const char* _findTCToolSignature(const char* name) const;
     String _tcSystemRole = "";
     String _tcToolChoice = "";
     int _tcMaxToken = -1;
@@ -256,7 +534,20 @@ private:
     String _lastUserMessage = "";         // Original user query
     String _lastAssistantToolCallsJson = ""; // Assistant's tool calls JSON (extracted from response)
     bool _lastMessageWasToolCalls = false; // Flag to track if follow-up is valid
-    DynamicJsonDocument* _tcConversationDoc = nullptr; // Used to track conversation for follow-up
+    AI_API_Json_Document* _tcConversationDoc = nullptr; // Used to track conversation for follow-up
+
+#ifdef ENABLE_TOOL_SELECTION
+    // Tool selection storage
+    int _tcToolSelectTopK = 0;                // 0 = selection disabled
+    AI_API_Tool_Selector _tcToolSelector;     // Keyword index built by setTCTools()
+    String* _tcSelectedTools = nullptr;       // Tools chosen for the current conversation
+    AI_API_Tool_Def* _tcSelectedToolDefs = nullptr; // Same for pre-rendered tools
+    int _tcSelectedToolsSize = 0;             // 0 = all tools are sent
+    int _tcToolBytesSaved = 0;                // Tool definition bytes left out of the last request
+
+    // Choose the tools sent with the next tcChat (and its tcReply follow-ups)
+    void _selectTCTools(const String& userMessage);
+#endif
 #endif
 
 #ifdef ENABLE_STREAM_CHAT
@@ -293,7 +584,198 @@ private:
     StreamState _getStreamState() const;
     
     // Enhanced internal processing method
-    bool _processStreamResponse(const String& url, const String& requestBody);
+    bool _processStreamResponse(const String& url, const String& requestBody, int maxTokens);
+    // Block until the stream socket is readable (or closed) or timeoutMs passes; true if readable
+    bool _waitForStreamData(uint32_t timeoutMs);
+    // Streaming request on the active target, or on the fastest target when latency routing is on
+    bool _sendStreamChat(const String& userMessage, StreamCallback callback, const AI_API_Chat_Session* session);
+    // Streaming request with optional chat session history
+    bool _streamChat(const String& userMessage, StreamCallback callback, const AI_API_Chat_Session* session);
+#endif
+
+#ifdef ENABLE_RESPONSE_CACHE
+    AI_API_Response_Cache* _responseCache = nullptr;
+    bool _cacheAnyTemperature = false;
+    bool _lastResponseCached = false;
+#endif
+#if defined(ENABLE_RESPONSE_CACHE) || defined(ENABLE_SINGLE_FLIGHT)
+    // Key of a chat() request sent to 'url' (see AI_API_Request_Key.h)
+    uint64_t _chatRequestKey(const String& url, const String& userMessage) const;
+    // Same, from the _targetKey() of the target it is sent to
+    uint64_t _chatRequestKey(uint64_t targetKey, const String& userMessage) const;
+    // Key of the platform, endpoint and model a request is sent to
+    uint64_t _targetKey(const String& url) const;
+#endif
+#ifdef ENABLE_SINGLE_FLIGHT
+    SemaphoreHandle_t _requestMutex = nullptr; // Held while a request uses _reqDoc/_respDoc/_httpClient
+    // _targetKey() of the begin() target, set by begin(). chat() keys coalesced requests with it
+    // without the request lock, while failover may have swapped another target in. 0 = no target.
+    uint64_t _chatFlightTarget = 0;
+    AI_API_Single_Flight _chatFlights;         // chat() requests in flight
+#endif
+#ifdef ENABLE_RATE_LIMITER
+    AI_API_Rate_Limiter* _rateLimiter = nullptr; // Of the active target
+    uint32_t _rateLimitMaxWaitMs = AI_API_RATE_LIMIT_MAX_WAIT_MS;
+    int _rateLimitReserved = 0; // Tokens reserved by the request in flight
+
+    // Take budget for a request before sending it (call after _httpClient.begin()); false if
+    // it must not be sent, with _lastError set
+    bool _rateLimitAcquire(const String& requestBody, int maxTokens);
+    // Feed the response headers to the limiter, and its real token usage once parsed
+    void _rateLimitUpdate(int httpCode);
+    void _rateLimitSettle();
+#endif
+#ifdef ENABLE_RETRY
+    AI_API_Retry_Policy _retryPolicy;
+    int _lastAttempts = 0;
+    uint32_t _retries = 0;
+#endif
+    // POST requestBody on the connection _httpClient has open to 'url'; with retries enabled,
+    // reconnects and sends it again per the retry policy. Returns the last attempt's HTTP code.
+    int _postRequest(const String& url, const String& requestBody);
+    // One POST on the open connection with the current phase budgets
+    int _postAttempt(const String& requestBody);
+
+    uint32_t _connectTimeoutMs = AI_API_CONNECT_TIMEOUT_MS;
+    uint32_t _tlsTimeoutMs = AI_API_TLS_TIMEOUT_MS;
+    uint32_t _firstByteTimeoutMs = AI_API_HTTP_TIMEOUT_MS;
+    uint32_t _chunkTimeoutMs = STREAM_CHAT_CHUNK_TIMEOUT_MS;
+    uint32_t _requestDeadlineMs = AI_API_REQUEST_DEADLINE_MS;
+    uint32_t _requestStartedAt = 0; // millis() when the current call started
+    TimeoutPhase _lastTimeoutPhase = TimeoutPhase::NONE;
+    AI_API_Memory_Usage _memoryUsage; // Of the current/last request
+
+    // Start the deadline of a chat/tcChat/tcReply/streamChat call
+    void _startRequest();
+    // Time left before the request deadline (UINT32_MAX without one)
+    uint32_t _deadlineRemainingMs() const;
+    // Phase budgets for the next connection, cut to the time left before the deadline
+    void _applyTimeouts(HTTPClient& http, WiFiClientSecure& client) const;
+    // Record which phase expired when an attempt failed with httpCode after elapsedMs
+    void _recordTimeout(int httpCode, uint32_t elapsedMs);
+    // _lastError text of a failed request (negative httpCode), naming the expired phase
+    String _requestFailedError(int httpCode);
+
+    uint32_t _keepAliveMs = AI_API_KEEPALIVE_MS;
+    String _connHost;            // "host:port" _wifiClient is connected to
+    uint32_t _connUsedAt = 0;    // millis() of its last request or warmup
+    uint32_t _connIdleMs = 0;    // How long it may stay idle from _connUsedAt
+    bool _lastConnectionWarm = false;
+
+    // Ready _httpClient/_wifiClient for a request to 'url': an open connection to the same
+    // server within its idle period is kept for reuse, anything else is closed
+    void _prepareConnection(const String& url);
+#ifdef ENABLE_DNS_CACHE
+    AI_API_DNS_Cache _dnsCache;
+    uint32_t _lastDnsMs = 0;
+    // Connect _wifiClient to 'host' ("host:port") at its cached address. False if the name does
+    // not resolve; a failed connect is left to HTTPClient, which resolves the name again.
+    bool _connectCached(const String& host);
+    // Socket timeout of 'client', which bounds its TCP connect and its reads
+    static void _setSocketTimeout(WiFiClientSecure& client, uint32_t timeoutMs);
+#endif
+#ifdef ENABLE_CANCELLATION
+    AI_API_Cancel_Token* _cancelToken = nullptr;
+    bool _isCancelled() const;
+    // True if the request must give up because it was cancelled; sets _lastError
+    bool _requestCancelled();
+#endif
+    // Response headers the rate limiter, retry policy and decompression read
+    void _collectResponseHeaders();
+    // Body of the response to the last POST, inflated if it came compressed
+    String _readResponseBody();
+#ifdef ENABLE_COMPRESSION
+    bool _compression = false;
+    uint32_t _lastWireBytes = 0;
+    uint32_t _lastBodyBytes = 0;
+    // Format the last response was compressed with; false if it was not
+    bool _responseFormat(AI_API_Gzip_Decoder::Format& format);
+#endif
+
+#ifdef ENABLE_FAILOVER
+    // Fallback target; its fields are swapped with the active configuration while in use
+    struct FailoverTarget {
+        AI_API_Platform_Handler* handler = nullptr;
+        String apiKey;
+        String modelName;
+        String endpoint;
+#ifdef ENABLE_RATE_LIMITER
+        AI_API_Rate_Limiter* rateLimiter = nullptr; // Fallback targets are not limited
+#endif
+    };
+    // Circuit breaker state of one target
+    struct TargetHealth {
+        uint8_t failures = 0;   // Consecutive retryable failures
+        uint32_t openedAt = 0;  // millis() when the breaker last opened
+    };
+    FailoverTarget _failoverTargets[AI_API_FAILOVER_MAX_TARGETS - 1];
+    TargetHealth _targetHealth[AI_API_FAILOVER_MAX_TARGETS]; // [0] = begin() target
+    int _failoverTargetCount = 0;
+    int _lastServedTarget = -1;
+
+    // Exchange the active configuration with target 'index' (call again to restore)
+    void _swapTarget(int index);
+    void _recordTargetResult(int index, bool failed);
+    // Fill 'order' with the target indices in the order they should be tried: begin() target
+    // first, or with latency routing fastest first by time to first token or total latency
+    void _orderTargets(int* order, bool byFirstToken);
+#ifdef ENABLE_LATENCY_ROUTING
+    AI_API_Latency_Stats _targetLatency[AI_API_FAILOVER_MAX_TARGETS]; // Same numbering as _targetHealth
+    bool _latencyRouting = false;
+    float _routingExploration = AI_API_ROUTING_EXPLORATION;
+    int _lastRoutedTarget = -1;
+    bool _lastRouteExplored = false;
+    uint32_t _lastTtfbMs = 0;   // Timings of the last chat/streamChat request
+    uint32_t _lastTtftMs = 0;
+    uint32_t _lastTotalMs = 0;
+#endif
+#ifdef ENABLE_HEDGING
+    struct HedgeRace; // Shared by the caller and the hedge task (see ESP32_AI_Connect.cpp)
+    HedgeRace* _hedgeRace = nullptr; // Race of the chat request in flight, if hedged
+    uint32_t _hedgeDelayMs = 0;
+    uint32_t _hedgeEligible = 0;
+    uint32_t _hedgeSent = 0;
+    uint32_t _hedgeWins = 0;
+
+    // Next target after order[first] that may take a hedge, -1 if none
+    int _pickHedgeTarget(const int* order, int first, bool anyAvailable) const;
+    // Run _chat() on the active target, racing 'hedge' after the hedge delay.
+    // 'outcome' is 0 if no hedge was sent, 1 if it was sent but lost or failed, 2 if it won.
+    String _hedgedChat(const FailoverTarget& hedge, const String& userMessage,
+                       const AI_API_Chat_Session* session, int& outcome);
+    // Called by _chat() once the active target's response headers arrived (or the request
+    // failed); false if the hedge already won and this response must be dropped
+    bool _claimHedgeRace(int httpCode);
+    static void _hedgeTask(void* param);
+#endif
+#endif
+
+    // Chat request on the active target, failing over to the fallback targets when enabled
+    String _sendChat(const String& userMessage, const AI_API_Chat_Session* session);
+    // Chat request with optional chat session history
+    String _chat(const String& userMessage, const AI_API_Chat_Session* session);
+#ifdef ENABLE_CHAT_SESSION
+    int _chatHistoryTurnsSent = 0;      // Session turns sent with the last chat/streamChat request
+    size_t _chatHistoryBytesSent = 0;   // Text bytes of those turns
+    // Record the history sent with a request
+    void _trackChatHistory(const AI_API_Chat_Session* session);
+#endif
+
+#ifdef ENABLE_TOKEN_ESTIMATOR
+    AI_API_Token_Estimator _tokenEstimator;
+    int _promptTokenBudget = 0;       // 0 = no limit
+    int _lastEstimatedTokens = 0;     // Scaled estimate of the last request
+    int _lastRawEstimate = 0;         // Raw estimate of the last request, used for calibration
+
+    // Raw token count of a chat prompt
+    int _rawChatTokens(const String& systemRole, const String& userMessage,
+                       const AI_API_Chat_Session* session) const;
+    // Record the estimate for the next request; returns false (with _lastError set) if over budget
+    bool _checkPromptBudget(int rawTokens);
+    // Drop the oldest session turns until the request fits the budget
+    void _fitSessionToBudget(const String& systemRole, const String& userMessage, AI_API_Chat_Session& session);
+    // Learn from the prompt tokens reported for the last request
+    void _calibrateTokenEstimate();
 #endif
 
     // Internal state
@@ -301,15 +783,43 @@ private:
     AI_API_Platform_Handler* _platformHandler = nullptr; // Pointer to the active handler
 
     // HTTP Client objects
+#if defined(ENABLE_HEDGING) || defined(ENABLE_CANCELLATION)
+    AI_API_Race_Client _wifiClient; // Gives up when a hedge wins the race or the request is cancelled
+#else
     WiFiClientSecure _wifiClient;
+#endif
     HTTPClient _httpClient;
 
     // Shared JSON documents (to potentially save memory vs. creating in handlers)
-    DynamicJsonDocument _reqDoc{AI_API_REQ_JSON_DOC_SIZE};
-    DynamicJsonDocument _respDoc{AI_API_RESP_JSON_DOC_SIZE};
+    AI_API_Json_Document _reqDoc;
+    AI_API_Json_Document _respDoc;
+#ifdef ENABLE_LAZY_ALLOCATION
+    uint32_t _idleReleaseMs = AI_API_IDLE_RELEASE_MS;
+    uint32_t _docsUsedAt = 0; // millis() a request last used the documents
+    bool _docsHeld = false;   // The documents may hold memory since they were last released
+    // A request or setTCTools() is about to use the documents
+    void _useDocuments();
+#endif
+    uint32_t _jsonOverflows = 0;
+
+    // After a request body was built or a response parsed: true if the document could not
+    // get the heap it needed, which sets _lastError. The result is incomplete then.
+    bool _requestOverflowed();
+    bool _responseOverflowed();
+
+    // Handlers created by begin(), kept so switching platforms does not reallocate them
+    struct CachedHandler {
+        uint32_t id = 0; // AI_API_Handler_Registry::hash() of the platform identifier
+        AI_API_Platform_Handler* handler = nullptr;
+    };
+    CachedHandler _handlerCache[AI_API_HANDLER_CACHE_SIZE];
+    int _handlerCacheCount = 0;
+    int _handlerCacheNext = 0; // Entry replaced next when the cache is full
 
-    // Private helper to clean up handler
+    // Private helper to clean up handlers
     void _cleanupHandler();
+    // Cached or new handler for a lowercase platform identifier, nullptr if not registered
+    AI_API_Platform_Handler* _acquireHandler(const String& platformStr);
 };
 
 #endif // ESP32_AI_CONNECT_H 
\ No newline at end of file
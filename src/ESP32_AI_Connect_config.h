@@ -14,6 +14,106 @@
 // If you don't need tool calls, keep this commented out to save memory
 #define ENABLE_TOOL_CALLS
 
+// --- Tool Selection (requires ENABLE_TOOL_CALLS) ---
+// Uncomment the following line to enable relevance-based tool subset selection
+// This will add setTCToolSelection() so only the top-K tools matching the user
+// message are sent with each tool calls request
+// If you only register a few tools, keep this commented out to save memory
+#define ENABLE_TOOL_SELECTION
+
+// --- Chat Session Support ---
+// Uncomment the following line to enable multi-turn chat sessions
+// This will add AI_API_Chat_Session and the chat(message, session) overloads
+// If you only send single-turn requests, keep this commented out to save memory
+#define ENABLE_CHAT_SESSION
+
+// --- Token Estimator ---
+// Uncomment the following line to enable the local prompt token estimator
+// This will add estimateChatTokens() and setPromptTokenBudget() so oversized
+// requests are trimmed or rejected before they are sent
+#define ENABLE_TOKEN_ESTIMATOR
+
+// --- Response Cache ---
+// Uncomment the following line to enable the exact-match response cache
+// This will add AI_API_Response_Cache and setResponseCache() so repeated
+// deterministic chat requests are answered locally without a round trip
+#define ENABLE_RESPONSE_CACHE
+
+// --- Single-Flight Requests ---
+// Uncomment the following line to share one client between FreeRTOS tasks
+// This serializes requests and lets identical concurrent chat() calls wait
+// for a single request instead of each sending their own
+#define ENABLE_SINGLE_FLIGHT
+
+// --- Provider Failover ---
+// Uncomment the following line to enable fallback targets for chat()
+// This will add addFailoverTarget() so failed requests move on to the next
+// platform/model within the same call, with per-target circuit breakers
+#define ENABLE_FAILOVER
+
+// --- Request Scheduler ---
+// Uncomment the following line to enable the priority request scheduler
+// This will add AI_API_Request_Scheduler, a dispatcher task that runs requests
+// from several FreeRTOS tasks on one client in priority order
+#define ENABLE_REQUEST_SCHEDULER
+
+// --- Latency Routing (requires ENABLE_FAILOVER) ---
+// Uncomment the following line to enable latency-aware target selection
+// This will add setLatencyRouting() so each request goes to the target with
+// the lowest measured latency first
+#define ENABLE_LATENCY_ROUTING
+
+// --- Hedged Requests (requires ENABLE_FAILOVER) ---
+// Uncomment the following line to enable hedged chat requests
+// This will add setHedging() so a slow chat() request is raced against the
+// next failover target; the second request runs on its own FreeRTOS task
+// and TLS connection while it is in flight
+#define ENABLE_HEDGING
+
+// --- Rate Limiter ---
+// Uncomment the following line to enable the client-side rate limiter
+// This will add AI_API_Rate_Limiter and setRateLimiter() so requests wait
+// locally instead of running into HTTP 429 from the provider
+#define ENABLE_RATE_LIMITER
+
+// --- Request Retries ---
+// Uncomment the following line to enable automatic retries
+// This will add setRetryPolicy() so requests that failed with a connection
+// error, 408, 429 or 5xx are sent again with exponential backoff. Retries are
+// off until setRetryPolicy() (or AI_API_RETRY_MAX_ATTEMPTS) allows more attempts
+#define ENABLE_RETRY
+
+// --- Request Cancellation ---
+// Uncomment the following line to enable cancel tokens
+// This will add AI_API_Cancel_Token and setCancelToken() so another task can
+// abort a blocking chat(), tool call or stream while it waits for the server
+#define ENABLE_CANCELLATION
+
+// --- DNS Cache ---
+// Uncomment the following line to enable the DNS cache
+// This will keep the resolved address of each endpoint host so requests on a
+// new connection skip the name lookup
+#define ENABLE_DNS_CACHE
+
+// --- Compressed Responses ---
+// Uncomment the following line to enable compressed responses
+// This will add setCompression() so responses can be sent gzip or deflate
+// compressed; they are inflated as they arrive (32 KB of heap per response)
+#define ENABLE_COMPRESSION
+
+// --- PSRAM Allocator ---
+// Uncomment the following line to place large buffers in PSRAM
+// This will put JSON documents, cached responses, chat history and the
+// inflate window in PSRAM on boards that have it, leaving internal RAM free
+#define ENABLE_PSRAM
+
+// --- Lazy Allocation ---
+// Uncomment the following line to allocate client buffers on first use
+// This will create the mutexes and single-flight semaphores of a client when
+// it first needs them, and add releaseIdleResources() to free its JSON document
+// memory when it is idle. The platform handler is still created by begin()
+#define ENABLE_LAZY_ALLOCATION
+
 // --- Streaming Chat Support ---
 // Uncomment the following line to enable streaming chat functionality
 // This will add streamChat methods to the library
@@ -31,16 +131,108 @@
 // Add defines for other platforms here as needed
 
 // --- Advanced Configuration (Optional) ---
-// Adjust JSON buffer sizes if needed (consider ESP32 memory)
+// JSON documents grow as needed (ArduinoJson 7); tool definitions and tool
+// results may each take half of AI_API_REQ_JSON_DOC_SIZE in a request
 #define AI_API_REQ_JSON_DOC_SIZE 5120
 #define AI_API_RESP_JSON_DOC_SIZE 2048
-// Default HTTP timeout
-#define AI_API_HTTP_TIMEOUT_MS 30000 // 30 seconds
+// Default timeouts of each request phase (changeable at runtime with setTimeouts())
+#define AI_API_CONNECT_TIMEOUT_MS 5000   // TCP connection
+#define AI_API_TLS_TIMEOUT_MS 10000      // TLS handshake (whole seconds)
+#define AI_API_HTTP_TIMEOUT_MS 30000     // Sending the request until the response headers (max 65535)
+#define AI_API_REQUEST_DEADLINE_MS 0     // Whole call across retries and failover; 0 = none
+// Time an idle connection is kept for the next request (changeable with setKeepAlive()); 0 closes
+// it after every request. An open connection holds its TLS session, about 40 KB of heap, so
+// keep-alive is off by default
+#define AI_API_KEEPALIVE_MS 0
+#define AI_API_WARMUP_HOLD_MS 15000      // Time warmup() holds its connection when keep-alive is off
 
 // --- Streaming Configuration ---
 // Configure streaming chat behavior (only used when ENABLE_STREAM_CHAT is defined)
 #define STREAM_CHAT_CHUNK_SIZE 512        // Size of each HTTP read chunk
-#define STREAM_CHAT_CHUNK_TIMEOUT_MS 5000 // Timeout for each chunk read
+#define STREAM_CHAT_CHUNK_TIMEOUT_MS 5000 // Default timeout for each chunk read
+#define STREAM_CHAT_WAIT_SLICE_MS 50      // Longest single wait for data; bounds stopStreaming() latency
+
+// --- Chat Session Configuration ---
+// Default history budget of an AI_API_Chat_Session (only used when ENABLE_CHAT_SESSION is defined)
+#define AI_API_CHAT_SESSION_BYTES 4096 // Turn texts plus 4 bytes per turn
+
+// --- Token Estimator Configuration ---
+// Tokens charged per chat message for role and formatting (only used when ENABLE_TOKEN_ESTIMATOR is defined)
+#define AI_API_TOKEN_ESTIMATOR_MESSAGE_OVERHEAD 4
+
+// --- Response Cache Configuration ---
+// Defaults of an AI_API_Response_Cache (only used when ENABLE_RESPONSE_CACHE is defined)
+#define AI_API_RESPONSE_CACHE_ENTRIES 16              // Responses kept in memory
+#define AI_API_RESPONSE_CACHE_BYTES 16384             // Response bytes kept in memory (PSRAM if available)
+#define AI_API_RESPONSE_CACHE_TTL_MS 3600000UL        // Default time to live (1 hour, 0 = never expires)
+#define AI_API_RESPONSE_CACHE_FLASH_DIR "/ai_cache"   // Directory of the optional flash tier
+#define AI_API_RESPONSE_CACHE_FLASH_FILES 32          // Responses kept in flash
+
+// --- Single-Flight Configuration ---
+// Configure request coalescing (only used when ENABLE_SINGLE_FLIGHT is defined)
+#define AI_API_SINGLE_FLIGHT_SLOTS 4        // Distinct requests coalesced at the same time
+#define AI_API_SINGLE_FLIGHT_MAX_WAITERS 8  // Tasks that can wait on one request
+
+// --- Request Scheduler Configuration ---
+// Configure the request scheduler (only used when ENABLE_REQUEST_SCHEDULER is defined)
+#define AI_API_SCHEDULER_QUEUE_DEPTH 8       // Requests that can wait per priority
+#define AI_API_SCHEDULER_FAIRNESS 4          // Requests taken ahead of waiting lower-priority work
+#define AI_API_SCHEDULER_TASK_STACK 8192     // Stack of the dispatcher task (runs the requests)
+#define AI_API_SCHEDULER_TASK_PRIORITY 1     // FreeRTOS priority of the dispatcher task
+
+// --- Failover Configuration ---
+// Configure provider failover (only used when ENABLE_FAILOVER is defined)
+#define AI_API_FAILOVER_MAX_TARGETS 4            // Targets including the begin() target
+#define AI_API_FAILOVER_FAILURE_THRESHOLD 2      // Consecutive failures that open a circuit breaker
+#define AI_API_FAILOVER_COOLDOWN_MS 30000        // Time a target is skipped once its breaker opens
+
+// --- Latency Routing Configuration ---
+// Configure latency routing (only used when ENABLE_LATENCY_ROUTING is defined)
+#define AI_API_ROUTING_EWMA_ALPHA 0.2f     // Weight of a new latency sample
+#define AI_API_ROUTING_EXPLORATION 0.1f    // Default share of requests sent to a non-fastest target
+
+// --- Hedging Configuration ---
+// Configure hedged requests (only used when ENABLE_HEDGING is defined)
+#define AI_API_HEDGE_DELAY_MS 1500        // Default wait for response headers before hedging
+#define AI_API_HEDGE_TASK_STACK 8192      // Stack of the hedge task (TLS handshake included)
+
+// --- Rate Limiter Configuration ---
+// Configure the rate limiter (only used when ENABLE_RATE_LIMITER is defined)
+#define AI_API_RATE_LIMIT_MAX_WAIT_MS 5000      // Default longest local wait before a request is refused
+#define AI_API_RATE_LIMIT_429_BACKOFF_MS 1000   // Pause after a 429 that carries no retry-after
+
+// --- Retry Configuration ---
+// Default retry policy (only used when ENABLE_RETRY is defined)
+#define AI_API_RETRY_MAX_ATTEMPTS 1        // Attempts per request including the first (1 = no retries)
+#define AI_API_RETRY_BASE_DELAY_MS 500     // Backoff before the first retry (doubles per retry)
+#define AI_API_RETRY_MAX_DELAY_MS 8000     // Longest backoff between attempts
+#define AI_API_RETRY_DEADLINE_MS 30000     // No new attempt starts after this much time
+
+// --- DNS Cache Configuration ---
+// Configure the DNS cache (only used when ENABLE_DNS_CACHE is defined)
+#define AI_API_DNS_CACHE_SIZE 4            // Host names kept per client
+#define AI_API_DNS_TTL_MS 300000           // Lifetime of a resolved address
+#define AI_API_DNS_NEGATIVE_TTL_MS 10000   // Time a failed lookup is not repeated
+
+// --- Compression Configuration ---
+// Configure response decompression (only used when ENABLE_COMPRESSION is defined)
+#define AI_API_INFLATE_INPUT_SIZE 1024     // Compressed bytes buffered (at least 600 for any block header)
+
+// --- PSRAM Configuration ---
+// Configure buffer placement (only used when ENABLE_PSRAM is defined)
+#define AI_API_PSRAM_MIN_ALLOC 1024        // Smaller buffers stay in the faster internal RAM
+
+// --- Lazy Allocation Configuration ---
+// Configure resource release (only used when ENABLE_LAZY_ALLOCATION is defined)
+#define AI_API_IDLE_RELEASE_MS 30000       // Idle time before releaseIdleResources() frees a client's buffers (0 = never)
+
+// --- Handler Registry Configuration ---
+#define AI_API_HANDLER_REGISTRY_SIZE 8    // Platform names that can be registered (built-ins included)
+#define AI_API_HANDLER_CACHE_SIZE 4       // Handlers each client keeps for switching platforms
+
+// --- Tool Selection Configuration ---
+// Configure tool subset selection (only used when ENABLE_TOOL_SELECTION is defined)
+#define AI_API_TOOL_SELECTION_MAX_TERMS 32 // Keywords kept per tool (name, tags, description)
 
 
 #endif // ESP32_AI_CONNECT_CONFIG_H
\ No newline at end of file